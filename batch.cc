@@ -0,0 +1,222 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "batch.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "file_util.h"
+#include "fingerprint.h"
+#include "mlsys.h"
+#include "solution_cache.h"
+#include "solver.h"
+#include "solver_pool.h"
+#include "third_party/absl/container/flat_hash_map.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/strings/str_format.h"
+#include "third_party/absl/strings/str_split.h"
+#include "third_party/absl/strings/string_view.h"
+#include "third_party/absl/strings/strip.h"
+#include "third_party/absl/time/clock.h"
+#include "third_party/absl/time/time.h"
+
+namespace mlsys {
+
+namespace {
+
+// Time slices per problem budget, so that jobs interleave finely enough to
+// share the workers in proportion to their difficulty.
+constexpr int kSlicesPerBudget = 32;
+constexpr absl::Duration kMinSlice = absl::Milliseconds(10);
+
+struct ManifestEntry {
+  std::string input;
+  std::string output;
+};
+
+absl::StatusOr<std::vector<ManifestEntry>> ReadManifest(
+    const std::string& filename) {
+  const absl::StatusOr<std::string> contents = ReadFile(filename);
+  if (!contents.ok()) return contents.status();
+  std::vector<ManifestEntry> entries;
+  int line_number = 0;
+  for (absl::string_view line : absl::StrSplit(*contents, '\n')) {
+    ++line_number;
+    line = absl::StripAsciiWhitespace(line);
+    if (line.empty() || line.front() == '#') continue;
+    const std::vector<std::string> fields =
+        absl::StrSplit(line, absl::ByAnyChar(" \t"), absl::SkipEmpty());
+    if (fields.size() != 2) {
+      return absl::InvalidArgumentError(
+          absl::StrCat(filename, ":", line_number,
+                       ": expected `<input.json> <output.json>`"));
+    }
+    entries.push_back({fields[0], fields[1]});
+  }
+  return entries;
+}
+
+// One distinct problem of the batch.
+struct Task {
+  std::shared_ptr<const Problem> problem;
+  std::vector<std::string> outputs;
+  std::optional<SolutionCache::Entry> cached;
+  std::shared_ptr<SolverPool::Job> job;
+};
+
+absl::Status WriteAll(const Solution& solution,
+                      const std::vector<std::string>& outputs) {
+  for (const std::string& output : outputs) {
+    if (absl::Status status = WriteSolution(solution, output); !status.ok()) {
+      return status;
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status RunBatch(const BatchOptions& options) {
+  const absl::Time start = absl::Now();
+  const absl::StatusOr<std::vector<ManifestEntry>> entries =
+      ReadManifest(options.manifest);
+  if (!entries.ok()) return entries.status();
+
+  absl::Status result;
+  const auto fail = [&result](absl::string_view output,
+                              const absl::Status& status) {
+    std::cout << output << ": " << status << "\n";
+    result.Update(status);
+  };
+
+  absl::flat_hash_map<std::string, std::shared_ptr<const Problem>> parsed;
+  absl::flat_hash_map<std::string, std::vector<size_t>> tasks_by_fingerprint;
+  std::vector<Task> tasks;
+  for (const ManifestEntry& entry : *entries) {
+    std::shared_ptr<const Problem>& problem = parsed[entry.input];
+    if (problem == nullptr) {
+      absl::StatusOr<Problem> read = ReadProblem(entry.input);
+      if (!read.ok()) {
+        parsed.erase(entry.input);
+        fail(entry.output, read.status());
+        continue;
+      }
+      problem = std::make_shared<const Problem>(*std::move(read));
+    }
+    // Problems are compared in full, so that a fingerprint collision never
+    // hands one problem another's solution.
+    std::vector<size_t>& candidates =
+        tasks_by_fingerprint[ProblemFingerprint(*problem)];
+    const auto same = std::find_if(
+        candidates.begin(), candidates.end(), [&](size_t task) {
+          return tasks[task].problem == problem ||
+                 *tasks[task].problem == *problem;
+        });
+    size_t task;
+    if (same != candidates.end()) {
+      task = *same;
+    } else {
+      task = tasks.size();
+      candidates.push_back(task);
+      tasks.push_back({problem, {}, std::nullopt, nullptr});
+    }
+    tasks[task].outputs.push_back(entry.output);
+  }
+
+  const SolutionCache cache(options.cache_dir, options.cache_isomorphic,
+                            options.solver.evaluate);
+  absl::Duration total_difficulty;
+  int num_solved = 0;
+  for (Task& task : tasks) {
+    task.cached = cache.Lookup(*task.problem);
+    if (!task.cached.has_value() || options.cache_improve) {
+      total_difficulty += ContestTimeLimit(*task.problem);
+      ++num_solved;
+    }
+  }
+  const int num_jobs = std::max(1, options.num_jobs);
+  // A job runs on one worker at a time, so no more jobs run at once than
+  // there are problems to solve.
+  const int concurrency = std::max(1, std::min(num_jobs, num_solved));
+  double scale = 1.0;
+  absl::Time deadline = absl::InfiniteFuture();
+  if (options.time_limit.has_value() &&
+      total_difficulty > absl::ZeroDuration()) {
+    deadline = start + *options.time_limit;
+    scale = absl::FDivDuration(*options.time_limit * concurrency,
+                               total_difficulty);
+  }
+
+  SolverPool pool(num_jobs, kMinSlice);
+  for (Task& task : tasks) {
+    if (task.cached.has_value() && !options.cache_improve) continue;
+    SolverPool::JobOptions job;
+    job.solver = options.solver;
+    if (task.cached.has_value()) {
+      job.solver.initial_solution = task.cached->solution;
+    }
+    job.deadline = deadline;
+    const absl::Duration share = ContestTimeLimit(*task.problem) * scale;
+    job.slice = std::max(kMinSlice, share / kSlicesPerBudget);
+    // With a time limit, every job searches until the deadline: the time a
+    // job would leave unused goes to those still running, in proportion to
+    // their slices, rather than leaving workers idle at the end.
+    if (deadline == absl::InfiniteFuture()) job.budget = share;
+    job.on_first_solution = [&task](const Solution& solution, TotalLatency) {
+      // Failures to write show up again on the final solution.
+      WriteAll(solution, task.outputs).IgnoreError();
+    };
+    task.job = pool.Submit(task.problem, std::move(job));
+  }
+
+  for (Task& task : tasks) {
+    Solution solution;
+    TotalLatency latency;
+    if (task.job == nullptr) {
+      solution = task.cached->solution;
+      latency = task.cached->latency;
+    } else if (absl::Status status = task.job->Wait(); !status.ok()) {
+      for (const std::string& output : task.outputs) fail(output, status);
+      continue;
+    } else {
+      solution = task.job->best();
+      latency = task.job->best_latency();
+      if (absl::Status status = cache.Store(*task.problem, solution);
+          !status.ok()) {
+        std::cerr << status << "\n";
+      }
+    }
+    if (absl::Status status = WriteAll(solution, task.outputs); !status.ok()) {
+      for (const std::string& output : task.outputs) fail(output, status);
+      continue;
+    }
+    for (const std::string& output : task.outputs) {
+      std::cout << absl::StrFormat("%s: %f\n", output, latency);
+    }
+  }
+  return result;
+}
+
+}  // namespace mlsys
@@ -0,0 +1,63 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_BATCH_H_
+#define MLSYS_BATCH_H_
+
+#include <optional>
+#include <string>
+
+#include "solver.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/time/time.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Many problems scheduled in one process.                     /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+struct BatchOptions {
+  // One `<input.json> <output.json>` pair per line; blank lines and lines
+  // starting with '#' are ignored.
+  std::string manifest;
+  int num_jobs = 1;
+  // Wall time of the whole batch.  Without it, every problem gets its
+  // contest timeout worth of worker time.
+  std::optional<absl::Duration> time_limit;
+  SolverOptions solver;  // The thread count is ignored.
+  // See SolutionCache, which evaluates under `solver.evaluate`; an empty
+  // directory keeps the cache in memory only.
+  std::string cache_dir;
+  bool cache_isomorphic = false;
+  // Keep searching from cached solutions instead of returning them.
+  bool cache_improve = false;
+};
+
+// Solves every problem of the manifest on a SolverPool of `num_jobs`
+// workers, printing one `<output>: <latency>` line per entry.  Each file is
+// parsed once, and entries with identical problems are solved once.  Each
+// problem's time slice is proportional to its contest timeout, which stands
+// for its difficulty.  Without a time limit, so is its worker time; with
+// one, every problem searches until then, and the problems sharing a worker
+// split its time in proportion to their slices.  As with mlsys, every output
+// receives a first solution as soon as there is one.  Fails if any entry
+// does, after doing all the others.
+absl::Status RunBatch(const BatchOptions& options);
+
+}  // namespace mlsys
+
+#endif  // MLSYS_BATCH_H_
@@ -0,0 +1,383 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "binary_format.h"
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "command_stream.h"
+#include "mlsys.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/match.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/strings/string_view.h"
+#include "third_party/absl/types/span.h"
+
+namespace mlsys {
+
+namespace {
+
+constexpr absl::string_view kProblemMagic = "MLSP";
+constexpr absl::string_view kSolutionMagic = "MLSS";
+constexpr absl::string_view kCommandsMagic = "MLSC";
+constexpr uint32_t kVersion = 7;
+
+bool IsTransfer(CommandKind kind) {
+  return kind == CommandKind::kLoad || kind == CommandKind::kStage ||
+         kind == CommandKind::kStore;
+}
+
+class Writer {
+ public:
+  explicit Writer(absl::string_view magic) : bytes_(magic) {
+    Uint(kVersion, 4);
+  }
+
+  void Uint(uint64_t value, int size = 8) {
+    for (int i = 0; i < size; ++i) {
+      bytes_.push_back(static_cast<char>(value >> (8 * i)));
+    }
+  }
+  void Int(int64_t value) { Uint(static_cast<uint64_t>(value)); }
+  void Varint(uint64_t value) {
+    for (; value >= 0x80; value >>= 7) {
+      bytes_.push_back(static_cast<char>(value | 0x80));
+    }
+    bytes_.push_back(static_cast<char>(value));
+  }
+  void OptionalInt(const std::optional<int64_t>& value) {
+    Uint(value.has_value(), 1);
+    if (value.has_value()) Int(*value);
+  }
+  void OptionalDouble(const std::optional<double>& value) {
+    Uint(value.has_value(), 1);
+    if (value.has_value()) Double(*value);
+  }
+  void Double(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    Uint(bits);
+  }
+  void String(absl::string_view value) {
+    Uint(value.size());
+    bytes_.append(value.data(), value.size());
+  }
+  template <typename T>
+  void List(const std::vector<T>& values) {
+    Uint(values.size());
+    for (T value : values) Int(value);
+  }
+
+  std::string Finish() && { return std::move(bytes_); }
+
+ private:
+  std::string bytes_;
+};
+
+// Reads fields back, remembering the first error; every read after it
+// yields zeros.
+class Reader {
+ public:
+  Reader(absl::string_view bytes, absl::string_view magic) : bytes_(bytes) {
+    if (!absl::StartsWith(bytes_, magic)) {
+      Fail(absl::StrCat("Expected magic \"", magic, "\""));
+      return;
+    }
+    bytes_.remove_prefix(magic.size());
+    if (const uint64_t version = Uint(4); ok() && version != kVersion) {
+      Fail(absl::StrCat("Unsupported version ", version));
+    }
+  }
+
+  uint64_t Uint(int size = 8) {
+    if (!Need(size)) return 0;
+    uint64_t value = 0;
+    for (int i = 0; i < size; ++i) {
+      value |= uint64_t{static_cast<unsigned char>(bytes_[i])} << (8 * i);
+    }
+    bytes_.remove_prefix(size);
+    return value;
+  }
+  int64_t Int() { return static_cast<int64_t>(Uint()); }
+  uint64_t Varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (!Need(1)) return 0;
+      const unsigned char byte = bytes_[0];
+      bytes_.remove_prefix(1);
+      value |= uint64_t{byte & 0x7fu} << shift;
+      if ((byte & 0x80) == 0) return value;
+    }
+    Fail("Varint too long");
+    return 0;
+  }
+  std::optional<int64_t> OptionalInt() {
+    if (Uint(1) == 0) return std::nullopt;
+    return Int();
+  }
+  std::optional<double> OptionalDouble() {
+    if (Uint(1) == 0) return std::nullopt;
+    return Double();
+  }
+  double Double() {
+    const uint64_t bits = Uint();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+  // A length of items of `item_size` bytes each, checked against the rest.
+  uint64_t Length(uint64_t item_size) {
+    const uint64_t length = Uint();
+    if (ok() && length > bytes_.size() / item_size) {
+      Fail("Length exceeds the remaining bytes");
+      return 0;
+    }
+    return length;
+  }
+  std::string String() {
+    const uint64_t length = Length(1);
+    std::string value(bytes_.substr(0, length));
+    bytes_.remove_prefix(length);
+    return value;
+  }
+  template <typename T>
+  std::vector<T> List() {
+    std::vector<T> values(Length(8));
+    for (T& value : values) value = static_cast<T>(Int());
+    return values;
+  }
+
+  bool ok() const { return status_.ok(); }
+  absl::Status Finish() {
+    if (ok() && !bytes_.empty()) Fail("Trailing bytes");
+    return status_;
+  }
+
+ private:
+  bool Need(size_t size) {
+    if (ok() && bytes_.size() < size) Fail("Truncated input");
+    return ok();
+  }
+  void Fail(absl::string_view message) {
+    status_ = absl::InvalidArgumentError(message);
+    bytes_ = {};
+  }
+
+  absl::string_view bytes_;
+  absl::Status status_;
+};
+
+}  // namespace
+
+std::string ProblemToBinary(const Problem& problem) {
+  Writer writer(kProblemMagic);
+  writer.Int(problem.fast_memory_capacity);
+  writer.Int(problem.slow_memory_bandwidth);
+  writer.Int(problem.native_granularity.width);
+  writer.Int(problem.native_granularity.height);
+  writer.Int(problem.native_granularity.depth);
+  writer.OptionalInt(problem.slow_memory_read_bandwidth);
+  writer.OptionalInt(problem.slow_memory_write_bandwidth);
+  writer.OptionalInt(problem.accumulator_bytes);
+  writer.OptionalInt(problem.middle_memory_capacity);
+  writer.OptionalInt(problem.middle_memory_bandwidth);
+  writer.OptionalDouble(problem.dma_setup_latency);
+  writer.Uint(problem.op_native_granularities.size());
+  for (const auto& [op_type, granularity] : problem.op_native_granularities) {
+    writer.String(op_type);
+    writer.Int(granularity.width);
+    writer.Int(granularity.height);
+    writer.Int(granularity.depth);
+  }
+  writer.Uint(problem.tensors.size());
+  for (const Tensor& tensor : problem.tensors) {
+    writer.Int(tensor.width);
+    writer.Int(tensor.height);
+    writer.Int(tensor.element_bytes);
+  }
+  writer.Uint(problem.ops.size());
+  for (const Op& op : problem.ops) {
+    writer.String(op.op_type);
+    writer.List(op.inputs);
+    writer.List(op.outputs);
+    writer.Int(op.base_cost);
+  }
+  return std::move(writer).Finish();
+}
+
+absl::StatusOr<Problem> ParseBinaryProblem(absl::string_view bytes) {
+  Reader reader(bytes, kProblemMagic);
+  Problem problem;
+  problem.fast_memory_capacity = reader.Int();
+  problem.slow_memory_bandwidth = reader.Int();
+  problem.native_granularity.width = reader.Int();
+  problem.native_granularity.height = reader.Int();
+  problem.native_granularity.depth = reader.Int();
+  problem.slow_memory_read_bandwidth = reader.OptionalInt();
+  problem.slow_memory_write_bandwidth = reader.OptionalInt();
+  problem.accumulator_bytes = reader.OptionalInt();
+  problem.middle_memory_capacity = reader.OptionalInt();
+  problem.middle_memory_bandwidth = reader.OptionalInt();
+  problem.dma_setup_latency = reader.OptionalDouble();
+  // An entry takes at least 32 bytes: a length and three dimensions.
+  for (uint64_t i = reader.Length(32); i > 0; --i) {
+    std::string op_type = reader.String();
+    Granularity& granularity = problem.op_native_granularities[op_type];
+    granularity.width = reader.Int();
+    granularity.height = reader.Int();
+    granularity.depth = reader.Int();
+  }
+  problem.tensors.resize(reader.Length(24));
+  for (Tensor& tensor : problem.tensors) {
+    tensor.width = reader.Int();
+    tensor.height = reader.Int();
+    tensor.element_bytes = reader.Int();
+  }
+  // An op takes at least 32 bytes: three lengths and its base cost.
+  problem.ops.resize(reader.Length(32));
+  for (Op& op : problem.ops) {
+    op.op_type = reader.String();
+    op.inputs = reader.List<size_t>();
+    op.outputs = reader.List<size_t>();
+    op.base_cost = reader.Int();
+  }
+  if (absl::Status status = reader.Finish(); !status.ok()) return status;
+  if (absl::Status status = ValidateProblem(problem); !status.ok()) {
+    return status;
+  }
+  return problem;
+}
+
+std::string SolutionToBinary(const Solution& solution) {
+  Writer writer(kSolutionMagic);
+  writer.Uint(solution.subgraphs.size());
+  for (const Subgraph& subgraph : solution.subgraphs) {
+    writer.List(subgraph.ops);
+    writer.List(subgraph.tensors_to_retain);
+    writer.Int(subgraph.granularity.width);
+    writer.Int(subgraph.granularity.height);
+    writer.Int(subgraph.granularity.depth);
+    writer.Uint(subgraph.traversal_order.has_value(), 1);
+    if (subgraph.traversal_order.has_value()) {
+      writer.List(*subgraph.traversal_order);
+    }
+    writer.Double(subgraph.subgraph_latency);
+    writer.OptionalInt(subgraph.engine);
+    writer.List(subgraph.dependencies);
+    std::vector<int64_t> levels;
+    for (MemoryLevel level : subgraph.retention_levels) {
+      levels.push_back(static_cast<int64_t>(level));
+    }
+    writer.List(levels);
+  }
+  return std::move(writer).Finish();
+}
+
+absl::StatusOr<Solution> ParseBinarySolution(absl::string_view bytes) {
+  Reader reader(bytes, kSolutionMagic);
+  Solution solution;
+  // A subgraph takes at least 66 bytes: four lengths, the granularity, the
+  // traversal and engine flags and the latency.
+  solution.subgraphs.resize(reader.Length(66));
+  for (Subgraph& subgraph : solution.subgraphs) {
+    subgraph.ops = reader.List<size_t>();
+    subgraph.tensors_to_retain = reader.List<size_t>();
+    subgraph.granularity.width = reader.Int();
+    subgraph.granularity.height = reader.Int();
+    subgraph.granularity.depth = reader.Int();
+    if (reader.Uint(1) != 0) {
+      subgraph.traversal_order = reader.List<int64_t>();
+    }
+    subgraph.subgraph_latency = reader.Double();
+    subgraph.engine = reader.OptionalInt();
+    subgraph.dependencies = reader.List<size_t>();
+    for (int64_t level : reader.List<int64_t>()) {
+      if (level != static_cast<int64_t>(MemoryLevel::kFast) &&
+          level != static_cast<int64_t>(MemoryLevel::kMiddle)) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Unknown retention level ", level));
+      }
+      subgraph.retention_levels.push_back(static_cast<MemoryLevel>(level));
+    }
+  }
+  if (absl::Status status = reader.Finish(); !status.ok()) return status;
+  return solution;
+}
+
+std::string CommandsToBinary(absl::Span<const Command> commands) {
+  Writer writer(kCommandsMagic);
+  writer.Uint(commands.size());
+  for (const Command& command : commands) {
+    writer.Uint(static_cast<uint8_t>(command.kind) | (command.middle << 7), 1);
+    if (command.kind == CommandKind::kBarrier) {
+      writer.Varint(command.subgraph);
+      continue;
+    }
+    const bool transfer = IsTransfer(command.kind);
+    if (transfer) writer.Varint(command.tensor);
+    writer.Varint(command.region.row);
+    writer.Varint(command.region.col);
+    writer.Varint(command.region.height);
+    writer.Varint(command.region.width);
+    if (transfer && command.kind != CommandKind::kStage) {
+      writer.Varint(command.address);
+    }
+    writer.Varint(transfer ? command.bytes : command.k_step);
+  }
+  return std::move(writer).Finish();
+}
+
+absl::StatusOr<std::vector<Command>> ParseBinaryCommands(
+    absl::string_view bytes) {
+  Reader reader(bytes, kCommandsMagic);
+  // A command takes at least 2 bytes: its kind and one field.
+  std::vector<Command> commands(reader.Length(2));
+  for (Command& command : commands) {
+    const uint64_t kind = reader.Uint(1);
+    command.kind = static_cast<CommandKind>(kind & 0x7f);
+    command.middle = (kind & 0x80) != 0;
+    if (command.kind > CommandKind::kBarrier ||
+        (command.middle && command.kind != CommandKind::kLoad &&
+         command.kind != CommandKind::kStore)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown command kind ", kind));
+    }
+    if (command.kind == CommandKind::kBarrier) {
+      command.subgraph = reader.Varint();
+      continue;
+    }
+    const bool transfer = IsTransfer(command.kind);
+    if (transfer) command.tensor = reader.Varint();
+    command.region.row = reader.Varint();
+    command.region.col = reader.Varint();
+    command.region.height = reader.Varint();
+    command.region.width = reader.Varint();
+    if (transfer && command.kind != CommandKind::kStage) {
+      command.address = reader.Varint();
+    }
+    (transfer ? command.bytes : command.k_step) = reader.Varint();
+  }
+  if (absl::Status status = reader.Finish(); !status.ok()) return status;
+  return commands;
+}
+
+}  // namespace mlsys
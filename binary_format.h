@@ -0,0 +1,66 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_BINARY_FORMAT_H_
+#define MLSYS_BINARY_FORMAT_H_
+
+#include <string>
+#include <vector>
+
+#include "command_stream.h"
+#include "mlsys.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/string_view.h"
+#include "third_party/absl/types/span.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Binary encodings of problems, solutions and commands.       /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// Both encodings start with a 4-byte magic ("MLSP" for problems, "MLSS" for
+// solutions) and a 4-byte version, followed by the fields in the order of
+// the structs in mlsys.h.  Integers are 8-byte little-endian, latencies
+// 8-byte little-endian IEEE doubles, and every list or string is preceded
+// by its length.  An op type is a string and a retention level its integer
+// value; an absent optional field (a traversal order, engine, bandwidth,
+// accumulator width, middle memory parameter or DMA setup latency) is a zero
+// byte and a present one a one byte before the value.
+//
+// Decoding validates like the JSON parsers do, and never trusts a length
+// beyond the bytes actually remaining.
+
+std::string ProblemToBinary(const Problem& problem);
+absl::StatusOr<Problem> ParseBinaryProblem(absl::string_view bytes);
+
+std::string SolutionToBinary(const Solution& solution);
+absl::StatusOr<Solution> ParseBinarySolution(absl::string_view bytes);
+
+// Command streams start with the magic "MLSC" and the same version, then
+// the number of commands as an 8-byte integer.  Each command is a byte
+// giving its kind, with the high bit set for a load or store to or from
+// middle memory, followed by its fields as unsigned LEB128 varints: the
+// tensor, region, address and bytes of a transfer (no address for a
+// stage), the region and reduction step of a computation, or the subgraph
+// of a barrier.
+std::string CommandsToBinary(absl::Span<const Command> commands);
+absl::StatusOr<std::vector<Command>> ParseBinaryCommands(
+    absl::string_view bytes);
+
+}  // namespace mlsys
+
+#endif  // MLSYS_BINARY_FORMAT_H_
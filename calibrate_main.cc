@@ -0,0 +1,109 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Fits a problem's base costs, bandwidths and DMA setup latency to this
+// machine by timing the CPU executor's kernels (see Calibrate()):
+//
+//   $ ./mlsys_calibrate problem.json calibrated.json
+//
+// Solutions to the calibrated problem are tuned for mlsys_execute here.
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "calibration.h"
+#include "file_util.h"
+#include "microkernels.h"
+#include "mlsys.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/flags/parse.h"
+#include "third_party/absl/flags/usage.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/time/time.h"
+
+ABSL_FLAG(absl::Duration, min_time, absl::Milliseconds(2),
+          "Shortest batch of calls timed per measurement.");
+ABSL_FLAG(int64_t, slow_memory_bytes, int64_t{256} << 20,
+          "Buffer that loads and stores cycle through; should exceed the "
+          "last-level cache.");
+
+namespace {
+
+const char* RuleName(mlsys::SliceRule rule) {
+  switch (rule) {
+    case mlsys::SliceRule::kPointwise:
+      return "per input";
+    case mlsys::SliceRule::kMatMul:
+    case mlsys::SliceRule::kRowReduction:
+    case mlsys::SliceRule::kColumnReduction:
+      return "per element of depth";
+    case mlsys::SliceRule::kTranspose:
+      break;
+  }
+  return "";
+}
+
+void PrintFit(const mlsys::LinearFit& fit, const char* per) {
+  std::cout << fit.intercept << " ns + " << fit.slope << " ns " << per
+            << " (r^2 " << fit.r_squared << ")\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  absl::SetProgramUsageMessage(
+      "Usage: mlsys_calibrate [flags] <problem.json> <calibrated.json>");
+  const std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+  if (args.size() != 3) {
+    std::cerr << "Usage: " << args[0]
+              << " [flags] <problem.json> <calibrated.json>\n";
+    return 1;
+  }
+  const absl::StatusOr<mlsys::Problem> problem = mlsys::ReadProblem(args[1]);
+  if (!problem.ok()) {
+    std::cerr << problem.status() << "\n";
+    return 1;
+  }
+  mlsys::CalibrationOptions options;
+  options.min_time = absl::GetFlag(FLAGS_min_time);
+  options.slow_memory_bytes = absl::GetFlag(FLAGS_slow_memory_bytes);
+  const absl::StatusOr<mlsys::CalibrationReport> report =
+      mlsys::Calibrate(*problem, options);
+  if (!report.ok()) {
+    std::cerr << report.status() << "\n";
+    return 1;
+  }
+  std::cout << "kernels: " << mlsys::MicrokernelIsa() << "\n";
+  for (const mlsys::OpProfile& op : report->ops) {
+    std::cout << op.op_type << " [" << op.native.width << ", "
+              << op.native.height << "]: ";
+    PrintFit(op.fit, RuleName(op.rule));
+  }
+  std::cout << "load: ";
+  PrintFit(report->read, "per element");
+  std::cout << "store: ";
+  PrintFit(report->write, "per element");
+  std::cout << "time unit: " << report->unit_ns << " ns\n";
+  if (const absl::Status status = mlsys::WriteFile(
+          args[2], mlsys::ProblemToJson(report->problem));
+      !status.ok()) {
+    std::cerr << status << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,295 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "calibration.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "microkernels.h"
+#include "mlsys.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/time/clock.h"
+#include "third_party/absl/time/time.h"
+#include "third_party/absl/types/span.h"
+
+namespace mlsys {
+
+namespace {
+
+// Rows of the tensors copies read from and write to, in floats.
+constexpr int64_t kRowStride = 4096;
+
+// The nanoseconds one call of `kernel` takes: calls are batched, doubling
+// until a batch lasts `min_time`, and the fastest of three batches counts.
+template <typename F>
+double TimeNanoseconds(absl::Duration min_time, F kernel) {
+  int64_t calls = 1;
+  double best = std::numeric_limits<double>::infinity();
+  for (int round = 0; round < 3;) {
+    const absl::Time start = absl::Now();
+    for (int64_t call = 0; call < calls; ++call) kernel();
+    const absl::Duration elapsed = absl::Now() - start;
+    if (elapsed < min_time) {
+      calls *= 2;
+      continue;
+    }
+    best = std::min(best, absl::ToDoubleNanoseconds(elapsed) / calls);
+    ++round;
+  }
+  return best;
+}
+
+// Samples of an op's time per native tile.
+struct Samples {
+  std::vector<double> x;
+  std::vector<double> nanoseconds;
+};
+
+Samples ProfileOp(SliceRule rule, const Granularity& native,
+                  absl::Duration min_time) {
+  const int64_t width = native.width;
+  const int64_t height = native.height;
+  Samples samples;
+  const auto time = [&](double x, auto kernel) {
+    samples.x.push_back(x);
+    samples.nanoseconds.push_back(TimeNanoseconds(min_time, kernel));
+  };
+  switch (rule) {
+    case SliceRule::kMatMul:
+      for (int64_t depth = 16; depth <= 2048; depth *= 2) {
+        std::vector<float> a(height * depth, 0.5f);
+        std::vector<float> b(depth * width, 0.5f);
+        std::vector<float> c(height * width, 0.0f);
+        time(depth, [&] {
+          Gemm(height, width, depth, a.data(), depth, b.data(), width,
+               c.data(), width);
+        });
+      }
+      break;
+    case SliceRule::kPointwise: {
+      std::vector<float> in(height * width, 0.5f);
+      std::vector<float> out(height * width, 0.0f);
+      for (int inputs = 1; inputs <= 4; ++inputs) {
+        time(inputs, [&] {
+          for (int64_t row = 0; row < height; ++row) {
+            float* dst = out.data() + row * width;
+            std::fill_n(dst, width, 0.0f);
+            for (int input = 0; input < inputs; ++input) {
+              AddRow(dst, in.data() + row * width, width);
+            }
+            Clamp(dst, width);
+          }
+        });
+      }
+      break;
+    }
+    case SliceRule::kRowReduction:
+      for (int64_t depth = 16; depth <= 2048; depth *= 2) {
+        std::vector<float> in(height * depth, 0.5f);
+        std::vector<float> out(height, 0.0f);
+        time(depth, [&] {
+          for (int64_t row = 0; row < height; ++row) {
+            out[row] += SumRow(in.data() + row * depth, depth);
+          }
+        });
+      }
+      break;
+    case SliceRule::kColumnReduction:
+      for (int64_t depth = 16; depth <= 2048; depth *= 2) {
+        std::vector<float> in(depth * width, 0.5f);
+        std::vector<float> out(width, 0.0f);
+        time(depth, [&] {
+          for (int64_t row = 0; row < depth; ++row) {
+            AddRow(out.data(), in.data() + row * width, width);
+          }
+        });
+      }
+      break;
+    case SliceRule::kTranspose: {
+      std::vector<float> in(width * height, 0.5f);
+      std::vector<float> out(height * width, 0.0f);
+      time(0, [&] {
+        for (int64_t row = 0; row < height; ++row) {
+          TransposeRow(out.data() + row * width, in.data() + row, height,
+                       width);
+        }
+      });
+      break;
+    }
+  }
+  return samples;
+}
+
+// Times row-by-row copies of strips between `slow`, cycled through so that
+// every copy misses the caches, and a scratch buffer.
+void ProfileCopies(std::vector<float>& slow, absl::Duration min_time,
+                   Samples* reads, Samples* writes) {
+  const int64_t slow_rows = static_cast<int64_t>(slow.size()) / kRowStride;
+  for (int64_t height : {8, 32, 128, 512}) {
+    for (int64_t width : {32, 128, 512, 2048}) {
+      if (height > slow_rows) continue;
+      std::vector<float> scratch(height * width, 0.0f);
+      int64_t row = 0;
+      const auto next = [&] {
+        row += height;
+        if (row + height > slow_rows) row = 0;
+        return slow.data() + row * kRowStride;
+      };
+      reads->x.push_back(height * width);
+      reads->nanoseconds.push_back(TimeNanoseconds(min_time, [&] {
+        const float* source = next();
+        for (int64_t i = 0; i < height; ++i) {
+          std::memcpy(scratch.data() + i * width, source + i * kRowStride,
+                      width * sizeof(float));
+        }
+      }));
+      writes->x.push_back(height * width);
+      writes->nanoseconds.push_back(TimeNanoseconds(min_time, [&] {
+        float* destination = next();
+        for (int64_t i = 0; i < height; ++i) {
+          std::memcpy(destination + i * kRowStride, scratch.data() + i * width,
+                      width * sizeof(float));
+        }
+      }));
+    }
+  }
+}
+
+int64_t RoundPositive(double value) {
+  return std::max<int64_t>(1, std::llround(value));
+}
+
+}  // namespace
+
+LinearFit FitLine(absl::Span<const double> x, absl::Span<const double> y) {
+  LinearFit fit;
+  const size_t n = std::min(x.size(), y.size());
+  if (n == 0) return fit;
+  double mean_x = 0.0;
+  double mean_y = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    mean_x += x[i] / n;
+    mean_y += y[i] / n;
+  }
+  double xx = 0.0;
+  double xy = 0.0;
+  double yy = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    xx += (x[i] - mean_x) * (x[i] - mean_x);
+    xy += (x[i] - mean_x) * (y[i] - mean_y);
+    yy += (y[i] - mean_y) * (y[i] - mean_y);
+  }
+  fit.slope = xx > 0.0 ? xy / xx : 0.0;
+  fit.intercept = mean_y - fit.slope * mean_x;
+  fit.r_squared = xx > 0.0 && yy > 0.0 ? xy * xy / (xx * yy) : 1.0;
+  return fit;
+}
+
+absl::StatusOr<CalibrationReport> Calibrate(
+    const Problem& problem, const CalibrationOptions& options) {
+  if (absl::Status status = ValidateProblem(problem); !status.ok()) {
+    return status;
+  }
+  CalibrationReport report;
+
+  // One profile per kind of op and native granularity in the problem.
+  std::vector<size_t> profile_of(problem.ops.size());
+  for (size_t op = 0; op < problem.ops.size(); ++op) {
+    const absl::StatusOr<SliceRule> rule = GetSliceRule(problem, op);
+    if (!rule.ok()) return rule.status();
+    const OpType& op_type = problem.ops[op].op_type;
+    const Granularity& native = NativeGranularity(problem, op_type);
+    const auto same = [&](const OpProfile& profile) {
+      return profile.op_type == op_type && profile.rule == *rule &&
+             profile.native == native;
+    };
+    auto it = std::find_if(report.ops.begin(), report.ops.end(), same);
+    if (it == report.ops.end()) {
+      const Samples samples = ProfileOp(*rule, native, options.min_time);
+      report.ops.push_back(
+          {op_type, *rule, native, FitLine(samples.x, samples.nanoseconds)});
+      it = report.ops.end() - 1;
+    }
+    profile_of[op] = it - report.ops.begin();
+  }
+
+  std::vector<float> slow(
+      std::max<int64_t>(options.slow_memory_bytes / sizeof(float),
+                        512 * kRowStride),
+      0.5f);
+  Samples reads;
+  Samples writes;
+  ProfileCopies(slow, options.min_time, &reads, &writes);
+  report.read = FitLine(reads.x, reads.nanoseconds);
+  report.write = FitLine(writes.x, writes.nanoseconds);
+  if (report.read.slope <= 0.0 || report.write.slope <= 0.0) {
+    return absl::InternalError(
+        "copy times do not grow with their size; measurements are too noisy");
+  }
+
+  std::vector<double> base_costs(problem.ops.size());
+  double cheapest = std::numeric_limits<double>::infinity();
+  for (size_t op = 0; op < problem.ops.size(); ++op) {
+    const Op& spec = problem.ops[op];
+    const OpProfile& profile = report.ops[profile_of[op]];
+    const double x = profile.rule == SliceRule::kPointwise
+                         ? spec.inputs.size()
+                         : ReductionDepth(problem, spec);
+    base_costs[op] = std::max(profile.fit(x), 1.0);
+    cheapest = std::min(cheapest, base_costs[op]);
+  }
+  const double read_bandwidth = 1.0 / report.read.slope;  // Per nanosecond.
+  const double write_bandwidth = 1.0 / report.write.slope;
+  if (std::isfinite(cheapest)) {
+    report.unit_ns = std::sqrt(
+        cheapest / std::max(read_bandwidth, write_bandwidth));
+  }
+
+  Problem& calibrated = report.problem;
+  calibrated = problem;
+  for (size_t op = 0; op < problem.ops.size(); ++op) {
+    calibrated.ops[op].base_cost =
+        RoundPositive(base_costs[op] / report.unit_ns);
+  }
+  for (Tensor& tensor : calibrated.tensors) tensor.element_bytes = 1;
+  calibrated.accumulator_bytes = std::nullopt;
+  calibrated.middle_memory_capacity = std::nullopt;
+  calibrated.middle_memory_bandwidth = std::nullopt;
+  calibrated.slow_memory_read_bandwidth =
+      RoundPositive(read_bandwidth * report.unit_ns);
+  calibrated.slow_memory_write_bandwidth =
+      RoundPositive(write_bandwidth * report.unit_ns);
+  calibrated.slow_memory_bandwidth = *calibrated.slow_memory_read_bandwidth;
+  const double setup = (report.read.intercept + report.write.intercept) / 2;
+  calibrated.dma_setup_latency =
+      setup > 0.0 ? std::optional<SubgraphLatency>(setup / report.unit_ns)
+                  : std::nullopt;
+  if (absl::Status status = ValidateProblem(calibrated); !status.ok()) {
+    return status;
+  }
+  return report;
+}
+
+}  // namespace mlsys
@@ -0,0 +1,90 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_CALIBRATION_H_
+#define MLSYS_CALIBRATION_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "mlsys.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/time/time.h"
+#include "third_party/absl/types/span.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Fitting the cost model to the host CPU.                     /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+struct LinearFit {
+  double intercept = 0.0;
+  double slope = 0.0;
+  double r_squared = 1.0;
+  double operator()(double x) const { return intercept + slope * x; }
+};
+
+// The least-squares line through `(x[i], y[i])`; flat if every x is equal.
+LinearFit FitLine(absl::Span<const double> x, absl::Span<const double> y);
+
+struct CalibrationOptions {
+  // Every measurement repeats its kernel for at least this long, three
+  // times, and keeps the fastest.
+  absl::Duration min_time = absl::Milliseconds(2);
+  // The buffer loads and stores cycle through, standing in for slow memory.
+  // It should exceed the last-level cache so that they miss it.
+  int64_t slow_memory_bytes = int64_t{256} << 20;
+};
+
+// How long one kind of op takes per native tile on this machine, in
+// nanoseconds, over its reduction depth (MatMul, Reduction) or its number
+// of inputs (Pointwise).  Transposes take a flat time.
+struct OpProfile {
+  OpType op_type;
+  SliceRule rule = SliceRule::kPointwise;
+  Granularity native;
+  LinearFit fit;
+};
+
+struct CalibrationReport {
+  // The input problem with measured base costs, bandwidths and DMA setup
+  // latency, in units of `unit_ns` nanoseconds.
+  Problem problem;
+  double unit_ns = 1.0;
+  // Nanoseconds per load or store over the elements it moves.
+  LinearFit read;
+  LinearFit write;
+  std::vector<OpProfile> ops;
+};
+
+// Times the kernels Execute() runs on tiles of the problem's native
+// granularities and copies between a large buffer and scratch, and fits
+// the cost model of PROBLEM.md to them by least squares: each op's base
+// cost is its fitted time per native tile, each bandwidth the inverse slope
+// of its copy times, and the DMA setup latency their mean intercept.
+//
+// An element is a float of the executor: the calibrated problem counts
+// every tensor at one byte per element, like the capacity, and drops any
+// middle memory, which the executor does not model.  The time unit makes
+// the smallest base cost and the bandwidths about equally large, so that
+// rounding them to integers loses as little as possible.
+absl::StatusOr<CalibrationReport> Calibrate(
+    const Problem& problem, const CalibrationOptions& options = {});
+
+}  // namespace mlsys
+
+#endif  // MLSYS_CALIBRATION_H_
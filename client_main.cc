@@ -0,0 +1,123 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// The contest entry point, served by a running mlsysd:
+//
+//   $ ./mlsys_client <path_to_input.json> <path_to_output.json>
+//
+// Behaves like mlsys: the output file first receives a valid solution as
+// soon as the daemon has one, then the final solution.
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "daemon_protocol.h"
+#include "file_util.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/flags/parse.h"
+#include "third_party/absl/flags/usage.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/time/time.h"
+
+ABSL_FLAG(std::string, socket, mlsys::kDefaultSocketPath,
+          "Unix domain socket of the daemon.");
+ABSL_FLAG(std::optional<absl::Duration>, time_limit, std::nullopt,
+          "Search budget; defaults to the contest timeout for the problem "
+          "size, less a safety margin.");
+
+namespace {
+
+absl::StatusOr<int> Connect(const std::string& path) {
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    return absl::InvalidArgumentError(absl::StrCat("Socket path too long: ",
+                                                   path));
+  }
+  std::memcpy(address.sun_path, path.data(), path.size());
+  const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd >= 0 && connect(fd, reinterpret_cast<const sockaddr*>(&address),
+                         sizeof(address)) == 0) {
+    return fd;
+  }
+  const absl::Status status = absl::UnavailableError(
+      absl::StrCat("Cannot connect to ", path, ": ", std::strerror(errno)));
+  if (fd >= 0) close(fd);
+  return status;
+}
+
+absl::Status Run(const std::string& input, const std::string& output) {
+  mlsys::DaemonRequest request;
+  request.time_limit =
+      absl::GetFlag(FLAGS_time_limit).value_or(absl::ZeroDuration());
+  absl::StatusOr<std::string> problem_json = mlsys::ReadFile(input);
+  if (!problem_json.ok()) return problem_json.status();
+  request.problem_json = *std::move(problem_json);
+
+  const absl::StatusOr<int> fd = Connect(absl::GetFlag(FLAGS_socket));
+  if (!fd.ok()) return fd.status();
+  absl::Status status =
+      mlsys::WriteFrame(*fd, mlsys::EncodeRequest(request));
+  while (status.ok()) {
+    absl::StatusOr<std::string> payload = mlsys::ReadFrame(*fd);
+    if (!payload.ok()) {
+      status = payload.status();
+      break;
+    }
+    absl::StatusOr<mlsys::DaemonResponse> response =
+        mlsys::DecodeResponse(*payload);
+    if (!response.ok()) {
+      status = response.status();
+    } else if (response->kind == mlsys::DaemonResponse::kError) {
+      status = absl::InternalError(response->body);
+    } else {
+      status = mlsys::WriteFile(output, response->body);
+      if (response->kind == mlsys::DaemonResponse::kFinal) break;
+    }
+  }
+  close(*fd);
+  return status;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  absl::SetProgramUsageMessage(
+      "Usage: mlsys_client [flags] <path_to_input.json> "
+      "<path_to_output.json>");
+  const std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+  if (args.size() != 3) {
+    std::cerr << "Usage: " << args[0]
+              << " [flags] <path_to_input.json> <path_to_output.json>\n";
+    return 1;
+  }
+  if (const absl::Status status = Run(args[1], args[2]); !status.ok()) {
+    std::cerr << status << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,177 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "command_stream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "memory_planner.h"
+#include "mlsys.h"
+#include "roofline.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/types/span.h"
+
+namespace mlsys {
+
+absl::StatusOr<std::vector<Command>> LowerSolution(
+    const Problem& problem, const Solution& solution,
+    const EvaluateOptions& options, const MemoryPlanOptions& plan_options) {
+  const absl::StatusOr<MemoryPlan> plan =
+      PlanFastMemory(problem, solution, options, plan_options);
+  if (!plan.ok()) return plan.status();
+  // The buffers of each subgraph: its own tiles and the whole tensors its
+  // engine holds meanwhile.
+  std::vector<std::vector<const Buffer*>> buffers(solution.subgraphs.size());
+  for (const Buffer& buffer : plan->buffers) {
+    for (size_t index = buffer.first; index <= buffer.last; ++index) {
+      if (solution.subgraphs[index].engine.value_or(0) == buffer.engine) {
+        buffers[index].push_back(&buffer);
+      }
+    }
+  }
+
+  std::vector<Command> commands;
+  std::vector<const Buffer*> buffer_of(problem.tensors.size(), nullptr);
+  size_t next = 0;  // The next subgraph to enter.
+  const auto close = [&](size_t index) {
+    for (const Buffer* buffer : buffers[index]) {
+      buffer_of[buffer->tensor] = nullptr;
+    }
+    Command& barrier = commands.emplace_back();
+    barrier.kind = CommandKind::kBarrier;
+    barrier.subgraph = index;
+  };
+  // Closes the subgraphs before `index` and enters it.
+  const auto enter = [&](size_t index) {
+    for (; next <= index; ++next) {
+      if (next > 0) close(next - 1);
+      for (const Buffer* buffer : buffers[next]) {
+        const Buffer*& slot = buffer_of[buffer->tensor];
+        if (slot == nullptr || buffer->whole) slot = buffer;
+      }
+    }
+  };
+  const auto compute = [&](CommandKind kind, const Step& step) {
+    Command& command = commands.emplace_back();
+    command.kind = kind;
+    command.region = step.valid;
+    command.k_step = step.k_step;
+  };
+  absl::Status missing;
+  const auto transfer = [&](CommandKind kind, const Transfer& transfer) {
+    Command& command = commands.emplace_back();
+    command.kind = kind;
+    command.middle = transfer.middle && kind != CommandKind::kStage;
+    command.tensor = transfer.tensor;
+    command.region = transfer.region;
+    command.bytes = TransferBytes(problem, transfer);
+    if (kind == CommandKind::kStage) return;
+    const Buffer* buffer = buffer_of[transfer.tensor];
+    if (buffer == nullptr) {
+      missing = absl::InternalError(absl::StrCat(
+          "No fast memory buffer for tensor ", transfer.tensor,
+          " in subgraph ", next - 1));
+      return;
+    }
+    command.address = buffer->offset;
+    if (buffer->whole) {
+      const Tensor& tensor = problem.tensors[transfer.tensor];
+      command.address += (transfer.region.row * tensor.width +
+                          transfer.region.col) *
+                         tensor.element_bytes;
+    }
+  };
+  if (absl::Status status = Replayer(problem, options).Replay(
+          solution,
+          [&](const Step& step) {
+            enter(step.subgraph);
+            for (const Transfer& stage : step.stages) {
+              transfer(CommandKind::kStage, stage);
+            }
+            for (const Transfer& load : step.loads) {
+              transfer(CommandKind::kLoad, load);
+            }
+            if (step.num_k_steps == 1) {
+              compute(CommandKind::kCompute, step);
+            } else {
+              compute(CommandKind::kAccumulate, step);
+              if (step.k_step + 1 == step.num_k_steps) {
+                compute(CommandKind::kFinalize, step);
+              }
+            }
+            for (const Transfer& store : step.stores) {
+              transfer(CommandKind::kStore, store);
+            }
+          });
+      !status.ok()) {
+    return status;
+  }
+  if (!missing.ok()) return missing;
+  if (!solution.subgraphs.empty()) {
+    enter(solution.subgraphs.size() - 1);
+    close(solution.subgraphs.size() - 1);
+  }
+  return commands;
+}
+
+CommandStats Summarize(const Problem& problem,
+                       absl::Span<const Command> commands) {
+  const bool has_middle = HasMiddleMemory(problem);
+  CommandStats stats;
+  stats.commands = commands.size();
+  for (const Command& command : commands) {
+    switch (command.kind) {
+      case CommandKind::kLoad:
+        ++stats.loads;
+        if (!command.middle) {
+          ++stats.slow_transfers;
+          stats.slow_bytes_read += command.bytes;
+        }
+        if (has_middle) stats.middle_link_bytes += command.bytes;
+        break;
+      case CommandKind::kStage:
+        ++stats.stages;
+        ++stats.slow_transfers;
+        stats.slow_bytes_read += command.bytes;
+        break;
+      case CommandKind::kCompute:
+      case CommandKind::kAccumulate:
+        ++stats.computes;
+        break;
+      case CommandKind::kFinalize:
+        ++stats.finalizes;
+        break;
+      case CommandKind::kStore:
+        ++stats.stores;
+        if (!command.middle) {
+          ++stats.slow_transfers;
+          stats.slow_bytes_written += command.bytes;
+        }
+        if (has_middle) stats.middle_link_bytes += command.bytes;
+        break;
+      case CommandKind::kBarrier:
+        ++stats.subgraphs;
+        break;
+    }
+  }
+  return stats;
+}
+
+}  // namespace mlsys
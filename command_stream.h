@@ -0,0 +1,118 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_COMMAND_STREAM_H_
+#define MLSYS_COMMAND_STREAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "memory_planner.h"
+#include "mlsys.h"
+#include "roofline.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/types/span.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Lowering of solutions to tile-level command streams.        /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+enum class CommandKind : uint8_t {
+  // Copies a slice of a tensor from slow or middle memory into fast memory.
+  kLoad = 0,
+  // Copies a whole tensor from slow into middle memory, ahead of the loads
+  // of its slices.
+  kStage = 1,
+  // Computes one step of every op of the subgraph.
+  kCompute = 2,
+  // Computes one reduction step of a tile whose reduction is split across
+  // steps, adding into the accumulators of its outputs; the first step of
+  // the tile overwrites them instead.
+  kAccumulate = 3,
+  // Follows the last kAccumulate of a tile: computes the ops that need the
+  // whole reduction and converts the accumulators to their stored width.
+  kFinalize = 4,
+  // Copies a slice of a tensor from fast memory to slow or middle memory.
+  kStore = 5,
+  // Ends a subgraph: every command before it completes before any after it.
+  kBarrier = 6,
+};
+
+struct Command {
+  CommandKind kind = CommandKind::kLoad;
+  // Of a load or store: the other end is middle memory, not slow memory.
+  bool middle = false;
+  // Of a barrier: the subgraph it ends.
+  uint32_t subgraph = 0;
+  // Of a transfer.
+  size_t tensor = 0;
+  // Of a transfer: the slice moved.  Of a computation: the subgraph's output
+  // tile, clipped to its output grid.
+  Region region;
+  // Of a load or store: the byte offset in fast memory of the slice, in the
+  // engine's partition; tiles are packed row-major at the start of their
+  // buffer, and slices of whole tensors sit where they do in the tensor.
+  int64_t address = 0;
+  int64_t bytes = 0;  // Of a transfer.
+  int64_t k_step = 0;  // Of a computation.
+  bool operator==(const Command& other) const = default;
+};
+
+// Counts per command kind and, for the transfers, what the cost model
+// charges for them.
+struct CommandStats {
+  int64_t commands = 0;
+  int64_t loads = 0;
+  int64_t stages = 0;
+  int64_t stores = 0;
+  int64_t computes = 0;  // Including accumulations.
+  int64_t finalizes = 0;
+  int64_t subgraphs = 0;
+  // Transfers over the slow memory link, each paying the DMA setup latency,
+  // and their bytes.
+  int64_t slow_transfers = 0;
+  int64_t slow_bytes_read = 0;
+  int64_t slow_bytes_written = 0;
+  // Bytes over the link between fast and middle memory, which every load
+  // and store crosses when there is a middle memory.
+  int64_t middle_link_bytes = 0;
+};
+
+// Expands every subgraph into its steps, in the traversal order and at the
+// granularity of the subgraph, and every step into its loads (each staged
+// tensor first), one computation and its stores, then a barrier.  The
+// transfers are exactly those Replayer charges for: a slice still resident
+// from the previous step is not reloaded, and an output is stored once,
+// after the last reduction step of its tile.  Fast memory addresses come
+// from PlanFastMemory() with `plan_options`.
+//
+// With several engines, the stream holds the subgraphs in solution order;
+// each barrier's subgraph tells its engine.  Fails like Evaluate() on an
+// invalid solution.
+absl::StatusOr<std::vector<Command>> LowerSolution(
+    const Problem& problem, const Solution& solution,
+    const EvaluateOptions& options = {},
+    const MemoryPlanOptions& plan_options = {});
+
+CommandStats Summarize(const Problem& problem,
+                       absl::Span<const Command> commands);
+
+}  // namespace mlsys
+
+#endif  // MLSYS_COMMAND_STREAM_H_
@@ -0,0 +1,192 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "daemon.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "daemon_protocol.h"
+#include "mlsys.h"
+#include "solver.h"
+#include "solver_pool.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/strings/string_view.h"
+#include "third_party/absl/synchronization/mutex.h"
+#include "third_party/absl/time/clock.h"
+#include "third_party/absl/time/time.h"
+
+namespace mlsys {
+
+namespace {
+
+// How often blocked waits look up from what they are waiting for.
+constexpr absl::Duration kPollInterval = absl::Milliseconds(100);
+
+absl::Status SocketError(absl::string_view what, absl::string_view path) {
+  return absl::UnavailableError(
+      absl::StrCat(what, " ", path, ": ", std::strerror(errno)));
+}
+
+// True once the peer has closed its end.  Pipelined requests waiting to be
+// read do not count.
+bool PeerClosed(int fd) {
+  char byte;
+  return recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT) == 0;
+}
+
+absl::Status Respond(int fd, DaemonResponse::Kind kind, TotalLatency latency,
+                     std::string body) {
+  DaemonResponse response;
+  response.kind = kind;
+  response.latency = latency;
+  response.body = std::move(body);
+  return WriteFrame(fd, EncodeResponse(response));
+}
+
+absl::Status RespondError(int fd, const absl::Status& error) {
+  return Respond(fd, DaemonResponse::kError, 0.0, error.ToString());
+}
+
+}  // namespace
+
+Daemon::Daemon(DaemonOptions options)
+    : options_(std::move(options)),
+      pool_(options_.num_workers, options_.slice),
+      cache_(options_.cache_dir, options_.cache_isomorphic,
+             options_.evaluate) {}
+
+absl::Status Daemon::Serve() {
+  const std::string& path = options_.socket_path;
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    return absl::InvalidArgumentError(absl::StrCat("Socket path too long: ",
+                                                   path));
+  }
+  std::memcpy(address.sun_path, path.data(), path.size());
+  const auto* generic = reinterpret_cast<const sockaddr*>(&address);
+
+  const int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listener < 0) return SocketError("Cannot create socket for", path);
+  // A socket file nobody answers on is left over from a dead daemon.
+  if (connect(listener, generic, sizeof(address)) == 0) {
+    close(listener);
+    return absl::AlreadyExistsError(
+        absl::StrCat("Another daemon is serving ", path));
+  }
+  unlink(path.c_str());
+  if (bind(listener, generic, sizeof(address)) != 0 ||
+      listen(listener, SOMAXCONN) != 0) {
+    const absl::Status status = SocketError("Cannot listen on", path);
+    close(listener);
+    return status;
+  }
+
+  while (!shutdown_.load(std::memory_order_relaxed)) {
+    pollfd ready = {listener, POLLIN, 0};
+    if (poll(&ready, 1, absl::ToInt64Milliseconds(kPollInterval)) <= 0) {
+      continue;
+    }
+    const int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) continue;
+    {
+      absl::MutexLock lock(&mutex_);
+      connections_.insert(fd);
+    }
+    std::thread([this, fd] { HandleConnection(fd); }).detach();
+  }
+
+  close(listener);
+  unlink(path.c_str());
+  pool_.Stop();
+  absl::MutexLock lock(&mutex_);
+  // Wakes up handlers blocked reading their next request.
+  for (int fd : connections_) shutdown(fd, SHUT_RDWR);
+  mutex_.Await(absl::Condition(
+      +[](absl::flat_hash_set<int>* connections) {
+        return connections->empty();
+      },
+      &connections_));
+  return absl::OkStatus();
+}
+
+void Daemon::HandleConnection(int fd) {
+  while (true) {
+    const absl::StatusOr<std::string> payload = ReadFrame(fd);
+    if (!payload.ok() || !HandleRequest(fd, *payload).ok()) break;
+  }
+  // Closed under the lock, so that Serve() never shuts down a reused fd.
+  absl::MutexLock lock(&mutex_);
+  close(fd);
+  connections_.erase(fd);
+}
+
+absl::Status Daemon::HandleRequest(int fd, absl::string_view payload) {
+  const absl::Time arrival = absl::Now();
+  const absl::StatusOr<DaemonRequest> request = DecodeRequest(payload);
+  if (!request.ok()) return RespondError(fd, request.status());
+  absl::StatusOr<Problem> parsed = ParseProblem(request->problem_json);
+  if (!parsed.ok()) return RespondError(fd, parsed.status());
+  const auto problem = std::make_shared<const Problem>(*std::move(parsed));
+
+  if (const std::optional<SolutionCache::Entry> cached =
+          cache_.Lookup(*problem);
+      cached.has_value()) {
+    return Respond(fd, DaemonResponse::kFinal, cached->latency,
+                   SolutionToJson(cached->solution));
+  }
+
+  const absl::Duration time_limit = request->time_limit > absl::ZeroDuration()
+                                        ? request->time_limit
+                                        : ContestTimeLimit(*problem);
+  SolverPool::JobOptions options;
+  options.solver.seed = options_.seed;
+  options.solver.evaluate = options_.evaluate;
+  options.deadline = arrival + time_limit;
+  options.on_first_solution = [fd](const Solution& solution,
+                                   TotalLatency latency) {
+    // A failure shows up again, and is handled, on the final response.
+    Respond(fd, DaemonResponse::kIncumbent, latency, SolutionToJson(solution))
+        .IgnoreError();
+  };
+  const std::shared_ptr<SolverPool::Job> job =
+      pool_.Submit(problem, options);
+  while (!job->WaitWithTimeout(kPollInterval)) {
+    if (PeerClosed(fd)) job->Cancel();
+  }
+  if (absl::Status status = job->Wait(); !status.ok()) {
+    return RespondError(fd, status);
+  }
+  const Solution best = job->best();
+  cache_.Store(*problem, best).IgnoreError();
+  return Respond(fd, DaemonResponse::kFinal, job->best_latency(),
+                 SolutionToJson(best));
+}
+
+}  // namespace mlsys
@@ -0,0 +1,88 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_DAEMON_H_
+#define MLSYS_DAEMON_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "mlsys.h"
+#include "solution_cache.h"
+#include "solver_pool.h"
+#include "third_party/absl/base/thread_annotations.h"
+#include "third_party/absl/container/flat_hash_set.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/strings/string_view.h"
+#include "third_party/absl/synchronization/mutex.h"
+#include "third_party/absl/time/time.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  A resident scheduler serving requests over a Unix socket.   /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+struct DaemonOptions {
+  std::string socket_path;
+  int num_workers = 1;
+  // Round-robin quantum of the solver pool.
+  absl::Duration slice = absl::Milliseconds(50);
+  // See SolutionCache; an empty directory keeps the cache in memory only.
+  std::string cache_dir;
+  bool cache_isomorphic = false;
+  uint64_t seed = 1;
+  // The cost model every request is solved and cached under.
+  EvaluateOptions evaluate;
+};
+
+// Serves the protocol of daemon_protocol.h.  Each connection gets a thread
+// that only does I/O; the solving happens on a SolverPool shared by every
+// request, so that the cores are split fairly between concurrent requests
+// and no solver thread is ever started per request.  Solutions found are
+// kept in a SolutionCache, and repeated problems are answered from it at
+// once.  A request whose client hangs up is cancelled.
+class Daemon {
+ public:
+  explicit Daemon(DaemonOptions options);
+  Daemon(const Daemon&) = delete;
+  Daemon& operator=(const Daemon&) = delete;
+
+  // Listens on the socket until Shutdown(), then cancels outstanding
+  // requests and waits for their connections to close.
+  absl::Status Serve() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Makes Serve() return; async-signal-safe.
+  void Shutdown() { shutdown_.store(true, std::memory_order_relaxed); }
+
+ private:
+  void HandleConnection(int fd) ABSL_LOCKS_EXCLUDED(mutex_);
+  // Fails only if the response cannot be sent.
+  absl::Status HandleRequest(int fd, absl::string_view payload);
+
+  const DaemonOptions options_;
+  SolverPool pool_;
+  SolutionCache cache_;
+  std::atomic<bool> shutdown_{false};
+
+  absl::Mutex mutex_;
+  absl::flat_hash_set<int> connections_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mlsys
+
+#endif  // MLSYS_DAEMON_H_
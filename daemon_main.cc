@@ -0,0 +1,112 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// A resident scheduler, for callers that schedule many problems:
+//
+//   $ ./mlsysd --socket=/tmp/mlsysd.sock &
+//   $ ./mlsys_client <path_to_input.json> <path_to_output.json>
+//
+// Serves until SIGINT or SIGTERM.
+
+#include <signal.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "daemon.h"
+#include "daemon_protocol.h"
+#include "mlsys.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/flags/parse.h"
+#include "third_party/absl/flags/usage.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/time/time.h"
+
+ABSL_FLAG(std::string, socket, mlsys::kDefaultSocketPath,
+          "Unix domain socket to listen on.");
+ABSL_FLAG(int, workers, 0, "Solver threads; 0 uses every hardware thread.");
+ABSL_FLAG(absl::Duration, slice, absl::Milliseconds(50),
+          "Time slice after which a worker moves on to another request.");
+ABSL_FLAG(std::string, cache_dir, "",
+          "If set, also persists the solution cache in this directory.");
+ABSL_FLAG(bool, cache_isomorphic, false,
+          "Also match cached problems whose ops and tensors are renumbered.");
+ABSL_FLAG(uint64_t, seed, 1, "Random seed.");
+ABSL_FLAG(bool, overlap_prefetch, false,
+          "Optimize for hardware that prefetches a subgraph's first inputs "
+          "during its predecessor, instead of the contest's cost model.");
+ABSL_FLAG(int, num_engines, 1,
+          "Compute engines sharing the slow-memory link, each with an equal "
+          "partition of fast memory.");
+ABSL_FLAG(std::string, bandwidth_sharing, "fair",
+          "With --num_engines > 1, how engines share slow-memory bandwidth: "
+          "`fair` or `dedicated`.");
+ABSL_FLAG(bool, repeated, false,
+          "Optimize the steady-state latency of the graph run back to back, "
+          "with weights retained from one iteration for the next.");
+
+namespace {
+
+mlsys::Daemon* daemon_to_stop = nullptr;
+
+void HandleSignal(int) { daemon_to_stop->Shutdown(); }
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  absl::SetProgramUsageMessage("Usage: mlsysd [flags]");
+  absl::ParseCommandLine(argc, argv);
+
+  mlsys::DaemonOptions options;
+  options.socket_path = absl::GetFlag(FLAGS_socket);
+  options.num_workers = absl::GetFlag(FLAGS_workers);
+  if (options.num_workers <= 0) {
+    options.num_workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+  options.slice = absl::GetFlag(FLAGS_slice);
+  options.cache_dir = absl::GetFlag(FLAGS_cache_dir);
+  options.cache_isomorphic = absl::GetFlag(FLAGS_cache_isomorphic);
+  options.seed = absl::GetFlag(FLAGS_seed);
+  options.evaluate.overlap_prefetch = absl::GetFlag(FLAGS_overlap_prefetch);
+  options.evaluate.repeated = absl::GetFlag(FLAGS_repeated);
+  options.evaluate.num_engines = absl::GetFlag(FLAGS_num_engines);
+  if (options.evaluate.num_engines < 1) {
+    std::cerr << "--num_engines must be positive\n";
+    return 1;
+  }
+  if (const std::string sharing = absl::GetFlag(FLAGS_bandwidth_sharing);
+      sharing == "dedicated") {
+    options.evaluate.bandwidth_sharing = mlsys::BandwidthSharing::kDedicated;
+  } else if (sharing != "fair") {
+    std::cerr << "unknown --bandwidth_sharing: " << sharing << "\n";
+    return 1;
+  }
+  mlsys::Daemon daemon(options);
+
+  daemon_to_stop = &daemon;
+  struct sigaction action = {};
+  action.sa_handler = HandleSignal;
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+  if (const absl::Status status = daemon.Serve(); !status.ok()) {
+    std::cerr << status << "\n";
+    return 1;
+  }
+  return 0;
+}
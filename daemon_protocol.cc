@@ -0,0 +1,163 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "daemon_protocol.h"
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/strings/string_view.h"
+#include "third_party/absl/time/time.h"
+
+namespace mlsys {
+
+namespace {
+
+void AppendUint(uint64_t value, int bytes, std::string* out) {
+  for (int i = 0; i < bytes; ++i) {
+    out->push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+uint64_t ParseUint(absl::string_view in, int bytes) {
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; ++i) {
+    value |= uint64_t{static_cast<unsigned char>(in[i])} << (8 * i);
+  }
+  return value;
+}
+
+absl::Status SendAll(int fd, absl::string_view bytes) {
+  while (!bytes.empty()) {
+    // MSG_NOSIGNAL: a vanished peer is an error, not a SIGPIPE.
+    const ssize_t sent = send(fd, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+    if (sent < 0) {
+      if (errno == EINTR) continue;
+      return absl::UnavailableError(
+          absl::StrCat("send failed: ", std::strerror(errno)));
+    }
+    bytes.remove_prefix(sent);
+  }
+  return absl::OkStatus();
+}
+
+// Fills `size` bytes of `out`; `received` reports how many arrived before
+// an end of stream.
+absl::Status ReceiveAll(int fd, char* out, size_t size, size_t* received) {
+  *received = 0;
+  while (*received < size) {
+    const ssize_t count = recv(fd, out + *received, size - *received, 0);
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      return absl::UnavailableError(
+          absl::StrCat("recv failed: ", std::strerror(errno)));
+    }
+    if (count == 0) {
+      return absl::OutOfRangeError("Connection closed");
+    }
+    *received += count;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+std::string EncodeRequest(const DaemonRequest& request) {
+  std::string payload;
+  AppendUint(absl::ToInt64Microseconds(request.time_limit), 8, &payload);
+  payload += request.problem_json;
+  return payload;
+}
+
+absl::StatusOr<DaemonRequest> DecodeRequest(absl::string_view payload) {
+  if (payload.size() < 8) {
+    return absl::InvalidArgumentError("Truncated request");
+  }
+  DaemonRequest request;
+  request.time_limit = absl::Microseconds(
+      static_cast<int64_t>(ParseUint(payload.substr(0, 8), 8)));
+  request.problem_json = std::string(payload.substr(8));
+  return request;
+}
+
+std::string EncodeResponse(const DaemonResponse& response) {
+  std::string payload(1, static_cast<char>(response.kind));
+  uint64_t latency;
+  static_assert(sizeof(latency) == sizeof(response.latency));
+  std::memcpy(&latency, &response.latency, sizeof(latency));
+  AppendUint(latency, 8, &payload);
+  payload += response.body;
+  return payload;
+}
+
+absl::StatusOr<DaemonResponse> DecodeResponse(absl::string_view payload) {
+  if (payload.size() < 9 ||
+      static_cast<uint8_t>(payload[0]) > DaemonResponse::kError) {
+    return absl::InvalidArgumentError("Malformed response");
+  }
+  DaemonResponse response;
+  response.kind = static_cast<DaemonResponse::Kind>(payload[0]);
+  const uint64_t latency = ParseUint(payload.substr(1, 8), 8);
+  std::memcpy(&response.latency, &latency, sizeof(latency));
+  response.body = std::string(payload.substr(9));
+  return response;
+}
+
+absl::Status WriteFrame(int fd, absl::string_view payload) {
+  if (payload.size() > kMaxFrameBytes) {
+    return absl::InvalidArgumentError("Frame too large");
+  }
+  std::string header;
+  AppendUint(payload.size(), 4, &header);
+  if (absl::Status status = SendAll(fd, header); !status.ok()) return status;
+  return SendAll(fd, payload);
+}
+
+absl::StatusOr<std::string> ReadFrame(int fd) {
+  char header[4];
+  size_t received;
+  if (absl::Status status = ReceiveAll(fd, header, sizeof(header), &received);
+      !status.ok()) {
+    if (absl::IsOutOfRange(status) && received > 0) {
+      return absl::DataLossError("Truncated frame header");
+    }
+    return status;
+  }
+  const uint64_t size = ParseUint(absl::string_view(header, 4), 4);
+  if (size > kMaxFrameBytes) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Frame of ", size, " bytes is too large"));
+  }
+  std::string payload(size, '\0');
+  if (absl::Status status =
+          ReceiveAll(fd, payload.data(), payload.size(), &received);
+      !status.ok()) {
+    return absl::IsOutOfRange(status)
+               ? absl::DataLossError("Truncated frame")
+               : status;
+  }
+  return payload;
+}
+
+}  // namespace mlsys
@@ -0,0 +1,79 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_DAEMON_PROTOCOL_H_
+#define MLSYS_DAEMON_PROTOCOL_H_
+
+#include <cstdint>
+#include <string>
+
+#include "mlsys.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/string_view.h"
+#include "third_party/absl/time/time.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Wire format between mlsysd and its clients.                 /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// Every message travels as a frame: its length as a 4-byte little-endian
+// integer, then that many bytes.  A client sends one request frame per
+// problem and reads response frames until a final or error one; it may then
+// send the next request on the same connection.
+
+// Where mlsysd listens unless told otherwise.
+inline constexpr char kDefaultSocketPath[] = "/tmp/mlsysd.sock";
+
+// Frames larger than this are rejected rather than allocated.
+inline constexpr uint32_t kMaxFrameBytes = uint32_t{1} << 30;
+
+// Payload: the time limit in microseconds as an 8-byte little-endian
+// integer, then the problem in JSON.  A zero time limit stands for the
+// contest timeout of the problem.
+struct DaemonRequest {
+  absl::Duration time_limit = absl::ZeroDuration();
+  std::string problem_json;
+};
+
+// Payload: the kind as one byte, the latency as an 8-byte little-endian
+// IEEE double, then the solution in JSON, or the error message.
+struct DaemonResponse {
+  enum Kind : uint8_t {
+    kIncumbent = 0,  // A first solution; a better one follows.
+    kFinal = 1,
+    kError = 2,
+  };
+  Kind kind = kFinal;
+  TotalLatency latency = 0.0;
+  std::string body;
+};
+
+std::string EncodeRequest(const DaemonRequest& request);
+absl::StatusOr<DaemonRequest> DecodeRequest(absl::string_view payload);
+std::string EncodeResponse(const DaemonResponse& response);
+absl::StatusOr<DaemonResponse> DecodeResponse(absl::string_view payload);
+
+// Blocking frame I/O on a stream socket.  ReadFrame() fails with
+// OutOfRangeError on a clean end of stream before the first byte.
+absl::Status WriteFrame(int fd, absl::string_view payload);
+absl::StatusOr<std::string> ReadFrame(int fd);
+
+}  // namespace mlsys
+
+#endif  // MLSYS_DAEMON_PROTOCOL_H_
@@ -0,0 +1,199 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "engine_scheduler.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "mlsys.h"
+#include "roofline.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+
+namespace mlsys {
+
+namespace {
+
+// Subgraphs that must run back to back on one engine.
+struct Unit {
+  size_t begin;  // Subgraphs [begin, end) of the input solution.
+  size_t end;
+  double duration = 0.0;
+  std::vector<size_t> predecessors = {};  // Units.
+  std::vector<size_t> successors = {};
+  double rank = 0.0;  // Longest path from the start of the unit to the end.
+  int engine = 0;
+  double start = 0.0;
+};
+
+}  // namespace
+
+absl::StatusOr<Solution> ScheduleEngines(const Problem& problem,
+                                         const Solution& solution,
+                                         const EvaluateOptions& options) {
+  const int num_engines = std::max(options.num_engines, 1);
+  Solution serial = solution;
+  for (Subgraph& subgraph : serial.subgraphs) {
+    subgraph.engine = 0;
+    subgraph.dependencies.clear();
+  }
+  Replayer replayer(problem, options);
+  const absl::StatusOr<std::vector<SubgraphLatency>> latencies =
+      replayer.SubgraphLatencies(serial);
+  if (!latencies.ok()) return latencies.status();
+  if (num_engines == 1 || serial.subgraphs.empty()) return serial;
+
+  const size_t num_subgraphs = serial.subgraphs.size();
+  std::vector<Unit> units;
+  std::vector<size_t> unit_of(num_subgraphs);
+  for (size_t index = 0; index < num_subgraphs; ++index) {
+    if (index == 0 || serial.subgraphs[index - 1].tensors_to_retain.empty()) {
+      units.push_back({index, index});
+    }
+    units.back().end = index + 1;
+    units.back().duration += (*latencies)[index];
+    unit_of[index] = units.size() - 1;
+  }
+
+  // A unit follows the units writing its inputs and those its subgraphs
+  // explicitly depend on.
+  std::vector<int64_t> writer(problem.tensors.size(), -1);
+  for (size_t index = 0; index < num_subgraphs; ++index) {
+    const Subgraph& subgraph = solution.subgraphs[index];
+    std::vector<size_t>& predecessors = units[unit_of[index]].predecessors;
+    for (size_t dependency : subgraph.dependencies) {
+      predecessors.push_back(unit_of[dependency]);
+    }
+    for (size_t op : subgraph.ops) {
+      for (size_t tensor : problem.ops[op].inputs) {
+        if (writer[tensor] >= 0) {
+          predecessors.push_back(unit_of[writer[tensor]]);
+        }
+      }
+    }
+    for (size_t op : subgraph.ops) {
+      for (size_t tensor : problem.ops[op].outputs) writer[tensor] = index;
+    }
+  }
+  for (size_t u = 0; u < units.size(); ++u) {
+    std::vector<size_t>& predecessors = units[u].predecessors;
+    std::erase(predecessors, u);
+    std::sort(predecessors.begin(), predecessors.end());
+    predecessors.erase(std::unique(predecessors.begin(), predecessors.end()),
+                       predecessors.end());
+    for (size_t predecessor : predecessors) {
+      units[predecessor].successors.push_back(u);
+    }
+  }
+  // Units are in topological order, as the subgraphs were.
+  for (size_t u = units.size(); u-- > 0;) {
+    double tail = 0.0;
+    for (size_t successor : units[u].successors) {
+      tail = std::max(tail, units[successor].rank);
+    }
+    units[u].rank = units[u].duration + tail;
+  }
+
+  std::vector<double> engine_free(num_engines, 0.0);
+  std::vector<double> finish(units.size(), 0.0);
+  std::vector<size_t> pending(units.size());
+  std::vector<size_t> ready;
+  for (size_t u = 0; u < units.size(); ++u) {
+    pending[u] = units[u].predecessors.size();
+    if (pending[u] == 0) ready.push_back(u);
+  }
+  while (!ready.empty()) {
+    const auto next = std::max_element(
+        ready.begin(), ready.end(), [&](size_t a, size_t b) {
+          return units[a].rank < units[b].rank ||
+                 (units[a].rank == units[b].rank && a > b);
+        });
+    const size_t u = *next;
+    ready.erase(next);
+    Unit& unit = units[u];
+    double available = 0.0;
+    for (size_t predecessor : unit.predecessors) {
+      available = std::max(available, finish[predecessor]);
+    }
+    unit.engine = 0;
+    unit.start = std::numeric_limits<double>::infinity();
+    for (int engine = 0; engine < num_engines; ++engine) {
+      const double start = std::max(available, engine_free[engine]);
+      if (start < unit.start) {
+        unit.start = start;
+        unit.engine = engine;
+      }
+    }
+    finish[u] = unit.start + unit.duration;
+    engine_free[unit.engine] = finish[u];
+    for (size_t successor : unit.successors) {
+      if (--pending[successor] == 0) ready.push_back(successor);
+    }
+  }
+
+  // List the subgraphs by start time; ties keep the input order, which has
+  // producers first.
+  std::vector<double> start(num_subgraphs);
+  for (const Unit& unit : units) {
+    double time = unit.start;
+    for (size_t index = unit.begin; index < unit.end; ++index) {
+      start[index] = time;
+      time += (*latencies)[index];
+    }
+  }
+  std::vector<size_t> order(num_subgraphs);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return start[a] < start[b];
+  });
+  std::vector<size_t> position(num_subgraphs);
+  for (size_t i = 0; i < num_subgraphs; ++i) position[order[i]] = i;
+
+  Solution scheduled;
+  scheduled.subgraphs.reserve(num_subgraphs);
+  for (size_t index : order) {
+    Subgraph& subgraph = scheduled.subgraphs.emplace_back(
+        serial.subgraphs[index]);
+    const Unit& unit = units[unit_of[index]];
+    subgraph.engine = unit.engine;
+    subgraph.subgraph_latency = (*latencies)[index];
+    if (index != unit.begin) continue;
+    for (size_t predecessor : unit.predecessors) {
+      if (units[predecessor].engine == unit.engine) continue;
+      subgraph.dependencies.push_back(
+          position[units[predecessor].end - 1]);
+    }
+    std::sort(subgraph.dependencies.begin(), subgraph.dependencies.end());
+  }
+
+  const absl::StatusOr<TotalLatency> parallel = replayer.Evaluate(scheduled);
+  if (!parallel.ok()) return parallel.status();
+  const absl::StatusOr<TotalLatency> sequential = replayer.Evaluate(serial);
+  if (sequential.ok() && *sequential < *parallel) {
+    for (size_t index = 0; index < num_subgraphs; ++index) {
+      serial.subgraphs[index].subgraph_latency = (*latencies)[index];
+    }
+    return serial;
+  }
+  return scheduled;
+}
+
+}  // namespace mlsys
@@ -0,0 +1,45 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_ENGINE_SCHEDULER_H_
+#define MLSYS_ENGINE_SCHEDULER_H_
+
+#include "mlsys.h"
+#include "third_party/absl/status/statusor.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  List scheduling of subgraphs onto several engines.          /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// Spreads the subgraphs of `solution` over `options.num_engines` engines so
+// that independent ones, such as sibling branches of the graph, run side by
+// side.  Subgraphs chained by retained tensors move as one unit.  Units are
+// placed in order of their longest path to the end of the graph, each on the
+// engine where it can start first, with durations estimated on an idle
+// machine.
+//
+// The result lists the subgraphs by estimated start time, with engines and
+// cross-engine dependencies set.  It is never slower under Evaluate() with
+// `options` than running `solution` on engine 0 alone.
+absl::StatusOr<Solution> ScheduleEngines(const Problem& problem,
+                                         const Solution& solution,
+                                         const EvaluateOptions& options);
+
+}  // namespace mlsys
+
+#endif  // MLSYS_ENGINE_SCHEDULER_H_
@@ -0,0 +1,91 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Runs a solution on real tensors on this machine and reports its measured
+// wall time next to the latency the cost model gives it:
+//
+//   $ ./mlsys_execute --scratch_bytes=1048576 problem.json solution.json
+//
+// With --check, also verifies the tiled outputs against an untiled run.
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "executor.h"
+#include "microkernels.h"
+#include "mlsys.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/flags/parse.h"
+#include "third_party/absl/flags/usage.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/time/time.h"
+
+ABSL_FLAG(int64_t, scratch_bytes, 0,
+          "Size of the arena standing in for fast memory, e.g. the L2 cache; "
+          "0 sizes it to what the solution needs.");
+ABSL_FLAG(int, repetitions, 5, "Timed runs; the fastest is reported.");
+ABSL_FLAG(uint64_t, seed, 1, "Random seed for the graph inputs.");
+ABSL_FLAG(bool, check, false,
+          "Compare the outputs with those of an untiled run.");
+
+int main(int argc, char* argv[]) {
+  absl::SetProgramUsageMessage(
+      "Usage: mlsys_execute [flags] <problem.json> <solution.json>");
+  const std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+  if (args.size() != 3) {
+    std::cerr << "Usage: " << args[0]
+              << " [flags] <problem.json> <solution.json>\n";
+    return 1;
+  }
+  const absl::StatusOr<mlsys::Problem> problem = mlsys::ReadProblem(args[1]);
+  if (!problem.ok()) {
+    std::cerr << problem.status() << "\n";
+    return 1;
+  }
+  const absl::StatusOr<mlsys::Solution> solution =
+      mlsys::ReadSolution(args[2]);
+  if (!solution.ok()) {
+    std::cerr << solution.status() << "\n";
+    return 1;
+  }
+  mlsys::ExecuteOptions options;
+  options.scratch_bytes = absl::GetFlag(FLAGS_scratch_bytes);
+  options.repetitions = absl::GetFlag(FLAGS_repetitions);
+  options.seed = absl::GetFlag(FLAGS_seed);
+  options.check = absl::GetFlag(FLAGS_check);
+  const absl::StatusOr<mlsys::ExecutionReport> report =
+      mlsys::Execute(*problem, *solution, options);
+  if (!report.ok()) {
+    std::cerr << report.status() << "\n";
+    return 1;
+  }
+  for (size_t i = 0; i < report->subgraph_times.size(); ++i) {
+    std::cout << "subgraph " << i << ": modeled "
+              << report->modeled_subgraph_latencies[i] << ", measured "
+              << absl::ToDoubleMicroseconds(report->subgraph_times[i])
+              << " us\n";
+  }
+  std::cout << "total: modeled " << report->modeled_latency << ", measured "
+            << absl::ToDoubleMicroseconds(report->wall_time) << " us ("
+            << mlsys::MicrokernelIsa() << " kernels, "
+            << report->peak_scratch_bytes << " of "
+            << report->scratch_bytes << " scratch bytes)\n";
+  std::cout << "checksum " << report->checksum;
+  if (options.check) std::cout << ", max relative error " << report->max_error;
+  std::cout << "\n";
+  return 0;
+}
@@ -0,0 +1,688 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "executor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "microkernels.h"
+#include "mlsys.h"
+#include "roofline.h"
+#include "third_party/absl/container/flat_hash_map.h"
+#include "third_party/absl/container/flat_hash_set.h"
+#include "third_party/absl/functional/function_ref.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/time/clock.h"
+#include "third_party/absl/time/time.h"
+
+namespace mlsys {
+
+namespace {
+
+int64_t CeilDiv(int64_t a, int64_t b) { return (a + b - 1) / b; }
+
+// Arena buffers start on 64-byte cache lines.
+constexpr int64_t kAlignment = 16;
+
+int64_t Aligned(int64_t floats) {
+  return CeilDiv(floats, kAlignment) * kAlignment;
+}
+
+// A region of a tensor held row-major at `data`.
+struct View {
+  float* data = nullptr;
+  Region region;
+
+  float* at(int64_t row, int64_t col) const {
+    return data + (row - region.row) * region.width + (col - region.col);
+  }
+};
+
+using ViewOf = absl::FunctionRef<const View&(size_t tensor)>;
+
+void Zero(const View& view, const Region& region) {
+  for (int64_t row = region.row; row < region.row + region.height; ++row) {
+    std::fill_n(view.at(row, region.col), region.width, 0.0f);
+  }
+}
+
+// Computes `region` of `output` for `op`.  Reducing rules add the `k_size`
+// elements of the reduction starting at `k_begin` onto what the output holds
+// there; the others overwrite it.  Inputs read as zero past their extents,
+// as where mlsys-2026-17 multiplies a 128-row LHS into a 2048-row output or
+// mlsys-2026-13 adds a 128-wide tensor into a 4096-wide one, so only what
+// their views hold contributes.  Propagate() clips the views the same way.
+void Compute(const Problem& problem, const Op& op, SliceRule rule,
+             ViewOf view_of, size_t output, const Region& region,
+             int64_t k_begin, int64_t k_size) {
+  const View& out = view_of(output);
+  switch (rule) {
+    case SliceRule::kPointwise:
+      for (int64_t row = region.row; row < region.row + region.height; ++row) {
+        float* dst = out.at(row, region.col);
+        std::fill_n(dst, region.width, 0.0f);
+        for (size_t tensor : op.inputs) {
+          const Tensor& input = problem.tensors[tensor];
+          const View& in = view_of(tensor);
+          const int64_t in_row = input.height == 1 ? 0 : row;
+          if (in_row < in.region.row ||
+              in_row >= in.region.row + in.region.height) {
+            continue;
+          }
+          if (input.width == 1) {
+            AddScalar(dst, *in.at(in_row, 0), region.width);
+            continue;
+          }
+          const int64_t col = std::max(region.col, in.region.col);
+          const int64_t col_end = std::min(region.col + region.width,
+                                           in.region.col + in.region.width);
+          if (col < col_end) {
+            AddRow(dst + (col - region.col), in.at(in_row, col),
+                   col_end - col);
+          }
+        }
+        Clamp(dst, region.width);
+      }
+      return;
+    case SliceRule::kMatMul: {
+      const View& lhs = view_of(op.inputs[0]);
+      const View& rhs = view_of(op.inputs[1]);
+      const int64_t row = std::max(region.row, lhs.region.row);
+      const int64_t row_end = std::min(region.row + region.height,
+                                       lhs.region.row + lhs.region.height);
+      const int64_t col = std::max(region.col, rhs.region.col);
+      const int64_t col_end = std::min(region.col + region.width,
+                                       rhs.region.col + rhs.region.width);
+      const int64_t k = std::max({k_begin, lhs.region.col, rhs.region.row});
+      const int64_t k_end =
+          std::min({k_begin + k_size, lhs.region.col + lhs.region.width,
+                    rhs.region.row + rhs.region.height});
+      if (row >= row_end || col >= col_end || k >= k_end) return;
+      Gemm(row_end - row, col_end - col, k_end - k, lhs.at(row, k),
+           lhs.region.width, rhs.at(k, col), rhs.region.width,
+           out.at(row, col), out.region.width);
+      return;
+    }
+    case SliceRule::kRowReduction: {
+      const View& in = view_of(op.inputs[0]);
+      for (int64_t row = region.row; row < region.row + region.height; ++row) {
+        *out.at(row, 0) += SumRow(in.at(row, k_begin), k_size);
+      }
+      return;
+    }
+    case SliceRule::kColumnReduction: {
+      const View& in = view_of(op.inputs[0]);
+      for (int64_t row = k_begin; row < k_begin + k_size; ++row) {
+        AddRow(out.at(0, region.col), in.at(row, region.col), region.width);
+      }
+      return;
+    }
+    case SliceRule::kTranspose: {
+      const View& in = view_of(op.inputs[0]);
+      for (int64_t row = region.row; row < region.row + region.height; ++row) {
+        TransposeRow(out.at(row, region.col), in.at(region.col, row),
+                     in.region.width, region.width);
+      }
+      return;
+    }
+  }
+}
+
+// Ops in an order where producers come first.
+std::vector<size_t> TopologicalOrder(const Problem& problem,
+                                     const std::vector<size_t>& ops,
+                                     const std::vector<int64_t>& producer) {
+  absl::flat_hash_map<size_t, int64_t> pending;  // Unfinished producers.
+  absl::flat_hash_map<size_t, std::vector<size_t>> consumers;
+  for (size_t op : ops) pending[op] = 0;
+  for (size_t op : ops) {
+    for (size_t tensor : problem.ops[op].inputs) {
+      const int64_t source = producer[tensor];
+      if (source < 0 || !pending.contains(source)) continue;
+      ++pending[op];
+      consumers[source].push_back(op);
+    }
+  }
+  std::vector<size_t> order;
+  for (size_t op : ops) {
+    if (pending[op] == 0) order.push_back(op);
+  }
+  for (size_t next = 0; next < order.size(); ++next) {
+    for (size_t consumer : consumers[order[next]]) {
+      if (--pending[consumer] == 0) order.push_back(consumer);
+    }
+  }
+  return order;
+}
+
+// Plans every subgraph once, placing its buffers in the arena, and then runs
+// the plans as often as asked.
+class Executor {
+ public:
+  Executor(const Problem& problem, const Solution& solution,
+           int64_t scratch_floats);
+
+  absl::Status Plan();
+  void FillInputs(uint64_t seed);
+  void Run(std::vector<absl::Duration>* subgraph_times);
+  double Checksum() const;
+  // Recomputes every op whole, outside the arena, and compares the graph
+  // outputs.
+  double MaxError() const;
+
+  int64_t peak_floats() const { return peak_; }
+
+ private:
+  struct Local {
+    size_t id = 0;
+    bool produced = false;  // By an op of the subgraph.
+    bool consumed = false;  // By an op of the subgraph.
+    bool resident = false;  // Retained by the previous subgraph.
+    bool whole = false;     // Held whole: resident, or retained by this one.
+    int64_t offset = 0;     // In the arena.
+    int64_t capacity = 0;   // Floats, if tiled.
+    View view;
+    Region need;
+    Region previous;
+    bool loaded = false;
+  };
+
+  struct OpPlan {
+    size_t op = 0;
+    SliceRule rule = SliceRule::kPointwise;
+    Depth reduction = 0;
+    bool split = false;  // Accumulates across the reduction steps.
+    std::vector<size_t> inputs;  // Slots of `locals`.
+    std::vector<size_t> outputs;
+    // For the current step.
+    Region out;
+    int64_t k_begin = 0;
+    int64_t k_size = 0;
+  };
+
+  // A retained tensor moving down the arena for the next subgraph.
+  struct Move {
+    int64_t from = 0;
+    int64_t to = 0;
+    int64_t size = 0;
+  };
+
+  struct SubgraphPlan {
+    const Subgraph* subgraph = nullptr;
+    std::vector<Local> locals;
+    absl::flat_hash_map<size_t, size_t> slot;  // Tensor to local.
+    std::vector<OpPlan> ops;                   // Topologically sorted.
+    int64_t num_k_steps = 1;
+    Width grid_width = 1;
+    Height grid_height = 1;
+    std::vector<Move> moves;
+  };
+
+  using Resident = std::vector<std::pair<size_t, int64_t>>;  // Offsets.
+
+  absl::Status PlanSubgraph(size_t index, const Subgraph& subgraph,
+                            Resident* resident);
+  // Sets the slices every tensor and op of `plan` needs for one step.
+  void Propagate(SubgraphPlan& plan, const Region& output, int64_t k_step);
+  template <typename F>
+  void ForEachStep(SubgraphPlan& plan, F visit);
+  void RunSubgraph(SubgraphPlan& plan);
+
+  void CopyIn(const Local& local, const Region& region);
+  void CopyOut(const Local& local, const Region& region);
+
+  int64_t Size(size_t tensor) const {
+    return problem_.tensors[tensor].width * problem_.tensors[tensor].height;
+  }
+
+  const Problem& problem_;
+  const Solution& solution_;
+  std::vector<int64_t> producer_;    // Per tensor.
+  std::vector<char> has_consumer_;   // Per tensor.
+  std::vector<std::vector<float>> tensors_;  // Slow memory.
+  const int64_t scratch_floats_;  // Zero for as much as the plans need.
+  std::vector<float> arena_;      // Fast memory.
+  std::vector<SubgraphPlan> plans_;
+  int64_t peak_ = 0;
+};
+
+Executor::Executor(const Problem& problem, const Solution& solution,
+                   int64_t scratch_floats)
+    : problem_(problem),
+      solution_(solution),
+      producer_(problem.tensors.size(), -1),
+      has_consumer_(problem.tensors.size(), 0),
+      tensors_(problem.tensors.size()),
+      scratch_floats_(scratch_floats) {
+  for (size_t op = 0; op < problem.ops.size(); ++op) {
+    for (size_t tensor : problem.ops[op].outputs) producer_[tensor] = op;
+    for (size_t tensor : problem.ops[op].inputs) has_consumer_[tensor] = 1;
+  }
+  for (size_t tensor = 0; tensor < tensors_.size(); ++tensor) {
+    tensors_[tensor].assign(Size(tensor), 0.0f);
+  }
+}
+
+absl::Status Executor::Plan() {
+  plans_.clear();
+  plans_.reserve(solution_.subgraphs.size());
+  Resident resident;
+  for (size_t index = 0; index < solution_.subgraphs.size(); ++index) {
+    if (absl::Status status =
+            PlanSubgraph(index, solution_.subgraphs[index], &resident);
+        !status.ok()) {
+      return status;
+    }
+  }
+  arena_.assign(scratch_floats_ > 0 ? scratch_floats_ : peak_, 0.0f);
+  return absl::OkStatus();
+}
+
+absl::Status Executor::PlanSubgraph(size_t index, const Subgraph& subgraph,
+                                    Resident* resident) {
+  SubgraphPlan& plan = plans_.emplace_back();
+  plan.subgraph = &subgraph;
+  const auto local_of = [&](size_t tensor) -> Local& {
+    const auto [it, inserted] = plan.slot.try_emplace(tensor,
+                                                      plan.locals.size());
+    if (inserted) plan.locals.emplace_back().id = tensor;
+    return plan.locals[it->second];
+  };
+  for (size_t op : subgraph.ops) {
+    for (size_t tensor : problem_.ops[op].outputs) {
+      local_of(tensor).produced = true;
+    }
+    for (size_t tensor : problem_.ops[op].inputs) {
+      local_of(tensor).consumed = true;
+    }
+  }
+
+  // As in Replayer: MatMuls and Reductions on the way to the output grid
+  // accumulate over the reduction steps, the others reduce whole.
+  for (size_t op : TopologicalOrder(problem_, subgraph.ops, producer_)) {
+    OpPlan& op_plan = plan.ops.emplace_back();
+    op_plan.op = op;
+    const absl::StatusOr<SliceRule> rule = GetSliceRule(problem_, op);
+    if (!rule.ok()) return rule.status();
+    op_plan.rule = *rule;
+    op_plan.reduction = ReductionDepth(problem_, problem_.ops[op]);
+    for (size_t tensor : problem_.ops[op].inputs) {
+      op_plan.inputs.push_back(plan.slot.at(tensor));
+    }
+    for (size_t tensor : problem_.ops[op].outputs) {
+      op_plan.outputs.push_back(plan.slot.at(tensor));
+    }
+  }
+  std::vector<char> split_demand(plan.locals.size(), 0);
+  for (size_t position = plan.ops.size(); position-- > 0;) {
+    OpPlan& op = plan.ops[position];
+    for (size_t slot : op.outputs) {
+      op.split |= !plan.locals[slot].consumed || split_demand[slot];
+    }
+    if (!op.split) continue;
+    if (op.reduction > 0) {
+      plan.num_k_steps = std::max(
+          plan.num_k_steps, CeilDiv(op.reduction, subgraph.granularity.depth));
+    } else {
+      for (size_t slot : op.inputs) split_demand[slot] = 1;
+    }
+  }
+  for (const Local& local : plan.locals) {
+    if (local.produced && !local.consumed) {
+      plan.grid_width =
+          std::max(plan.grid_width, problem_.tensors[local.id].width);
+      plan.grid_height =
+          std::max(plan.grid_height, problem_.tensors[local.id].height);
+    }
+  }
+
+  // Tiled buffers hold the largest slice any step needs.
+  ForEachStep(plan, [&](int64_t, bool) {
+    for (Local& local : plan.locals) {
+      local.capacity = std::max(local.capacity, local.need.size());
+    }
+  });
+
+  // Whole tensors retained from the previous subgraph sit at the bottom of
+  // the arena; this subgraph's buffers go above them.
+  absl::flat_hash_set<size_t> retained;
+  for (size_t i = 0; i < subgraph.tensors_to_retain.size(); ++i) {
+    if (RetentionLevel(subgraph, i) == MemoryLevel::kFast) {
+      retained.insert(subgraph.tensors_to_retain[i]);
+    }
+  }
+  absl::flat_hash_map<size_t, int64_t> entry;
+  int64_t cursor = 0;
+  for (const auto& [tensor, offset] : *resident) {
+    entry[tensor] = offset;
+    cursor = std::max(cursor, offset + Aligned(Size(tensor)));
+  }
+  for (Local& local : plan.locals) {
+    if (const auto it = entry.find(local.id); it != entry.end()) {
+      local.resident = true;
+      local.whole = true;
+      local.offset = it->second;
+    } else if (retained.contains(local.id)) {
+      local.whole = true;
+      local.offset = cursor;
+      cursor += Aligned(Size(local.id));
+    } else {
+      local.offset = cursor;
+      cursor += Aligned(local.capacity);
+    }
+    if (local.whole) {
+      local.view.region = {0, 0, problem_.tensors[local.id].height,
+                           problem_.tensors[local.id].width};
+    }
+  }
+  if (scratch_floats_ > 0 && cursor > scratch_floats_) {
+    return absl::ResourceExhaustedError(absl::StrCat(
+        "Subgraph ", index, " needs ", cursor * sizeof(float),
+        " bytes of scratch; the arena has ", scratch_floats_ * sizeof(float)));
+  }
+  peak_ = std::max(peak_, cursor);
+
+  // What this subgraph retains moves down to the bottom of the arena, in the
+  // order it already has there so that no move overwrites another.
+  Resident next;
+  for (size_t tensor : retained) {
+    if (const auto it = plan.slot.find(tensor); it != plan.slot.end()) {
+      next.push_back({tensor, plan.locals[it->second].offset});
+    } else if (const auto kept = entry.find(tensor); kept != entry.end()) {
+      next.push_back({tensor, kept->second});
+    }
+  }
+  std::sort(next.begin(), next.end(),
+            [](const auto& a, const auto& b) { return a.second < b.second; });
+  int64_t bottom = 0;
+  for (auto& [tensor, offset] : next) {
+    if (offset != bottom) plan.moves.push_back({offset, bottom, Size(tensor)});
+    offset = bottom;
+    bottom += Aligned(Size(tensor));
+  }
+  *resident = std::move(next);
+  return absl::OkStatus();
+}
+
+void Executor::Propagate(SubgraphPlan& plan, const Region& output,
+                         int64_t k_step) {
+  for (Local& local : plan.locals) {
+    local.need = Region();
+    if (local.produced && !local.consumed) {
+      local.need = Clip(output.row, output.height, output.col, output.width,
+                        problem_.tensors[local.id]);
+    }
+  }
+  const Depth depth = plan.subgraph->granularity.depth;
+  for (size_t position = plan.ops.size(); position-- > 0;) {
+    OpPlan& op = plan.ops[position];
+    Region out;
+    for (size_t slot : op.outputs) out = Union(out, plan.locals[slot].need);
+    op.out = out;
+    if (out.empty()) continue;
+    const auto need = [&](size_t slot, int64_t row, int64_t height,
+                          int64_t col, int64_t width) {
+      Local& input = plan.locals[slot];
+      input.need = Union(input.need, Clip(row, height, col, width,
+                                          problem_.tensors[input.id]));
+    };
+    if (op.rule == SliceRule::kPointwise) {
+      for (size_t slot : op.inputs) {
+        need(slot, out.row, out.height, out.col, out.width);
+      }
+      continue;
+    }
+    if (op.rule == SliceRule::kTranspose) {
+      need(op.inputs[0], out.col, out.width, out.row, out.height);
+      continue;
+    }
+    op.k_begin = 0;
+    op.k_size = op.reduction;
+    if (op.split) {
+      op.k_begin = k_step * depth;
+      op.k_size = std::min(depth, op.reduction - op.k_begin);
+      if (op.k_size <= 0) {
+        op.out = Region();
+        continue;
+      }
+    }
+    if (op.rule == SliceRule::kRowReduction) {
+      need(op.inputs[0], out.row, out.height, op.k_begin, op.k_size);
+    } else if (op.rule == SliceRule::kColumnReduction) {
+      need(op.inputs[0], op.k_begin, op.k_size, out.col, out.width);
+    } else {
+      need(op.inputs[0], out.row, out.height, op.k_begin, op.k_size);
+      need(op.inputs[1], op.k_begin, op.k_size, out.col, out.width);
+    }
+  }
+}
+
+template <typename F>
+void Executor::ForEachStep(SubgraphPlan& plan, F visit) {
+  const Subgraph& subgraph = *plan.subgraph;
+  const Granularity& granularity = subgraph.granularity;
+  const int64_t grid_cols = CeilDiv(plan.grid_width, granularity.width);
+  const int64_t num_tiles =
+      grid_cols * CeilDiv(plan.grid_height, granularity.height);
+  for (int64_t position = 0; position < num_tiles; ++position) {
+    const int64_t tile = subgraph.traversal_order.has_value()
+                             ? (*subgraph.traversal_order)[position]
+                             : position;
+    const Region output = {(tile / grid_cols) * granularity.height,
+                           (tile % grid_cols) * granularity.width,
+                           granularity.height, granularity.width};
+    for (int64_t k_step = 0; k_step < plan.num_k_steps; ++k_step) {
+      Propagate(plan, output, k_step);
+      visit(k_step, k_step + 1 == plan.num_k_steps);
+    }
+  }
+}
+
+void Executor::CopyIn(const Local& local, const Region& region) {
+  const float* source = tensors_[local.id].data();
+  const int64_t width = problem_.tensors[local.id].width;
+  for (int64_t row = region.row; row < region.row + region.height; ++row) {
+    std::memcpy(local.view.at(row, region.col),
+                source + row * width + region.col,
+                region.width * sizeof(float));
+  }
+}
+
+void Executor::CopyOut(const Local& local, const Region& region) {
+  float* destination = tensors_[local.id].data();
+  const int64_t width = problem_.tensors[local.id].width;
+  for (int64_t row = region.row; row < region.row + region.height; ++row) {
+    std::memcpy(destination + row * width + region.col,
+                local.view.at(row, region.col), region.width * sizeof(float));
+  }
+}
+
+void Executor::RunSubgraph(SubgraphPlan& plan) {
+  for (Local& local : plan.locals) {
+    local.view.data = arena_.data() + local.offset;
+    local.previous = Region();
+    local.loaded = false;
+  }
+  const auto view_of = [&](size_t tensor) -> const View& {
+    return plan.locals[plan.slot.at(tensor)].view;
+  };
+  const bool has_traversal = plan.subgraph->traversal_order.has_value();
+  ForEachStep(plan, [&](int64_t k_step, bool last_k_step) {
+    // Loads, skipping slices still in the arena from the previous step as
+    // Replayer does.
+    const bool reuse = k_step > 0 || has_traversal;
+    for (Local& local : plan.locals) {
+      if (local.resident) continue;
+      if (local.produced) {
+        if (!local.whole && !local.need.empty()) {
+          local.view.region = local.need;
+        }
+        continue;
+      }
+      if (local.whole) {
+        if (!local.need.empty() && !local.loaded) {
+          CopyIn(local, local.view.region);
+          local.loaded = true;
+        }
+        continue;
+      }
+      if (!local.need.empty() && !(reuse && local.need == local.previous)) {
+        local.view.region = local.need;
+        CopyIn(local, local.need);
+      }
+      local.previous = local.need;
+    }
+
+    for (const OpPlan& op : plan.ops) {
+      if (op.out.empty()) continue;
+      const bool reducing = op.reduction > 0;
+      // The rest of an accumulating chain waits for the sums.
+      if (!reducing && op.split && !last_k_step) continue;
+      for (size_t slot : op.outputs) {
+        const Local& output = plan.locals[slot];
+        if (output.need.empty()) continue;
+        if (reducing && (!op.split || k_step == 0)) {
+          Zero(output.view, output.need);
+        }
+        Compute(problem_, problem_.ops[op.op], op.rule, view_of, output.id,
+                output.need, op.k_begin, op.k_size);
+      }
+    }
+
+    if (!last_k_step) return;
+    for (const Local& local : plan.locals) {
+      if (local.produced && !local.consumed && !local.whole &&
+          !local.need.empty()) {
+        CopyOut(local, local.need);
+      }
+    }
+  });
+  for (const Move& move : plan.moves) {
+    std::memmove(arena_.data() + move.to, arena_.data() + move.from,
+                 move.size * sizeof(float));
+  }
+}
+
+void Executor::FillInputs(uint64_t seed) {
+  std::mt19937_64 random(seed);
+  for (size_t tensor = 0; tensor < tensors_.size(); ++tensor) {
+    if (producer_[tensor] >= 0) continue;
+    // Scaled so that sums over a row stay near one.
+    const float scale =
+        1.0f / std::sqrt(static_cast<float>(problem_.tensors[tensor].width));
+    std::uniform_real_distribution<float> noise(-scale, scale);
+    for (float& value : tensors_[tensor]) value = noise(random);
+  }
+}
+
+void Executor::Run(std::vector<absl::Duration>* subgraph_times) {
+  subgraph_times->resize(plans_.size(), absl::InfiniteDuration());
+  for (size_t index = 0; index < plans_.size(); ++index) {
+    const absl::Time start = absl::Now();
+    RunSubgraph(plans_[index]);
+    (*subgraph_times)[index] =
+        std::min((*subgraph_times)[index], absl::Now() - start);
+  }
+}
+
+double Executor::Checksum() const {
+  double sum = 0.0;
+  for (size_t tensor = 0; tensor < tensors_.size(); ++tensor) {
+    if (has_consumer_[tensor]) continue;
+    for (float value : tensors_[tensor]) sum += value;
+  }
+  return sum;
+}
+
+double Executor::MaxError() const {
+  std::vector<std::vector<float>> reference = tensors_;
+  std::vector<View> views(reference.size());
+  for (size_t tensor = 0; tensor < reference.size(); ++tensor) {
+    views[tensor] = {reference[tensor].data(),
+                     {0, 0, problem_.tensors[tensor].height,
+                      problem_.tensors[tensor].width}};
+  }
+  std::vector<size_t> ops(problem_.ops.size());
+  for (size_t op = 0; op < ops.size(); ++op) ops[op] = op;
+  for (size_t op : TopologicalOrder(problem_, ops, producer_)) {
+    const Op& spec = problem_.ops[op];
+    const SliceRule rule = *GetSliceRule(problem_, op);
+    for (size_t output : spec.outputs) {
+      if (rule != SliceRule::kPointwise && rule != SliceRule::kTranspose) {
+        Zero(views[output], views[output].region);
+      }
+      Compute(problem_, spec, rule,
+              [&](size_t tensor) -> const View& { return views[tensor]; },
+              output, views[output].region, 0,
+              ReductionDepth(problem_, spec));
+    }
+  }
+  double error = 0.0;
+  double magnitude = 0.0;
+  for (size_t tensor = 0; tensor < tensors_.size(); ++tensor) {
+    if (has_consumer_[tensor]) continue;
+    for (size_t i = 0; i < tensors_[tensor].size(); ++i) {
+      error = std::max<double>(
+          error, std::abs(tensors_[tensor][i] - reference[tensor][i]));
+      magnitude = std::max<double>(magnitude, std::abs(reference[tensor][i]));
+    }
+  }
+  return magnitude > 0.0 ? error / magnitude : error;
+}
+
+}  // namespace
+
+absl::StatusOr<ExecutionReport> Execute(const Problem& problem,
+                                        const Solution& solution,
+                                        const ExecuteOptions& options) {
+  ExecutionReport report;
+  Replayer replayer(problem);
+  const absl::StatusOr<TotalLatency> modeled = replayer.Evaluate(solution);
+  if (!modeled.ok()) return modeled.status();
+  report.modeled_latency = *modeled;
+  absl::StatusOr<std::vector<SubgraphLatency>> latencies =
+      replayer.SubgraphLatencies(solution);
+  if (!latencies.ok()) return latencies.status();
+  report.modeled_subgraph_latencies = *std::move(latencies);
+
+  Executor executor(problem, solution, options.scratch_bytes / sizeof(float));
+  if (absl::Status status = executor.Plan(); !status.ok()) return status;
+  report.peak_scratch_bytes = executor.peak_floats() * sizeof(float);
+  report.scratch_bytes = options.scratch_bytes > 0 ? options.scratch_bytes
+                                                   : report.peak_scratch_bytes;
+  executor.FillInputs(options.seed);
+
+  report.wall_time = absl::InfiniteDuration();
+  for (int run = 0; run < std::max(options.repetitions, 1); ++run) {
+    const absl::Time start = absl::Now();
+    executor.Run(&report.subgraph_times);
+    report.wall_time = std::min(report.wall_time, absl::Now() - start);
+  }
+  report.checksum = executor.Checksum();
+  if (options.check) report.max_error = executor.MaxError();
+  return report;
+}
+
+}  // namespace mlsys
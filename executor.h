@@ -0,0 +1,88 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_EXECUTOR_H_
+#define MLSYS_EXECUTOR_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "mlsys.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/time/time.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Execution of solutions on real tensors on the host CPU.     /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// Tensors hold floats whatever their `element_bytes`.  Ops compute:
+//
+//   MatMul     the product of its two inputs;
+//   Pointwise  the sum of its inputs, broadcasting dimensions of size one,
+//              clamped to [-1, 1] so that deep graphs stay finite, into
+//              each of its outputs;
+//   Reduction  the sums of the rows or columns of its input;
+//   Transpose  its input transposed.
+//
+// Graph inputs are filled with seeded uniform noise.
+struct ExecuteOptions {
+  // The scratch arena standing in for fast memory, e.g. the size of the L2
+  // cache.  Zero sizes it to what the solution needs, which exceeds the
+  // modeled working set by the intermediates of fused ops and by buffers
+  // sized for their largest slice.
+  int64_t scratch_bytes = 0;
+  // Timed runs; the report gives the fastest.
+  int repetitions = 1;
+  uint64_t seed = 1;
+  // Also computes every op whole, without tiling, and reports how far the
+  // graph outputs are from that.
+  bool check = false;
+};
+
+struct ExecutionReport {
+  absl::Duration wall_time;                    // Of the fastest run.
+  std::vector<absl::Duration> subgraph_times;  // The fastest of each.
+  TotalLatency modeled_latency = 0.0;
+  std::vector<SubgraphLatency> modeled_subgraph_latencies;
+  int64_t scratch_bytes = 0;
+  int64_t peak_scratch_bytes = 0;  // The end of the highest buffer placed.
+  double checksum = 0.0;           // The sum of every graph output.
+  // With ExecuteOptions::check, the largest difference from the untiled
+  // outputs, relative to their largest magnitude.
+  double max_error = 0.0;
+};
+
+// Runs `solution` subgraph by subgraph, in order and on one thread, with the
+// kernels of microkernels.h.  Slow
+// memory is a buffer per tensor; fast memory is the scratch arena, holding
+// the whole tensors retained between subgraphs and the slices each step
+// needs.  Steps follow the traversal order and granularity of their
+// subgraph and move exactly the slices Replayer charges for: loads into the
+// arena, stores of outputs back once their last reduction step is done, and
+// intermediates of fused ops passed between them in the arena.  Middle
+// memory is not modeled; tensors retained there go through slow memory.
+//
+// Fails like Evaluate() on an invalid solution, and with RESOURCE_EXHAUSTED
+// if the arena is too small for it.
+absl::StatusOr<ExecutionReport> Execute(const Problem& problem,
+                                        const Solution& solution,
+                                        const ExecuteOptions& options = {});
+
+}  // namespace mlsys
+
+#endif  // MLSYS_EXECUTOR_H_
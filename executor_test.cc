@@ -0,0 +1,108 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Checks the tiled executor against its untiled reference on the released
+// benchmarks, run from the root of the repository.
+
+#include "executor.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "mlsys.h"
+#include "roofline.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/googletest/googletest/include/gtest/gtest.h"
+
+namespace mlsys {
+namespace {
+
+// One subgraph per op, in index order, each at the largest square tile up to
+// the native size and the deepest reduction slice that fit.
+Solution SingleOpSolution(const Problem& problem) {
+  Replayer replayer(problem);
+  Solution solution;
+  for (size_t op = 0; op < problem.ops.size(); ++op) {
+    const Tensor& output = problem.tensors[problem.ops[op].outputs.front()];
+    Subgraph subgraph{{op}, {}, {}, std::nullopt, 0.0};
+    bool fits = false;
+    for (int64_t size = problem.native_granularity.width; !fits && size >= 1;
+         size /= 2) {
+      for (Depth depth =
+               std::max<Depth>(1, ReductionDepth(problem, problem.ops[op]));
+           !fits && depth >= 1; depth /= 2) {
+        subgraph.granularity = {std::min(size, output.width),
+                                std::min(size, output.height), depth};
+        const absl::StatusOr<SubgraphLatency> latency =
+            replayer.SubgraphCost(subgraph, {});
+        fits = latency.ok();
+        if (fits) subgraph.subgraph_latency = *latency;
+      }
+    }
+    solution.subgraphs.push_back(subgraph);
+  }
+  return solution;
+}
+
+class ExecutorTest : public testing::TestWithParam<std::string> {};
+
+// mlsys-2026-17 multiplies LHS operands with fewer rows than the output,
+// which the untiled reference used to read past.  The larger benchmarks take
+// minutes to check.
+TEST_P(ExecutorTest, MatchesReference) {
+  const absl::StatusOr<Problem> problem =
+      ReadProblem(absl::StrCat("benchmarks/mlsys-2026-", GetParam(), ".json"));
+  ASSERT_TRUE(problem.ok()) << problem.status();
+  ExecuteOptions options;
+  options.check = true;
+  const absl::StatusOr<ExecutionReport> report =
+      Execute(*problem, SingleOpSolution(*problem), options);
+  ASSERT_TRUE(report.ok()) << report.status();
+  EXPECT_LT(report->max_error, 1e-4);
+}
+
+INSTANTIATE_TEST_SUITE_P(Released, ExecutorTest,
+                         testing::Values("1", "5", "17"));
+
+// As in mlsys-2026-13, a Pointwise op adds a narrower tensor into a wider
+// output; it reads as zero past its width.
+TEST(ExecuteTest, PointwiseReadsNarrowInputAsZero) {
+  const absl::StatusOr<Problem> problem = ParseProblem(R"({
+    "widths": [64, 16, 64],
+    "heights": [32, 32, 32],
+    "inputs": [[0, 1]],
+    "outputs": [[2]],
+    "base_costs": [100],
+    "op_types": ["Pointwise"],
+    "fast_memory_capacity": 10000,
+    "slow_memory_bandwidth": 10,
+    "native_granularity": [16, 16]
+  })");
+  ASSERT_TRUE(problem.ok()) << problem.status();
+  ExecuteOptions options;
+  options.check = true;
+  const absl::StatusOr<ExecutionReport> report =
+      Execute(*problem, SingleOpSolution(*problem), options);
+  ASSERT_TRUE(report.ok()) << report.status();
+  EXPECT_LT(report->max_error, 1e-4);
+}
+
+}  // namespace
+}  // namespace mlsys
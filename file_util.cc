@@ -0,0 +1,63 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "file_util.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/strings/string_view.h"
+
+namespace mlsys {
+
+absl::StatusOr<std::string> ReadFile(const std::string& filename) {
+  std::ifstream file(filename, std::ios::binary);
+  if (!file) {
+    return absl::NotFoundError(absl::StrCat("Cannot open ", filename));
+  }
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  return std::move(contents).str();
+}
+
+absl::Status WriteFile(const std::string& filename,
+                       absl::string_view contents) {
+  const std::string temporary = absl::StrCat(filename, ".tmp");
+  std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return absl::NotFoundError(absl::StrCat("Cannot open ", temporary));
+  }
+  file.write(contents.data(), contents.size());
+  file.close();
+  if (!file) {
+    std::remove(temporary.c_str());
+    return absl::DataLossError(absl::StrCat("Cannot write ", temporary));
+  }
+  if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    return absl::DataLossError(
+        absl::StrCat("Cannot rename ", temporary, " to ", filename));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace mlsys
@@ -0,0 +1,36 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_FILE_UTIL_H_
+#define MLSYS_FILE_UTIL_H_
+
+#include <string>
+
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/string_view.h"
+
+namespace mlsys {
+
+absl::StatusOr<std::string> ReadFile(const std::string& filename);
+
+// Writes through a temporary file renamed over `filename`, so that a reader
+// (or a harness killing the process midway) never sees a partial file.
+absl::Status WriteFile(const std::string& filename, absl::string_view contents);
+
+}  // namespace mlsys
+
+#endif  // MLSYS_FILE_UTIL_H_
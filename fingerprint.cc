@@ -0,0 +1,266 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "fingerprint.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mlsys.h"
+#include "third_party/absl/strings/str_format.h"
+#include "third_party/absl/strings/string_view.h"
+
+namespace mlsys {
+
+namespace {
+
+// Past this many individualized ops, the remaining ties are broken by index.
+constexpr int kMaxIndividualizations = 32;
+
+// The splitmix64 finalizer.
+uint64_t Mix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111eb;
+  x ^= x >> 31;
+  return x;
+}
+
+uint64_t Combine(uint64_t seed, uint64_t value) {
+  return Mix(seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2)));
+}
+
+uint64_t HashString(absl::string_view value) {
+  uint64_t hash = value.size();
+  for (char c : value) hash = Combine(hash, static_cast<unsigned char>(c));
+  return hash;
+}
+
+size_t CountDistinct(std::vector<uint64_t> colors) {
+  std::sort(colors.begin(), colors.end());
+  return std::unique(colors.begin(), colors.end()) - colors.begin();
+}
+
+// Colour refinement over the bipartite graph of ops and tensors.  An op's
+// inputs are ordered (a MatMul's operands are not interchangeable); a
+// tensor's consumers are a multiset of (op colour, operand position).
+class Refinement {
+ public:
+  explicit Refinement(const Problem& problem)
+      : problem_(problem),
+        op_colors_(problem.ops.size()),
+        tensor_colors_(problem.tensors.size()),
+        producer_(problem.tensors.size(), -1),
+        consumers_(problem.tensors.size()) {
+    for (size_t op = 0; op < problem.ops.size(); ++op) {
+      const Op& spec = problem.ops[op];
+      for (size_t tensor : spec.outputs) producer_[tensor] = op;
+      for (size_t i = 0; i < spec.inputs.size(); ++i) {
+        consumers_[spec.inputs[i]].push_back({op, i});
+      }
+      uint64_t color = HashString(spec.op_type);
+      color = Combine(color, spec.base_cost);
+      color = Combine(color, spec.inputs.size());
+      op_colors_[op] = Combine(color, spec.outputs.size());
+    }
+    for (size_t tensor = 0; tensor < problem.tensors.size(); ++tensor) {
+      uint64_t color = Combine(problem.tensors[tensor].width,
+                               problem.tensors[tensor].height);
+      // The default unit element size stays out of the colour, keeping the
+      // cache keys of problems that give no sizes.
+      if (const ElementBytes bytes = problem.tensors[tensor].element_bytes;
+          bytes != 1) {
+        color = Combine(color, bytes);
+      }
+      color = Combine(color, producer_[tensor] < 0);
+      tensor_colors_[tensor] = Combine(color, consumers_[tensor].empty());
+    }
+  }
+
+  // Refines until the partition stops splitting.
+  void Refine() {
+    size_t classes = CountDistinct(op_colors_) + CountDistinct(tensor_colors_);
+    std::vector<uint64_t> consumer_colors;
+    while (true) {
+      std::vector<uint64_t> tensor_colors = tensor_colors_;
+      for (size_t tensor = 0; tensor < tensor_colors.size(); ++tensor) {
+        uint64_t& color = tensor_colors[tensor];
+        if (producer_[tensor] >= 0) {
+          color = Combine(color, op_colors_[producer_[tensor]]);
+        }
+        consumer_colors.clear();
+        for (const auto& [op, position] : consumers_[tensor]) {
+          consumer_colors.push_back(Combine(op_colors_[op], position));
+        }
+        std::sort(consumer_colors.begin(), consumer_colors.end());
+        for (uint64_t consumer : consumer_colors) {
+          color = Combine(color, consumer);
+        }
+      }
+      std::vector<uint64_t> op_colors = op_colors_;
+      for (size_t op = 0; op < op_colors.size(); ++op) {
+        const Op& spec = problem_.ops[op];
+        for (size_t tensor : spec.inputs) {
+          op_colors[op] = Combine(op_colors[op], tensor_colors_[tensor]);
+        }
+        for (size_t tensor : spec.outputs) {
+          op_colors[op] = Combine(op_colors[op], ~tensor_colors_[tensor]);
+        }
+      }
+      op_colors_ = std::move(op_colors);
+      tensor_colors_ = std::move(tensor_colors);
+      const size_t refined =
+          CountDistinct(op_colors_) + CountDistinct(tensor_colors_);
+      if (refined == classes) return;
+      classes = refined;
+    }
+  }
+
+  // Gives one op of the smallest tied colour a colour of its own.  Returns
+  // false once every op has a distinct colour.
+  bool Individualize() {
+    std::vector<std::pair<uint64_t, size_t>> sorted;
+    for (size_t op = 0; op < op_colors_.size(); ++op) {
+      sorted.push_back({op_colors_[op], op});
+    }
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 0; i + 1 < sorted.size(); ++i) {
+      if (sorted[i].first == sorted[i + 1].first) {
+        op_colors_[sorted[i].second] = Combine(sorted[i].first, 1);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Ops by colour, with remaining ties broken by original index.
+  std::vector<size_t> OpOrder() const {
+    std::vector<size_t> order(op_colors_.size());
+    for (size_t op = 0; op < order.size(); ++op) order[op] = op;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return op_colors_[a] < op_colors_[b];
+    });
+    return order;
+  }
+
+  uint64_t tensor_color(size_t tensor) const { return tensor_colors_[tensor]; }
+
+ private:
+  const Problem& problem_;
+  std::vector<uint64_t> op_colors_;
+  std::vector<uint64_t> tensor_colors_;
+  std::vector<int64_t> producer_;
+  std::vector<std::vector<std::pair<size_t, size_t>>> consumers_;
+};
+
+template <typename T>
+std::vector<T> Inverse(const std::vector<T>& order) {
+  std::vector<T> inverse(order.size());
+  for (size_t i = 0; i < order.size(); ++i) inverse[order[i]] = i;
+  return inverse;
+}
+
+Solution Renumber(const Solution& solution, const std::vector<size_t>& ops,
+                  const std::vector<size_t>& tensors) {
+  Solution renumbered = solution;
+  for (Subgraph& subgraph : renumbered.subgraphs) {
+    for (size_t& op : subgraph.ops) op = ops[op];
+    for (size_t& tensor : subgraph.tensors_to_retain) tensor = tensors[tensor];
+  }
+  return renumbered;
+}
+
+}  // namespace
+
+std::string Fingerprint128(absl::string_view bytes) {
+  uint64_t a = 0x243f6a8885a308d3 ^ bytes.size();
+  uint64_t b = 0x13198a2e03707344;
+  for (size_t i = 0; i < bytes.size(); i += 8) {
+    // Assembled byte by byte to be independent of the host's endianness.
+    uint64_t word = 0;
+    for (size_t j = 0; j < 8 && i + j < bytes.size(); ++j) {
+      word |= uint64_t{static_cast<unsigned char>(bytes[i + j])} << (8 * j);
+    }
+    a = Mix(a ^ word);
+    b = Mix(b ^ (word << 32 | word >> 32)) ^ a;
+  }
+  return absl::StrFormat("%016x%016x", Mix(a ^ b), Mix(b ^ ~a));
+}
+
+std::string ProblemFingerprint(const Problem& problem) {
+  // ProblemToJson() is deterministic, so it doubles as canonical bytes.
+  return Fingerprint128(ProblemToJson(problem));
+}
+
+Canonicalization Canonicalize(const Problem& problem) {
+  Refinement refinement(problem);
+  refinement.Refine();
+  for (int i = 0; i < kMaxIndividualizations && refinement.Individualize();
+       ++i) {
+    refinement.Refine();
+  }
+
+  Canonicalization canonical;
+  canonical.ops = refinement.OpOrder();
+  std::vector<char> placed(problem.tensors.size(), 0);
+  const auto place = [&](size_t tensor) {
+    if (placed[tensor]) return;
+    placed[tensor] = 1;
+    canonical.tensors.push_back(tensor);
+  };
+  for (size_t op : canonical.ops) {
+    for (size_t tensor : problem.ops[op].inputs) place(tensor);
+    for (size_t tensor : problem.ops[op].outputs) place(tensor);
+  }
+  std::vector<size_t> unused;
+  for (size_t tensor = 0; tensor < problem.tensors.size(); ++tensor) {
+    if (!placed[tensor]) unused.push_back(tensor);
+  }
+  std::stable_sort(unused.begin(), unused.end(), [&](size_t a, size_t b) {
+    return refinement.tensor_color(a) < refinement.tensor_color(b);
+  });
+  for (size_t tensor : unused) place(tensor);
+
+  const std::vector<size_t> tensor_index = Inverse(canonical.tensors);
+  canonical.problem = problem;
+  for (size_t i = 0; i < canonical.tensors.size(); ++i) {
+    canonical.problem.tensors[i] = problem.tensors[canonical.tensors[i]];
+  }
+  for (size_t i = 0; i < canonical.ops.size(); ++i) {
+    Op& op = canonical.problem.ops[i];
+    op = problem.ops[canonical.ops[i]];
+    for (size_t& tensor : op.inputs) tensor = tensor_index[tensor];
+    for (size_t& tensor : op.outputs) tensor = tensor_index[tensor];
+  }
+  return canonical;
+}
+
+Solution ToCanonical(const Canonicalization& canonical,
+                     const Solution& solution) {
+  return Renumber(solution, Inverse(canonical.ops), Inverse(canonical.tensors));
+}
+
+Solution FromCanonical(const Canonicalization& canonical,
+                       const Solution& solution) {
+  return Renumber(solution, canonical.ops, canonical.tensors);
+}
+
+}  // namespace mlsys
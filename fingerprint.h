@@ -0,0 +1,67 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_FINGERPRINT_H_
+#define MLSYS_FINGERPRINT_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "mlsys.h"
+#include "third_party/absl/strings/string_view.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Content fingerprints of problems, up to renumbering.        /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// A 128-bit hash of `bytes` as 32 hex digits, stable across processes, builds
+// and platforms (unlike absl::Hash), so that it can name files on disk.
+std::string Fingerprint128(absl::string_view bytes);
+
+// Fingerprint of the problem's content: any two JSON files describing the
+// same problem, however formatted, share it.
+std::string ProblemFingerprint(const Problem& problem);
+
+// A renumbering of a problem's ops and tensors into a canonical order.
+struct Canonicalization {
+  Problem problem;                  // The renumbered problem.
+  std::vector<size_t> ops;          // Canonical op index -> original index.
+  std::vector<size_t> tensors;      // Likewise for tensors.
+};
+
+// Renumbers `problem` so that problems differing only by a permutation of op
+// and tensor indices usually map to the same canonical problem.  Ops are
+// ordered by colour refinement (1-dimensional Weisfeiler-Leman) over the
+// bipartite op/tensor graph, individualizing one op at a time while ties
+// remain; tensors follow in order of first use.  Highly symmetric graphs fall
+// back to breaking the remaining ties by original index after a while, and
+// may then canonicalize differently for different numberings.  Equal
+// canonical problems are always isomorphic, so the worst case is a missed
+// match.
+Canonicalization Canonicalize(const Problem& problem);
+
+// Maps a solution between the original and the canonical numbering.
+Solution ToCanonical(const Canonicalization& canonical,
+                     const Solution& solution);
+Solution FromCanonical(const Canonicalization& canonical,
+                       const Solution& solution);
+
+}  // namespace mlsys
+
+#endif  // MLSYS_FINGERPRINT_H_
@@ -0,0 +1,364 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "mlsys.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/strings/string_view.h"
+
+namespace mlsys {
+
+namespace {
+
+// Draws from the raw engine output so that a seed produces the same problem
+// regardless of the standard library's distribution implementations.
+class Random {
+ public:
+  explicit Random(uint64_t seed) : engine_(seed) {}
+
+  double Uniform() { return (engine_() >> 11) * 0x1.0p-53; }
+  size_t Index(size_t n) { return engine_() % n; }
+
+ private:
+  std::mt19937_64 engine_;
+};
+
+class GraphBuilder {
+ public:
+  explicit GraphBuilder(const GeneratorOptions& options)
+      : options_(options), random_(options.seed) {}
+
+  size_t AddTensor(Width width, Height height) {
+    problem_.tensors.push_back({width, height});
+    return problem_.tensors.size() - 1;
+  }
+
+  // Produces a `lhs.height x rhs.width` result.
+  size_t MatMul(size_t lhs, size_t rhs) {
+    const size_t output = AddTensor(problem_.tensors[rhs].width,
+                                    problem_.tensors[lhs].height);
+    AddOp("MatMul", {lhs, rhs}, output, options_.matmul_base_cost);
+    return output;
+  }
+
+  // Produces a result shaped like the first input.
+  size_t Pointwise(const Inputs& inputs) {
+    const Tensor& shape = problem_.tensors[inputs.front()];
+    const size_t output = AddTensor(shape.width, shape.height);
+    AddOp("Pointwise", inputs, output, options_.pointwise_base_cost);
+    return output;
+  }
+
+  // Reduces every row of `input` to a single element.
+  size_t RowReduction(size_t input) {
+    const size_t output = AddTensor(1, problem_.tensors[input].height);
+    AddOp("Reduction", {input}, output, options_.pointwise_base_cost);
+    return output;
+  }
+
+  // Produces `input` with its dimensions swapped.
+  size_t Transpose(size_t input) {
+    const size_t output = AddTensor(problem_.tensors[input].height,
+                                    problem_.tensors[input].width);
+    AddOp("Transpose", {input}, output, options_.pointwise_base_cost);
+    return output;
+  }
+
+  // Folds `values` into one tensor with a left-leaning chain of Pointwise ops.
+  size_t Sum(const std::vector<size_t>& values) {
+    size_t accumulator = values.front();
+    for (size_t i = 1; i < values.size(); ++i) {
+      accumulator = Pointwise({accumulator, values[i]});
+    }
+    return accumulator;
+  }
+
+  const Tensor& tensor(size_t index) const { return problem_.tensors[index]; }
+  Random& random() { return random_; }
+
+  Problem Finish() && {
+    problem_.fast_memory_capacity = options_.fast_memory_capacity;
+    problem_.slow_memory_bandwidth = options_.slow_memory_bandwidth;
+    problem_.native_granularity = options_.native_granularity;
+    problem_.slow_memory_read_bandwidth = options_.slow_memory_read_bandwidth;
+    problem_.slow_memory_write_bandwidth =
+        options_.slow_memory_write_bandwidth;
+    problem_.middle_memory_capacity = options_.middle_memory_capacity;
+    problem_.middle_memory_bandwidth = options_.middle_memory_bandwidth;
+    problem_.dma_setup_latency = options_.dma_setup_latency;
+    return std::move(problem_);
+  }
+
+ private:
+  void AddOp(OpType op_type, Inputs inputs, size_t output, BaseCost base) {
+    const double jitter =
+        options_.base_cost_jitter * (2.0 * random_.Uniform() - 1.0);
+    const BaseCost base_cost =
+        std::max<BaseCost>(1, std::llround(base * (1.0 + jitter)));
+    problem_.ops.push_back(
+        {std::move(op_type), std::move(inputs), {output}, base_cost});
+  }
+
+  const GeneratorOptions& options_;
+  Random random_;
+  Problem problem_;
+};
+
+// Mirrors the blocks of mlsys-2026-17: per head a Q/K/V fan-out, two chained
+// attention MatMuls and an output projection, the heads folded back together
+// by Pointwise adds, then a residual add and a two-layer MLP.  Unlike the
+// benchmark, K is transposed before the score MatMul so that its inner
+// dimensions agree.
+size_t AddTransformerBlock(const GeneratorOptions& options, size_t x,
+                           GraphBuilder& builder) {
+  std::vector<size_t> heads;
+  for (int64_t head = 0; head < options.num_heads; ++head) {
+    const size_t wq = builder.AddTensor(options.head_width, options.hidden);
+    const size_t wk = builder.AddTensor(options.head_width, options.hidden);
+    const size_t wv = builder.AddTensor(options.head_width, options.hidden);
+    const size_t wo = builder.AddTensor(options.hidden, options.head_width);
+    const size_t q = builder.MatMul(x, wq);
+    const size_t k = builder.MatMul(x, wk);
+    const size_t v = builder.MatMul(x, wv);
+    const size_t scores = builder.MatMul(q, builder.Transpose(k));
+    const size_t context = builder.MatMul(scores, v);
+    heads.push_back(builder.MatMul(context, wo));
+  }
+  const size_t attention = builder.Sum(heads);
+  const size_t residual = builder.Pointwise({attention, x});
+  const size_t w1 = builder.AddTensor(options.ffn_width, options.hidden);
+  const size_t w2 = builder.AddTensor(options.hidden, options.ffn_width);
+  const size_t up = builder.MatMul(residual, w1);
+  const size_t activation = builder.Pointwise({up});
+  const size_t down = builder.MatMul(activation, w2);
+  return builder.Pointwise({down, residual});
+}
+
+// Layers alternate between expanding to `ffn_width` and projecting back to
+// `hidden`, each followed by a Pointwise activation.
+size_t AddMlpLayer(const GeneratorOptions& options, int64_t layer, size_t x,
+                   GraphBuilder& builder) {
+  const Width width = layer % 2 == 0 ? options.ffn_width : options.hidden;
+  const size_t weight = builder.AddTensor(width, builder.tensor(x).width);
+  return builder.Pointwise({builder.MatMul(x, weight)});
+}
+
+size_t AddResidualBlock(const GeneratorOptions& options, size_t x,
+                        GraphBuilder& builder) {
+  const size_t w1 = builder.AddTensor(options.ffn_width, options.hidden);
+  const size_t w2 = builder.AddTensor(options.hidden, options.ffn_width);
+  const size_t up = builder.MatMul(x, w1);
+  const size_t activation = builder.Pointwise({up});
+  const size_t down = builder.MatMul(activation, w2);
+  return builder.Pointwise({down, x});
+}
+
+// Per head: Q/K/V projections of the shared input, a Transpose of K, the
+// `rows x rows` score MatMul, a softmax over its rows (a max Reduction, a
+// Pointwise subtract-and-exp, a sum Reduction and a Pointwise divide) and the
+// value MatMul.  The heads are summed and projected back to `hidden`.
+size_t AddAttentionLayer(const GeneratorOptions& options, size_t x,
+                         GraphBuilder& builder) {
+  std::vector<size_t> heads;
+  for (int64_t head = 0; head < options.num_heads; ++head) {
+    const size_t wq = builder.AddTensor(options.head_width, options.hidden);
+    const size_t wk = builder.AddTensor(options.head_width, options.hidden);
+    const size_t wv = builder.AddTensor(options.head_width, options.hidden);
+    const size_t q = builder.MatMul(x, wq);
+    const size_t k = builder.MatMul(x, wk);
+    const size_t v = builder.MatMul(x, wv);
+    const size_t scores = builder.MatMul(q, builder.Transpose(k));
+    const size_t maximum = builder.RowReduction(scores);
+    const size_t exponentials = builder.Pointwise({scores, maximum});
+    const size_t sum = builder.RowReduction(exponentials);
+    const size_t probabilities = builder.Pointwise({exponentials, sum});
+    heads.push_back(builder.MatMul(probabilities, v));
+  }
+  const size_t merged = builder.Sum(heads);
+  const size_t wo = builder.AddTensor(options.hidden, options.head_width);
+  return builder.MatMul(merged, wo);
+}
+
+// Every op draws its first operand from the previous level, which keeps the
+// graph connected; Pointwise ops may also pull a skip input from any earlier
+// level.  MatMuls multiply by a fresh `hidden x hidden` weight.
+std::vector<size_t> AddDagLevel(const GeneratorOptions& options,
+                                const std::vector<size_t>& previous,
+                                const std::vector<size_t>& live,
+                                GraphBuilder& builder) {
+  std::vector<size_t> level;
+  for (int64_t i = 0; i < options.dag_width; ++i) {
+    Random& random = builder.random();
+    const size_t operand = previous[random.Index(previous.size())];
+    if (random.Uniform() < options.dag_matmul_fraction) {
+      const size_t weight = builder.AddTensor(options.hidden, options.hidden);
+      level.push_back(builder.MatMul(operand, weight));
+    } else if (random.Uniform() < 0.5) {
+      level.push_back(builder.Pointwise({operand}));
+    } else {
+      level.push_back(
+          builder.Pointwise({operand, live[random.Index(live.size())]}));
+    }
+  }
+  return level;
+}
+
+int64_t OpsPerUnit(const GeneratorOptions& options) {
+  switch (options.family) {
+    case GraphFamily::kTransformer:
+      return 8 * options.num_heads + 4;
+    case GraphFamily::kMlp:
+      return 2;
+    case GraphFamily::kResidual:
+      return 4;
+    case GraphFamily::kAttention:
+      return 11 * options.num_heads;
+    case GraphFamily::kRandomDag:
+      return options.dag_width;
+  }
+  return 1;
+}
+
+absl::Status ValidateOptions(const GeneratorOptions& options) {
+  if (options.num_layers <= 0 && options.target_num_ops <= 0) {
+    return absl::InvalidArgumentError(
+        "Either num_layers or target_num_ops must be positive");
+  }
+  if (options.rows <= 0 || options.hidden <= 0 || options.head_width <= 0 ||
+      options.ffn_width <= 0) {
+    return absl::InvalidArgumentError("Tensor dimensions must be positive");
+  }
+  if (options.num_heads <= 0 || options.dag_width <= 0) {
+    return absl::InvalidArgumentError(
+        "num_heads and dag_width must be positive");
+  }
+  if (options.dag_matmul_fraction < 0.0 || options.dag_matmul_fraction > 1.0) {
+    return absl::InvalidArgumentError("dag_matmul_fraction must be in [0, 1]");
+  }
+  if (options.matmul_base_cost <= 0 || options.pointwise_base_cost <= 0 ||
+      options.base_cost_jitter < 0.0 || options.base_cost_jitter >= 1.0) {
+    return absl::InvalidArgumentError(
+        "Base costs must be positive and base_cost_jitter in [0, 1)");
+  }
+  if (options.fast_memory_capacity <= 0 ||
+      options.slow_memory_bandwidth <= 0 ||
+      options.native_granularity.width <= 0 ||
+      options.native_granularity.height <= 0 ||
+      options.slow_memory_read_bandwidth.value_or(1) <= 0 ||
+      options.slow_memory_write_bandwidth.value_or(1) <= 0 ||
+      options.middle_memory_capacity.value_or(1) <= 0 ||
+      options.middle_memory_bandwidth.value_or(1) <= 0 ||
+      options.dma_setup_latency.value_or(0.0) < 0.0) {
+    return absl::InvalidArgumentError(
+        "Hardware parameters must be positive");
+  }
+  if (options.middle_memory_capacity.has_value() !=
+      options.middle_memory_bandwidth.has_value()) {
+    return absl::InvalidArgumentError(
+        "A middle memory needs both a capacity and a bandwidth");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::string_view GraphFamilyName(GraphFamily family) {
+  switch (family) {
+    case GraphFamily::kTransformer:
+      return "transformer";
+    case GraphFamily::kMlp:
+      return "mlp";
+    case GraphFamily::kResidual:
+      return "residual";
+    case GraphFamily::kAttention:
+      return "attention";
+    case GraphFamily::kRandomDag:
+      return "random_dag";
+  }
+  return "unknown";
+}
+
+absl::StatusOr<GraphFamily> ParseGraphFamily(absl::string_view name) {
+  for (GraphFamily family :
+       {GraphFamily::kTransformer, GraphFamily::kMlp, GraphFamily::kResidual,
+        GraphFamily::kAttention, GraphFamily::kRandomDag}) {
+    if (GraphFamilyName(family) == name) return family;
+  }
+  return absl::InvalidArgumentError(
+      absl::StrCat("Unknown graph family: ", name));
+}
+
+absl::StatusOr<Problem> GenerateProblem(const GeneratorOptions& options) {
+  if (absl::Status status = ValidateOptions(options); !status.ok()) {
+    return status;
+  }
+  const int64_t ops_per_unit = OpsPerUnit(options);
+  const int64_t num_units =
+      options.target_num_ops > 0
+          ? (options.target_num_ops + ops_per_unit - 1) / ops_per_unit
+          : options.num_layers;
+
+  GraphBuilder builder(options);
+  size_t x = builder.AddTensor(options.hidden, options.rows);
+  switch (options.family) {
+    case GraphFamily::kTransformer:
+      for (int64_t unit = 0; unit < num_units; ++unit) {
+        x = AddTransformerBlock(options, x, builder);
+      }
+      break;
+    case GraphFamily::kMlp:
+      for (int64_t unit = 0; unit < num_units; ++unit) {
+        x = AddMlpLayer(options, unit, x, builder);
+      }
+      break;
+    case GraphFamily::kResidual:
+      for (int64_t unit = 0; unit < num_units; ++unit) {
+        x = AddResidualBlock(options, x, builder);
+      }
+      break;
+    case GraphFamily::kAttention:
+      for (int64_t unit = 0; unit < num_units; ++unit) {
+        x = AddAttentionLayer(options, x, builder);
+      }
+      break;
+    case GraphFamily::kRandomDag: {
+      std::vector<size_t> previous = {x};
+      for (int64_t i = 1; i < options.dag_width; ++i) {
+        previous.push_back(builder.AddTensor(options.hidden, options.rows));
+      }
+      std::vector<size_t> live = previous;
+      for (int64_t unit = 0; unit < num_units; ++unit) {
+        previous = AddDagLevel(options, previous, live, builder);
+        live.insert(live.end(), previous.begin(), previous.end());
+      }
+      break;
+    }
+  }
+  return std::move(builder).Finish();
+}
+
+}  // namespace mlsys
@@ -0,0 +1,86 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_GENERATOR_H_
+#define MLSYS_GENERATOR_H_
+
+#include <cstdint>
+#include <optional>
+
+#include "mlsys.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/string_view.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Seeded synthetic problems for scaling and fuzz studies.     /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+enum class GraphFamily {
+  kTransformer,  // Stacked blocks shaped like mlsys-2026-17.
+  kMlp,          // MatMul + Pointwise towers.
+  kResidual,     // Two-layer blocks with a skip connection around them.
+  kAttention,    // Q/K/V fan-out per head, merged by an output projection.
+  kRandomDag,    // Random layered DAG over a pool of live tensors.
+};
+
+absl::string_view GraphFamilyName(GraphFamily family);
+absl::StatusOr<GraphFamily> ParseGraphFamily(absl::string_view name);
+
+struct GeneratorOptions {
+  GraphFamily family = GraphFamily::kTransformer;
+  uint64_t seed = 1;
+
+  // Number of repeated units (blocks, layers or DAG levels).  When
+  // `target_num_ops` is positive it takes precedence, and the smallest unit
+  // count producing at least that many ops is used instead.
+  int64_t num_layers = 4;
+  int64_t target_num_ops = 0;
+
+  // Activations are `rows` tall and `hidden` wide; per-head projections are
+  // `head_width` wide and MLP expansions are `ffn_width` wide.
+  Height rows = 2048;
+  Width hidden = 128;
+  Width head_width = 128;
+  Width ffn_width = 512;
+  int64_t num_heads = 4;
+
+  // Random DAG shape: ops per level and the share of them that are MatMuls.
+  int64_t dag_width = 8;
+  double dag_matmul_fraction = 0.5;
+
+  // Per-op base costs are drawn uniformly from base * [1 - jitter, 1 + jitter].
+  BaseCost matmul_base_cost = 10000;
+  BaseCost pointwise_base_cost = 200;
+  double base_cost_jitter = 0.0;
+
+  FastMemoryCapacity fast_memory_capacity = 500000;
+  SlowMemoryBandwidth slow_memory_bandwidth = 100;
+  Granularity native_granularity = {128, 128, 1};
+  std::optional<SlowMemoryBandwidth> slow_memory_read_bandwidth;
+  std::optional<SlowMemoryBandwidth> slow_memory_write_bandwidth;
+  std::optional<FastMemoryCapacity> middle_memory_capacity;
+  std::optional<SlowMemoryBandwidth> middle_memory_bandwidth;
+  std::optional<SubgraphLatency> dma_setup_latency;
+};
+
+// Deterministic for a given set of options, including the seed.
+absl::StatusOr<Problem> GenerateProblem(const GeneratorOptions& options);
+
+}  // namespace mlsys
+
+#endif  // MLSYS_GENERATOR_H_
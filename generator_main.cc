@@ -0,0 +1,153 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Emits a synthetic problem in the PROBLEM.md input format:
+//
+//   $ ./mlsys_generate --family=transformer --num_ops=10000 --seed=7 out.json
+//
+// Pass "-" as the output path to write to stdout.
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "generator.h"
+#include "mlsys.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/flags/parse.h"
+#include "third_party/absl/flags/usage.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/strings/numbers.h"
+#include "third_party/absl/strings/str_split.h"
+
+ABSL_FLAG(std::string, family, "transformer",
+          "One of transformer, mlp, residual, attention, random_dag.");
+ABSL_FLAG(uint64_t, seed, 1, "Random seed.");
+ABSL_FLAG(int64_t, num_layers, 4, "Number of repeated blocks or levels.");
+ABSL_FLAG(int64_t, num_ops, 0,
+          "If positive, overrides --num_layers to reach at least this many "
+          "ops.");
+ABSL_FLAG(int64_t, rows, 2048, "Height of activation tensors.");
+ABSL_FLAG(int64_t, hidden, 128, "Width of activation tensors.");
+ABSL_FLAG(int64_t, head_width, 128, "Width of per-head projections.");
+ABSL_FLAG(int64_t, ffn_width, 512, "Width of MLP expansions.");
+ABSL_FLAG(int64_t, num_heads, 4, "Attention heads per block.");
+ABSL_FLAG(int64_t, dag_width, 8, "Ops per level of a random DAG.");
+ABSL_FLAG(double, dag_matmul_fraction, 0.5,
+          "Share of MatMul ops in a random DAG.");
+ABSL_FLAG(int64_t, matmul_base_cost, 10000, "Base cost of MatMul ops.");
+ABSL_FLAG(int64_t, pointwise_base_cost, 200, "Base cost of Pointwise ops.");
+ABSL_FLAG(double, base_cost_jitter, 0.0,
+          "Relative uniform jitter applied to every base cost.");
+ABSL_FLAG(int64_t, fast_memory_capacity, 500000, "Fast memory capacity.");
+ABSL_FLAG(int64_t, slow_memory_bandwidth, 100, "Slow memory bandwidth.");
+ABSL_FLAG(int64_t, slow_memory_read_bandwidth, 0,
+          "Bandwidth of loads into fast memory; 0 uses "
+          "--slow_memory_bandwidth.");
+ABSL_FLAG(int64_t, slow_memory_write_bandwidth, 0,
+          "Bandwidth of stores out of fast memory; 0 uses "
+          "--slow_memory_bandwidth.");
+ABSL_FLAG(int64_t, middle_memory_capacity, 0,
+          "Capacity of a middle memory between fast and slow memory; 0 for "
+          "none.");
+ABSL_FLAG(int64_t, middle_memory_bandwidth, 0,
+          "Bandwidth between middle and fast memory; required with "
+          "--middle_memory_capacity.");
+ABSL_FLAG(double, dma_setup_latency, 0.0,
+          "Fixed cost of every transfer to or from slow memory; 0 for none.");
+ABSL_FLAG(std::string, native_granularity, "128,128",
+          "Native granularity as <width>,<height>.");
+
+int main(int argc, char* argv[]) {
+  absl::SetProgramUsageMessage(
+      "Usage: mlsys_generate [flags] <path_to_output.json>");
+  const std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+  if (args.size() != 2) {
+    std::cerr << "Usage: " << args[0] << " [flags] <path_to_output.json>\n";
+    return 1;
+  }
+
+  const absl::StatusOr<mlsys::GraphFamily> family =
+      mlsys::ParseGraphFamily(absl::GetFlag(FLAGS_family));
+  if (!family.ok()) {
+    std::cerr << family.status() << "\n";
+    return 1;
+  }
+  const std::vector<std::string> native =
+      absl::StrSplit(absl::GetFlag(FLAGS_native_granularity), ',');
+  mlsys::GeneratorOptions options;
+  if (native.size() != 2 ||
+      !absl::SimpleAtoi(native[0], &options.native_granularity.width) ||
+      !absl::SimpleAtoi(native[1], &options.native_granularity.height)) {
+    std::cerr << "--native_granularity must be <width>,<height>\n";
+    return 1;
+  }
+  options.family = *family;
+  options.seed = absl::GetFlag(FLAGS_seed);
+  options.num_layers = absl::GetFlag(FLAGS_num_layers);
+  options.target_num_ops = absl::GetFlag(FLAGS_num_ops);
+  options.rows = absl::GetFlag(FLAGS_rows);
+  options.hidden = absl::GetFlag(FLAGS_hidden);
+  options.head_width = absl::GetFlag(FLAGS_head_width);
+  options.ffn_width = absl::GetFlag(FLAGS_ffn_width);
+  options.num_heads = absl::GetFlag(FLAGS_num_heads);
+  options.dag_width = absl::GetFlag(FLAGS_dag_width);
+  options.dag_matmul_fraction = absl::GetFlag(FLAGS_dag_matmul_fraction);
+  options.matmul_base_cost = absl::GetFlag(FLAGS_matmul_base_cost);
+  options.pointwise_base_cost = absl::GetFlag(FLAGS_pointwise_base_cost);
+  options.base_cost_jitter = absl::GetFlag(FLAGS_base_cost_jitter);
+  options.fast_memory_capacity = absl::GetFlag(FLAGS_fast_memory_capacity);
+  options.slow_memory_bandwidth = absl::GetFlag(FLAGS_slow_memory_bandwidth);
+  if (const int64_t read = absl::GetFlag(FLAGS_slow_memory_read_bandwidth);
+      read != 0) {
+    options.slow_memory_read_bandwidth = read;
+  }
+  if (const int64_t write = absl::GetFlag(FLAGS_slow_memory_write_bandwidth);
+      write != 0) {
+    options.slow_memory_write_bandwidth = write;
+  }
+  if (const int64_t capacity = absl::GetFlag(FLAGS_middle_memory_capacity);
+      capacity != 0) {
+    options.middle_memory_capacity = capacity;
+  }
+  if (const int64_t bandwidth = absl::GetFlag(FLAGS_middle_memory_bandwidth);
+      bandwidth != 0) {
+    options.middle_memory_bandwidth = bandwidth;
+  }
+  if (const double setup = absl::GetFlag(FLAGS_dma_setup_latency);
+      setup != 0.0) {
+    options.dma_setup_latency = setup;
+  }
+
+  const absl::StatusOr<mlsys::Problem> problem =
+      mlsys::GenerateProblem(options);
+  if (!problem.ok()) {
+    std::cerr << problem.status() << "\n";
+    return 1;
+  }
+  const std::string output = args[1];
+  if (output == "-") {
+    std::cout << mlsys::ProblemToJson(*problem);
+    return 0;
+  }
+  if (const absl::Status status = mlsys::WriteProblem(*problem, output);
+      !status.ok()) {
+    std::cerr << status << "\n";
+    return 1;
+  }
+  return 0;
+}
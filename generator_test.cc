@@ -0,0 +1,70 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Checks that every graph family generates well-formed problems.
+
+#include "generator.h"
+
+#include <cstdint>
+#include <string>
+
+#include "mlsys.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/googletest/googletest/include/gtest/gtest.h"
+
+namespace mlsys {
+namespace {
+
+class GeneratorTest : public testing::TestWithParam<GraphFamily> {};
+
+TEST_P(GeneratorTest, MatMulShapesAgree) {
+  for (uint64_t seed = 1; seed <= 4; ++seed) {
+    GeneratorOptions options;
+    options.family = GetParam();
+    options.seed = seed;
+    options.num_layers = 2;
+    // Rows, head width and hidden size all differ, so transposed operands
+    // cannot line up by accident.
+    options.rows = 256;
+    options.hidden = 96;
+    options.head_width = 64;
+    const absl::StatusOr<Problem> problem = GenerateProblem(options);
+    ASSERT_TRUE(problem.ok()) << problem.status();
+    EXPECT_TRUE(ValidateProblem(*problem).ok());
+    for (size_t op = 0; op < problem->ops.size(); ++op) {
+      const Op& spec = problem->ops[op];
+      if (spec.op_type != "MatMul") continue;
+      const Tensor& lhs = problem->tensors[spec.inputs[0]];
+      const Tensor& rhs = problem->tensors[spec.inputs[1]];
+      const Tensor& output = problem->tensors[spec.outputs[0]];
+      EXPECT_EQ(lhs.width, rhs.height) << "MatMul op " << op;
+      EXPECT_EQ(output.height, lhs.height) << "MatMul op " << op;
+      EXPECT_EQ(output.width, rhs.width) << "MatMul op " << op;
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Families, GeneratorTest,
+    testing::Values(GraphFamily::kTransformer, GraphFamily::kMlp,
+                    GraphFamily::kResidual, GraphFamily::kAttention,
+                    GraphFamily::kRandomDag),
+    [](const testing::TestParamInfo<GraphFamily>& info) {
+      return std::string(GraphFamilyName(info.param));
+    });
+
+}  // namespace
+}  // namespace mlsys
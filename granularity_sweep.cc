@@ -0,0 +1,404 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "granularity_sweep.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "mlsys.h"
+#include "third_party/absl/container/flat_hash_map.h"
+#include "third_party/absl/container/flat_hash_set.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/types/span.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace mlsys {
+
+namespace {
+
+// The sweep computes in doubles, exact for the integers involved, with the
+// same code for one candidate at a time and for a register of them.
+double Max(double a, double b) { return std::max(a, b); }
+double Min(double a, double b) { return std::min(a, b); }
+double Ceil(double a) { return std::ceil(a); }
+double Floor(double a) { return std::floor(a); }
+bool Equal(double a, double b) { return a == b; }
+double Select(bool mask, double a, double b) { return mask ? a : b; }
+
+#if defined(__AVX2__) && defined(__FMA__)
+
+// Four candidates, one per lane.
+struct Vec4 {
+  Vec4(__m256d v) : v(v) {}  // NOLINT: implicit from intrinsics.
+  explicit Vec4(double value) : v(_mm256_set1_pd(value)) {}
+  __m256d v;
+};
+
+Vec4 operator+(Vec4 a, Vec4 b) { return _mm256_add_pd(a.v, b.v); }
+Vec4 operator-(Vec4 a, Vec4 b) { return _mm256_sub_pd(a.v, b.v); }
+Vec4 operator*(Vec4 a, Vec4 b) { return _mm256_mul_pd(a.v, b.v); }
+Vec4 operator/(Vec4 a, Vec4 b) { return _mm256_div_pd(a.v, b.v); }
+Vec4& operator+=(Vec4& a, Vec4 b) { return a = a + b; }
+Vec4 Max(Vec4 a, Vec4 b) { return _mm256_max_pd(a.v, b.v); }
+Vec4 Min(Vec4 a, Vec4 b) { return _mm256_min_pd(a.v, b.v); }
+Vec4 Ceil(Vec4 a) { return _mm256_ceil_pd(a.v); }
+Vec4 Floor(Vec4 a) { return _mm256_floor_pd(a.v); }
+Vec4 Equal(Vec4 a, Vec4 b) { return _mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ); }
+Vec4 Select(Vec4 mask, Vec4 a, Vec4 b) {
+  return _mm256_blendv_pd(b.v, a.v, mask.v);
+}
+
+#endif
+
+// A boundary tensor, with the dimensions it broadcasts along.
+struct Term {
+  BoundaryRole role = BoundaryRole::kTile;
+  bool one_row = false;
+  bool one_col = false;
+  double bytes = 1.0;  // Per element moved.
+  double held_bytes = 1.0;
+};
+
+// What the closed form needs of the problem and the boundary.
+struct Model {
+  double width = 1.0;
+  double height = 1.0;
+  double reduction = 0.0;
+  std::vector<Term> terms;
+  std::vector<ComputeTerm> compute;
+  double read_bandwidth = 1.0;
+  double write_bandwidth = 1.0;
+  double middle_bandwidth = 0.0;  // Zero without a middle memory.
+  double setup = 0.0;
+};
+
+// The elements of the slice of `term` for an `h x w` tile and a `k` slice
+// of the reduction.
+template <typename V>
+V Slice(const Term& term, V h, V w, V k) {
+  V rows = h;
+  V cols = w;
+  switch (term.role) {
+    case BoundaryRole::kLhs:
+      cols = k;
+      break;
+    case BoundaryRole::kRhs:
+      rows = k;
+      break;
+    case BoundaryRole::kMirror:
+      rows = w;
+      cols = h;
+      break;
+    case BoundaryRole::kTile:
+    case BoundaryRole::kOutput:
+      break;
+  }
+  return (term.one_row ? V(1.0) : rows) * (term.one_col ? V(1.0) : cols);
+}
+
+// The working set and the latency of the candidates in the lanes of `w`,
+// `h` and `k`.
+template <typename V>
+void Score(const Model& model, V w, V h, V k, V* working_set, V* latency) {
+  const V width(model.width);
+  const V height(model.height);
+  const V reduction(model.reduction);
+  V num_k_steps(1.0);
+  V k_full(0.0);  // Every reduction step but the last.
+  V k_last(0.0);
+  if (model.reduction > 0.0) {
+    num_k_steps = Ceil(reduction / k);
+    k_full = Min(k, reduction);
+    k_last = reduction - (num_k_steps - V(1.0)) * k;
+  }
+
+  V set(0.0);
+  for (const Term& term : model.terms) {
+    set += Slice(term, Min(h, height), Min(w, width), k_full) *
+           V(term.role == BoundaryRole::kOutput ? term.held_bytes
+                                                : term.bytes);
+  }
+  *working_set = set;
+
+  V compute(0.0);
+  for (const ComputeTerm& term : model.compute) {
+    compute += V(term.base_cost) *
+               Ceil(w / V(term.native.width)) *
+               Ceil(h / V(term.native.height));
+  }
+  compute = compute / num_k_steps;
+
+  // A step of an `th x tw` tile with a `ks` slice of the reduction: the
+  // first of its tile loads the inputs that follow the tile alone, and the
+  // last stores the outputs.
+  const auto step = [&](V th, V tw, V ks, bool first, bool last) {
+    V in(0.0);
+    V out(0.0);
+    int transfers = 0;
+    for (const Term& term : model.terms) {
+      if (term.role == BoundaryRole::kOutput) {
+        if (!last) continue;
+        out += Slice(term, th, tw, ks) * V(term.bytes);
+      } else {
+        if (!first && (term.role == BoundaryRole::kTile ||
+                       term.role == BoundaryRole::kMirror)) {
+          continue;
+        }
+        in += Slice(term, th, tw, ks) * V(term.bytes);
+      }
+      ++transfers;
+    }
+    V time = Max(compute, in / V(model.read_bandwidth) +
+                              out / V(model.write_bandwidth) +
+                              V(transfers * model.setup));
+    if (model.middle_bandwidth > 0.0) {
+      time = Max(time, (in + out) / V(model.middle_bandwidth));
+    }
+    return time;
+  };
+
+  // Full tiles, and the partial ones along the bottom and right edges.
+  const V full_rows = Floor(height / h);
+  const V last_rows = height - full_rows * h;
+  const V full_cols = Floor(width / w);
+  const V last_cols = width - full_cols * w;
+  const V row_counts[2] = {full_rows, Min(last_rows, V(1.0))};
+  const V row_extents[2] = {h, last_rows};
+  const V col_counts[2] = {full_cols, Min(last_cols, V(1.0))};
+  const V col_extents[2] = {w, last_cols};
+  const V single = Equal(num_k_steps, V(1.0));
+  V total(0.0);
+  for (int row = 0; row < 2; ++row) {
+    for (int col = 0; col < 2; ++col) {
+      const V th = row_extents[row];
+      const V tw = col_extents[col];
+      const V unsplit = step(th, tw, k_last, true, true);
+      const V split = step(th, tw, k_full, true, false) +
+                      (num_k_steps - V(2.0)) *
+                          step(th, tw, k_full, false, false) +
+                      step(th, tw, k_last, false, true);
+      total += row_counts[row] * col_counts[col] *
+               Select(single, unsplit, split);
+    }
+  }
+  *latency = total;
+}
+
+}  // namespace
+
+absl::StatusOr<SubgraphBoundary> DescribeBoundary(
+    const Problem& problem, absl::Span<const size_t> ops) {
+  absl::flat_hash_set<size_t> produced;
+  absl::flat_hash_set<size_t> consumed;
+  for (size_t op : ops) {
+    if (op >= problem.ops.size()) {
+      return absl::InvalidArgumentError(absl::StrCat("Unknown op ", op));
+    }
+    for (size_t tensor : problem.ops[op].outputs) produced.insert(tensor);
+    for (size_t tensor : problem.ops[op].inputs) consumed.insert(tensor);
+  }
+
+  SubgraphBoundary boundary;
+  absl::flat_hash_map<size_t, size_t> index;  // Tensor to boundary tensor.
+  const auto add = [&](size_t tensor, BoundaryRole role) -> absl::Status {
+    const auto [it, inserted] =
+        index.try_emplace(tensor, boundary.tensors.size());
+    if (!inserted) {
+      if (boundary.tensors[it->second].role == role) return absl::OkStatus();
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Tensor ", tensor, " is sliced two ways by the subgraph"));
+    }
+    const Tensor& shape = problem.tensors[tensor];
+    boundary.tensors.push_back({role, shape.width, shape.height,
+                                shape.element_bytes, shape.element_bytes});
+    return absl::OkStatus();
+  };
+  for (size_t op : ops) {
+    const Op& spec = problem.ops[op];
+    const absl::StatusOr<SliceRule> rule = GetSliceRule(problem, op);
+    if (!rule.ok()) return rule.status();
+    if (const Depth depth = ReductionDepth(problem, spec); depth > 0) {
+      if (boundary.reduction > 0 && boundary.reduction != depth) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Op ", op, " reduces over ", depth, " rather than ",
+            boundary.reduction));
+      }
+      boundary.reduction = depth;
+    }
+    for (size_t i = 0; i < spec.inputs.size(); ++i) {
+      const size_t tensor = spec.inputs[i];
+      if (*rule != SliceRule::kPointwise && produced.contains(tensor)) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Op ", op, " reads tensor ", tensor,
+                         ", which the subgraph produces"));
+      }
+      if (produced.contains(tensor)) continue;
+      BoundaryRole role = BoundaryRole::kTile;
+      switch (*rule) {
+        case SliceRule::kPointwise:
+          break;
+        case SliceRule::kMatMul:
+          role = i == 0 ? BoundaryRole::kLhs : BoundaryRole::kRhs;
+          break;
+        case SliceRule::kRowReduction:
+          role = BoundaryRole::kLhs;
+          break;
+        case SliceRule::kColumnReduction:
+          role = BoundaryRole::kRhs;
+          break;
+        case SliceRule::kTranspose:
+          role = BoundaryRole::kMirror;
+          break;
+      }
+      if (absl::Status status = add(tensor, role); !status.ok()) {
+        return status;
+      }
+    }
+    for (size_t tensor : spec.outputs) {
+      if (consumed.contains(tensor)) continue;
+      if (absl::Status status = add(tensor, BoundaryRole::kOutput);
+          !status.ok()) {
+        return status;
+      }
+      BoundaryTensor& output = boundary.tensors[index.at(tensor)];
+      if (problem.accumulator_bytes.has_value() &&
+          ReductionDepth(problem, spec) > 0) {
+        output.held_bytes = *problem.accumulator_bytes;
+      }
+      boundary.width = std::max(boundary.width, output.width);
+      boundary.height = std::max(boundary.height, output.height);
+    }
+    const Granularity& native = NativeGranularity(problem, spec.op_type);
+    const auto term = std::find_if(
+        boundary.compute.begin(), boundary.compute.end(),
+        [&](const ComputeTerm& term) { return term.native == native; });
+    if (term != boundary.compute.end()) {
+      term->base_cost += spec.base_cost;
+    } else {
+      boundary.compute.push_back({native, spec.base_cost});
+    }
+  }
+  // Every slice follows the tile along the grid dimensions it spans.
+  for (const auto& [tensor, position] : index) {
+    const BoundaryTensor& boundary_tensor = boundary.tensors[position];
+    int64_t rows = boundary.height;
+    int64_t cols = boundary.width;
+    switch (boundary_tensor.role) {
+      case BoundaryRole::kLhs:
+        cols = boundary.reduction;
+        break;
+      case BoundaryRole::kRhs:
+        rows = boundary.reduction;
+        break;
+      case BoundaryRole::kMirror:
+        std::swap(rows, cols);
+        break;
+      case BoundaryRole::kTile:
+      case BoundaryRole::kOutput:
+        break;
+    }
+    if ((boundary_tensor.height != rows && boundary_tensor.height != 1) ||
+        (boundary_tensor.width != cols && boundary_tensor.width != 1)) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Tensor ", tensor, " neither spans nor broadcasts along the ",
+          boundary.width, "x", boundary.height, " output grid"));
+    }
+  }
+  return boundary;
+}
+
+GranularitySweep SweepGranularities(const Problem& problem,
+                                    const SubgraphBoundary& boundary,
+                                    absl::Span<const Granularity> candidates) {
+  Model model;
+  model.width = boundary.width;
+  model.height = boundary.height;
+  model.reduction = boundary.reduction;
+  for (const BoundaryTensor& tensor : boundary.tensors) {
+    model.terms.push_back({tensor.role, tensor.height == 1, tensor.width == 1,
+                           static_cast<double>(tensor.element_bytes),
+                           static_cast<double>(tensor.held_bytes)});
+  }
+  model.compute = boundary.compute;
+  model.read_bandwidth = ReadBandwidth(problem);
+  model.write_bandwidth = WriteBandwidth(problem);
+  if (HasMiddleMemory(problem)) {
+    model.middle_bandwidth = *problem.middle_memory_bandwidth;
+  }
+  model.setup = problem.dma_setup_latency.value_or(0.0);
+
+  // Structure of arrays; invalid candidates are scored as 1 x 1 x 1.
+  const size_t n = candidates.size();
+  std::vector<double> w(n), h(n), k(n), working_set(n), latency(n);
+  for (size_t i = 0; i < n; ++i) {
+    const Granularity& candidate = candidates[i];
+    w[i] = std::max<int64_t>(candidate.width, 1);
+    h[i] = std::max<int64_t>(candidate.height, 1);
+    k[i] = std::max<int64_t>(candidate.depth, 1);
+  }
+  size_t lane = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+  for (; lane + 4 <= n; lane += 4) {
+    Vec4 set(0.0);
+    Vec4 time(0.0);
+    Score(model, Vec4(_mm256_loadu_pd(&w[lane])),
+          Vec4(_mm256_loadu_pd(&h[lane])), Vec4(_mm256_loadu_pd(&k[lane])),
+          &set, &time);
+    _mm256_storeu_pd(&working_set[lane], set.v);
+    _mm256_storeu_pd(&latency[lane], time.v);
+  }
+#endif
+  for (; lane < n; ++lane) {
+    Score(model, w[lane], h[lane], k[lane], &working_set[lane],
+          &latency[lane]);
+  }
+
+  GranularitySweep sweep;
+  sweep.working_set.resize(n);
+  sweep.feasible.resize(n);
+  sweep.latency = std::move(latency);
+  for (size_t i = 0; i < n; ++i) {
+    const Granularity& candidate = candidates[i];
+    sweep.working_set[i] = static_cast<int64_t>(working_set[i]);
+    sweep.feasible[i] = candidate.width > 0 && candidate.height > 0 &&
+                        candidate.depth > 0 &&
+                        sweep.working_set[i] <= problem.fast_memory_capacity;
+  }
+  return sweep;
+}
+
+int64_t Fastest(const GranularitySweep& sweep) {
+  int64_t best = -1;
+  for (size_t i = 0; i < sweep.latency.size(); ++i) {
+    if (sweep.feasible[i] &&
+        (best < 0 || sweep.latency[i] < sweep.latency[best])) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+}  // namespace mlsys
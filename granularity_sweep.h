@@ -0,0 +1,103 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_GRANULARITY_SWEEP_H_
+#define MLSYS_GRANULARITY_SWEEP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mlsys.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/types/span.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Scoring many granularities of one subgraph at once.         /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// How the slice of a boundary tensor a step moves follows the step's tile
+// of the output grid, `h x w`, and its slice `k` of the reduction.
+enum class BoundaryRole {
+  kLhs,     // `h x k`: the LHS of a MatMul, or a row Reduction's input.
+  kRhs,     // `k x w`: the RHS of a MatMul, or a column Reduction's input.
+  kTile,    // `h x w`: an input of a Pointwise op.
+  kMirror,  // `w x h`: the input of a Transpose.
+  kOutput,  // `h x w`, stored after the last reduction step of the tile.
+};
+
+struct BoundaryTensor {
+  BoundaryRole role = BoundaryRole::kTile;
+  Width width = 1;
+  Height height = 1;
+  ElementBytes element_bytes = 1;
+  // Of an output, while the subgraph computes it; see
+  // Problem::accumulator_bytes.
+  ElementBytes held_bytes = 1;
+};
+
+// The ops of one native granularity, and the sum of their base costs.
+struct ComputeTerm {
+  Granularity native;
+  int64_t base_cost = 0;
+};
+
+// What the latency of a subgraph depends on besides its granularity.
+struct SubgraphBoundary {
+  Width width = 1;  // Of the output grid.
+  Height height = 1;
+  Depth reduction = 0;  // Zero without MatMuls or Reductions.
+  std::vector<BoundaryTensor> tensors;
+  std::vector<ComputeTerm> compute;
+};
+
+// Describes the subgraph of `ops`.  Fails with INVALID_ARGUMENT if a MatMul,
+// Reduction or Transpose reads a tensor the subgraph itself produces, if
+// its MatMuls and Reductions differ in depth, if a tensor has two roles, or
+// if one neither spans the output grid nor broadcasts along a dimension:
+// their slices then depend on the granularity in ways the sweep does not
+// model.
+absl::StatusOr<SubgraphBoundary> DescribeBoundary(const Problem& problem,
+                                                  absl::Span<const size_t> ops);
+
+// Parallel to the candidates.
+struct GranularitySweep {
+  std::vector<int64_t> working_set;  // In bytes, at the largest step.
+  std::vector<char> feasible;        // Within the fast memory capacity.
+  std::vector<SubgraphLatency> latency;
+};
+
+// Scores every candidate granularity of a subgraph run alone, in raster
+// order, with nothing resident and nothing retained.  The working set and
+// latency are those Replayer::SubgraphCost() gives the subgraph then,
+// including the DMA setup latency and the middle memory link, but come from
+// a closed form over the edge cases of the tile grid and the reduction
+// rather than a walk of its steps.  The candidates are scored four at a time
+// with AVX2 where the build enables it.  A candidate with a non-positive
+// dimension is infeasible.
+GranularitySweep SweepGranularities(const Problem& problem,
+                                    const SubgraphBoundary& boundary,
+                                    absl::Span<const Granularity> candidates);
+
+// The index of the feasible candidate of least latency, the first among
+// ties, or -1 if none is feasible.
+int64_t Fastest(const GranularitySweep& sweep);
+
+}  // namespace mlsys
+
+#endif  // MLSYS_GRANULARITY_SWEEP_H_
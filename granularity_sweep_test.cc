@@ -0,0 +1,131 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Checks the closed form of SweepGranularities() against replays of the
+// released benchmarks, run from the root of the repository.
+
+#include "granularity_sweep.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mlsys.h"
+#include "roofline.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/googletest/googletest/include/gtest/gtest.h"
+
+namespace mlsys {
+namespace {
+
+// Replays beyond this many steps take too long for a unit test.
+constexpr int64_t kMaxSteps = 1 << 12;
+
+int64_t CeilDiv(int64_t a, int64_t b) { return (a + b - 1) / b; }
+
+// Odd sizes exercise the ragged edges of the tile grid and the reduction.
+std::vector<Granularity> Candidates() {
+  std::vector<Granularity> candidates;
+  for (int64_t width : {1, 3, 32, 128, 200, 512, 4096}) {
+    for (int64_t height : {1, 7, 32, 128, 512, 2048}) {
+      for (int64_t depth : {1, 5, 64, 300, 1024, 8192}) {
+        candidates.push_back({width, height, depth});
+      }
+    }
+  }
+  return candidates;
+}
+
+// Each op alone, and each op with each consumer of its outputs.
+std::vector<std::vector<size_t>> Subgraphs(const Problem& problem) {
+  std::vector<std::vector<size_t>> subgraphs;
+  for (size_t op = 0; op < problem.ops.size(); ++op) {
+    subgraphs.push_back({op});
+    for (size_t consumer = op + 1; consumer < problem.ops.size();
+         ++consumer) {
+      const Inputs& inputs = problem.ops[consumer].inputs;
+      if (std::any_of(inputs.begin(), inputs.end(), [&](size_t tensor) {
+            const Outputs& outputs = problem.ops[op].outputs;
+            return std::find(outputs.begin(), outputs.end(), tensor) !=
+                   outputs.end();
+          })) {
+        subgraphs.push_back({op, consumer});
+      }
+    }
+  }
+  return subgraphs;
+}
+
+class GranularitySweepTest : public testing::TestWithParam<std::string> {};
+
+TEST_P(GranularitySweepTest, MatchesReplay) {
+  const absl::StatusOr<Problem> problem =
+      ReadProblem(absl::StrCat("benchmarks/mlsys-2026-", GetParam(), ".json"));
+  ASSERT_TRUE(problem.ok()) << problem.status();
+  Replayer replayer(*problem);
+  const std::vector<Granularity> candidates = Candidates();
+  int described = 0;
+  for (const std::vector<size_t>& ops : Subgraphs(*problem)) {
+    const absl::StatusOr<SubgraphBoundary> boundary =
+        DescribeBoundary(*problem, ops);
+    if (!boundary.ok()) {
+      EXPECT_EQ(boundary.status().code(), absl::StatusCode::kInvalidArgument);
+      continue;
+    }
+    ++described;
+    const GranularitySweep sweep =
+        SweepGranularities(*problem, *boundary, candidates);
+    ASSERT_EQ(sweep.latency.size(), candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      const Granularity& granularity = candidates[i];
+      const int64_t steps =
+          CeilDiv(boundary->width, granularity.width) *
+          CeilDiv(boundary->height, granularity.height) *
+          (boundary->reduction > 0
+               ? CeilDiv(boundary->reduction, granularity.depth)
+               : 1);
+      if (steps > kMaxSteps) continue;
+      SCOPED_TRACE(absl::StrCat("ops ", ops.front(), "..", ops.back(), " at ",
+                                granularity.width, "x", granularity.height,
+                                "x", granularity.depth));
+      const Subgraph subgraph{ops, {}, granularity, std::nullopt, 0.0};
+      int64_t working_set = 0;
+      const absl::Status status = replayer.ReplaySubgraph(
+          0, subgraph, {}, [&](const Step& step) {
+            working_set = std::max(working_set, step.working_set);
+          });
+      ASSERT_EQ(static_cast<bool>(sweep.feasible[i]), status.ok()) << status;
+      if (!status.ok()) continue;
+      EXPECT_EQ(sweep.working_set[i], working_set);
+      const absl::StatusOr<SubgraphLatency> latency =
+          replayer.SubgraphCost(subgraph, {});
+      ASSERT_TRUE(latency.ok()) << latency.status();
+      EXPECT_NEAR(sweep.latency[i], *latency, 1e-9 * *latency);
+    }
+  }
+  EXPECT_GT(described, 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(Released, GranularitySweepTest,
+                         testing::Values("1", "5", "9", "13", "17"));
+
+}  // namespace
+}  // namespace mlsys
@@ -0,0 +1,245 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_JSON_UTIL_H_
+#define MLSYS_JSON_UTIL_H_
+
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/strings/str_join.h"
+#include "third_party/absl/strings/string_view.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Reading and writing the JSON files of this repository.      /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// A forward-only cursor over JSON text.  Problems, solutions and the other
+// files of this repository have a fixed shape, so their parsers walk the text
+// directly instead of building a document tree; unknown object keys are
+// skipped.
+class JsonReader {
+ public:
+  explicit JsonReader(absl::string_view text) : text_(text) {}
+
+  bool Consume(char c) {
+    SkipWhitespace();
+    if (pos_ < text_.size() && text_[pos_] == c) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  absl::Status Expect(char c) {
+    if (Consume(c)) return absl::OkStatus();
+    return Error(absl::StrCat("expected '", absl::string_view(&c, 1), "'"));
+  }
+
+  bool ConsumeNull() {
+    SkipWhitespace();
+    if (text_.substr(pos_, 4) != "null") return false;
+    pos_ += 4;
+    return true;
+  }
+
+  absl::StatusOr<std::string> ReadString() {
+    if (!Consume('"')) return Error("expected a string");
+    std::string value;
+    while (pos_ < text_.size() && text_[pos_] != '"') {
+      char c = text_[pos_++];
+      if (c == '\\') {
+        if (pos_ >= text_.size()) break;
+        c = text_[pos_++];
+        switch (c) {
+          case 'n': c = '\n'; break;
+          case 't': c = '\t'; break;
+          case 'r': c = '\r'; break;
+          case 'b': c = '\b'; break;
+          case 'f': c = '\f'; break;
+          case 'u': return Error("unicode escapes are not supported");
+          default: break;
+        }
+      }
+      value.push_back(c);
+    }
+    if (pos_ >= text_.size()) return Error("unterminated string");
+    ++pos_;
+    return value;
+  }
+
+  template <typename T>
+  absl::StatusOr<T> ReadNumber() {
+    SkipWhitespace();
+    T value;
+    const char* begin = text_.data() + pos_;
+    const auto [end, error] =
+        std::from_chars(begin, text_.data() + text_.size(), value);
+    if (error != std::errc()) return Error("expected a number");
+    pos_ += end - begin;
+    return value;
+  }
+
+  // Calls `read_element` once per element of a JSON array.
+  template <typename F>
+  absl::Status ReadArray(F read_element) {
+    if (absl::Status status = Expect('['); !status.ok()) return status;
+    if (Consume(']')) return absl::OkStatus();
+    do {
+      if (absl::Status status = read_element(); !status.ok()) return status;
+    } while (Consume(','));
+    return Expect(']');
+  }
+
+  template <typename T>
+  absl::Status ReadNumbers(std::vector<T>* values) {
+    values->clear();
+    return ReadArray([&]() -> absl::Status {
+      absl::StatusOr<T> value = ReadNumber<T>();
+      if (!value.ok()) return value.status();
+      values->push_back(*value);
+      return absl::OkStatus();
+    });
+  }
+
+  // Calls `read_member` with each key of a JSON object, positioned at its
+  // value.
+  template <typename F>
+  absl::Status ReadObject(F read_member) {
+    if (absl::Status status = Expect('{'); !status.ok()) return status;
+    if (Consume('}')) return absl::OkStatus();
+    do {
+      absl::StatusOr<std::string> key = ReadString();
+      if (!key.ok()) return key.status();
+      if (absl::Status status = Expect(':'); !status.ok()) return status;
+      if (absl::Status status = read_member(*key); !status.ok()) {
+        return status;
+      }
+    } while (Consume(','));
+    return Expect('}');
+  }
+
+  absl::Status SkipValue() {
+    SkipWhitespace();
+    if (pos_ >= text_.size()) return Error("unexpected end of input");
+    switch (text_[pos_]) {
+      case '{':
+        return ReadObject([&](const std::string&) { return SkipValue(); });
+      case '[':
+        return ReadArray([&] { return SkipValue(); });
+      case '"':
+        return ReadString().status();
+      default:
+        while (pos_ < text_.size() && text_[pos_] != ',' &&
+               text_[pos_] != ']' && text_[pos_] != '}' &&
+               !std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+          ++pos_;
+        }
+        return absl::OkStatus();
+    }
+  }
+
+  // The text of the next value, which is skipped, for a nested document to
+  // be parsed on its own.
+  absl::StatusOr<absl::string_view> ReadRaw() {
+    SkipWhitespace();
+    const size_t begin = pos_;
+    if (absl::Status status = SkipValue(); !status.ok()) return status;
+    return text_.substr(begin, pos_ - begin);
+  }
+
+  absl::Status ExpectEnd() {
+    SkipWhitespace();
+    if (pos_ == text_.size()) return absl::OkStatus();
+    return Error("trailing characters");
+  }
+
+  absl::Status Error(absl::string_view message) const {
+    return absl::InvalidArgumentError(
+        absl::StrCat("JSON offset ", pos_, ": ", message));
+  }
+
+ private:
+  void SkipWhitespace() {
+    while (pos_ < text_.size() &&
+           std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+      ++pos_;
+    }
+  }
+
+  absl::string_view text_;
+  size_t pos_ = 0;
+};
+
+template <typename T>
+absl::Status ReadNestedNumbers(JsonReader& reader,
+                               std::vector<std::vector<T>>* values) {
+  values->clear();
+  return reader.ReadArray([&] {
+    values->emplace_back();
+    return reader.ReadNumbers(&values->back());
+  });
+}
+
+// Shortest representation that parses back to the same double.
+inline std::string JsonDouble(double value) {
+  char buffer[32];
+  const auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer),
+                                          value);
+  return std::string(buffer, end);
+}
+
+template <typename T>
+std::string JsonList(const std::vector<T>& values) {
+  return absl::StrCat("[", absl::StrJoin(values, ", "), "]");
+}
+
+inline std::string JsonStringList(
+    const std::vector<std::string>& values) {
+  return absl::StrCat(
+      "[",
+      absl::StrJoin(values, ", ",
+                    [](std::string* out, const std::string& value) {
+                      absl::StrAppend(out, "\"", value, "\"");
+                    }),
+      "]");
+}
+
+// Emits one nested list per line, matching the layout of the benchmarks.
+template <typename T>
+std::string JsonNestedList(const std::vector<std::vector<T>>& values) {
+  if (values.empty()) return "[]";
+  std::string out = "[\n";
+  for (size_t i = 0; i < values.size(); ++i) {
+    absl::StrAppend(&out, "    ", JsonList(values[i]),
+                    i + 1 < values.size() ? ",\n" : "\n");
+  }
+  absl::StrAppend(&out, "  ]");
+  return out;
+}
+
+}  // namespace mlsys
+
+#endif  // MLSYS_JSON_UTIL_H_
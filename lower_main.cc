@@ -0,0 +1,150 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Lowers a solution to its tile-level command stream and reports what the
+// stream moves:
+//
+//   $ ./mlsys_lower problem.json solution.json [commands.bin]
+//
+// With an output file, writes the binary encoding of binary_format.h; with
+// --print, lists the commands.
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "binary_format.h"
+#include "command_stream.h"
+#include "file_util.h"
+#include "mlsys.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/flags/parse.h"
+#include "third_party/absl/flags/usage.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/time/clock.h"
+#include "third_party/absl/time/time.h"
+
+ABSL_FLAG(int64_t, alignment, 1,
+          "Every fast memory buffer starts at a multiple of this.");
+ABSL_FLAG(bool, print, false, "List the commands.");
+
+namespace {
+
+const char* KindName(mlsys::CommandKind kind) {
+  switch (kind) {
+    case mlsys::CommandKind::kLoad:
+      return "load";
+    case mlsys::CommandKind::kStage:
+      return "stage";
+    case mlsys::CommandKind::kCompute:
+      return "compute";
+    case mlsys::CommandKind::kAccumulate:
+      return "accumulate";
+    case mlsys::CommandKind::kFinalize:
+      return "finalize";
+    case mlsys::CommandKind::kStore:
+      return "store";
+    case mlsys::CommandKind::kBarrier:
+      return "barrier";
+  }
+  return "?";
+}
+
+void Print(const mlsys::Command& command) {
+  std::cout << KindName(command.kind);
+  if (command.kind == mlsys::CommandKind::kBarrier) {
+    std::cout << " subgraph " << command.subgraph << "\n";
+    return;
+  }
+  const mlsys::Region& region = command.region;
+  if (command.kind == mlsys::CommandKind::kCompute ||
+      command.kind == mlsys::CommandKind::kAccumulate ||
+      command.kind == mlsys::CommandKind::kFinalize) {
+    std::cout << " tile [" << region.row << ", " << region.col << "] "
+              << region.height << "x" << region.width << " k "
+              << command.k_step << "\n";
+    return;
+  }
+  std::cout << " tensor " << command.tensor << " [" << region.row << ", "
+            << region.col << "] " << region.height << "x" << region.width
+            << ", " << command.bytes << " bytes";
+  if (command.kind != mlsys::CommandKind::kStage) {
+    std::cout << (command.middle ? " middle" : "") << " @" << command.address;
+  }
+  std::cout << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  absl::SetProgramUsageMessage(
+      "Usage: mlsys_lower [flags] <problem.json> <solution.json> "
+      "[commands.bin]");
+  const std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+  if (args.size() != 3 && args.size() != 4) {
+    std::cerr << "Usage: " << args[0]
+              << " [flags] <problem.json> <solution.json> [commands.bin]\n";
+    return 1;
+  }
+  const absl::StatusOr<mlsys::Problem> problem = mlsys::ReadProblem(args[1]);
+  if (!problem.ok()) {
+    std::cerr << problem.status() << "\n";
+    return 1;
+  }
+  const absl::StatusOr<mlsys::Solution> solution = mlsys::ReadSolution(args[2]);
+  if (!solution.ok()) {
+    std::cerr << solution.status() << "\n";
+    return 1;
+  }
+  mlsys::MemoryPlanOptions plan_options;
+  plan_options.alignment = absl::GetFlag(FLAGS_alignment);
+  const absl::Time start = absl::Now();
+  const absl::StatusOr<std::vector<mlsys::Command>> commands =
+      mlsys::LowerSolution(*problem, *solution, {}, plan_options);
+  const absl::Duration elapsed = absl::Now() - start;
+  if (!commands.ok()) {
+    std::cerr << commands.status() << "\n";
+    return 1;
+  }
+  if (absl::GetFlag(FLAGS_print)) {
+    for (const mlsys::Command& command : *commands) Print(command);
+  }
+  const mlsys::CommandStats stats = mlsys::Summarize(*problem, *commands);
+  const std::string binary = mlsys::CommandsToBinary(*commands);
+  std::cout << stats.commands << " commands over " << stats.subgraphs
+            << " subgraphs in " << absl::ToDoubleMilliseconds(elapsed)
+            << " ms, " << binary.size() << " bytes encoded\n"
+            << "  " << stats.loads << " loads, " << stats.stages
+            << " stages, " << stats.computes << " computes, "
+            << stats.finalizes << " finalizes, " << stats.stores
+            << " stores\n"
+            << "  " << stats.slow_transfers << " slow memory transfers: "
+            << stats.slow_bytes_read << " bytes read, "
+            << stats.slow_bytes_written << " bytes written\n";
+  if (mlsys::HasMiddleMemory(*problem)) {
+    std::cout << "  " << stats.middle_link_bytes
+              << " bytes over the middle memory link\n";
+  }
+  if (args.size() == 4) {
+    if (absl::Status status = mlsys::WriteFile(args[3], binary);
+        !status.ok()) {
+      std::cerr << status << "\n";
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,96 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Places the fast memory buffers of a solution at concrete offsets and
+// reports how much placement costs over the bytes live at once:
+//
+//   $ ./mlsys_memory_plan problem.json solution.json [plan.json]
+//
+// With --strict, fails if any engine's buffers do not fit once placed.
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "file_util.h"
+#include "memory_planner.h"
+#include "mlsys.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/flags/parse.h"
+#include "third_party/absl/flags/usage.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+
+ABSL_FLAG(int64_t, alignment, 1, "Every offset is a multiple of this.");
+ABSL_FLAG(bool, strict, false,
+          "Fail if the placed buffers exceed the fast memory capacity.");
+ABSL_FLAG(int, num_engines, 1,
+          "Engines the solution runs on, each with an equal partition of "
+          "fast memory.");
+ABSL_FLAG(bool, repeated, false,
+          "The solution runs back to back, its last subgraphs retaining "
+          "weights for the first ones.");
+
+int main(int argc, char* argv[]) {
+  absl::SetProgramUsageMessage(
+      "Usage: mlsys_memory_plan [flags] <problem.json> <solution.json> "
+      "[plan.json]");
+  const std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+  if (args.size() != 3 && args.size() != 4) {
+    std::cerr << "Usage: " << args[0]
+              << " [flags] <problem.json> <solution.json> [plan.json]\n";
+    return 1;
+  }
+  const absl::StatusOr<mlsys::Problem> problem = mlsys::ReadProblem(args[1]);
+  if (!problem.ok()) {
+    std::cerr << problem.status() << "\n";
+    return 1;
+  }
+  const absl::StatusOr<mlsys::Solution> solution = mlsys::ReadSolution(args[2]);
+  if (!solution.ok()) {
+    std::cerr << solution.status() << "\n";
+    return 1;
+  }
+  mlsys::EvaluateOptions options;
+  options.num_engines = absl::GetFlag(FLAGS_num_engines);
+  options.repeated = absl::GetFlag(FLAGS_repeated);
+  mlsys::MemoryPlanOptions plan_options;
+  plan_options.alignment = absl::GetFlag(FLAGS_alignment);
+  plan_options.strict = absl::GetFlag(FLAGS_strict);
+  const absl::StatusOr<mlsys::MemoryPlan> plan =
+      mlsys::PlanFastMemory(*problem, *solution, options, plan_options);
+  if (!plan.ok()) {
+    std::cerr << plan.status() << "\n";
+    return 1;
+  }
+  for (size_t engine = 0; engine < plan->arenas.size(); ++engine) {
+    const mlsys::Arena& arena = plan->arenas[engine];
+    std::cout << "engine " << engine << ": peak " << arena.peak
+              << " bytes, placed in " << arena.extent << " (fragmentation "
+              << arena.fragmentation() << "), capacity " << arena.capacity
+              << (arena.extent > arena.capacity ? ", DOES NOT FIT" : "")
+              << "\n";
+  }
+  if (args.size() == 4) {
+    if (const absl::Status status =
+            mlsys::WriteFile(args[3], mlsys::MemoryPlanToJson(*plan));
+        !status.ok()) {
+      std::cerr << status << "\n";
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,272 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "memory_planner.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mlsys.h"
+#include "roofline.h"
+#include "third_party/absl/container/flat_hash_map.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/strings/str_join.h"
+
+namespace mlsys {
+
+namespace {
+
+int64_t AlignUp(int64_t value, int64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// Places `buffers`, all of one engine, with `position` mapping subgraphs to
+// their order on the engine.  Returns the extent.
+int64_t Place(std::vector<Buffer*>& buffers,
+              const std::vector<size_t>& position, int64_t alignment) {
+  std::stable_sort(buffers.begin(), buffers.end(),
+                   [](const Buffer* a, const Buffer* b) {
+                     if (a->size != b->size) return a->size > b->size;
+                     return a->last - a->first > b->last - b->first;
+                   });
+  const auto by_offset = [](const Buffer* a, const Buffer* b) {
+    return a->offset < b->offset;
+  };
+  // The placed buffers live at each position, by offset, so that only those
+  // overlapping a buffer's subgraphs are scanned for it.
+  size_t num_positions = 0;
+  for (const Buffer* buffer : buffers) {
+    num_positions = std::max(num_positions, position[buffer->last] + 1);
+  }
+  std::vector<std::vector<const Buffer*>> placed(num_positions);
+  std::vector<const Buffer*> conflicts;
+  int64_t extent = 0;
+  for (Buffer* buffer : buffers) {
+    conflicts.clear();
+    for (size_t at = position[buffer->first]; at <= position[buffer->last];
+         ++at) {
+      conflicts.insert(conflicts.end(), placed[at].begin(), placed[at].end());
+    }
+    if (position[buffer->first] != position[buffer->last]) {
+      std::sort(conflicts.begin(), conflicts.end(), by_offset);
+      conflicts.erase(std::unique(conflicts.begin(), conflicts.end()),
+                      conflicts.end());
+    }
+    int64_t best = -1;
+    int64_t best_gap = std::numeric_limits<int64_t>::max();
+    int64_t cursor = 0;
+    for (const Buffer* other : conflicts) {
+      const int64_t gap = other->offset - cursor;
+      if (gap >= buffer->size && gap < best_gap) {
+        best = cursor;
+        best_gap = gap;
+      }
+      cursor = std::max(cursor,
+                        AlignUp(other->offset + other->size, alignment));
+    }
+    buffer->offset = best >= 0 ? best : cursor;
+    extent = std::max(extent, buffer->offset + buffer->size);
+    for (size_t at = position[buffer->first]; at <= position[buffer->last];
+         ++at) {
+      placed[at].insert(std::upper_bound(placed[at].begin(), placed[at].end(),
+                                         buffer, by_offset),
+                        buffer);
+    }
+  }
+  return extent;
+}
+
+}  // namespace
+
+absl::StatusOr<MemoryPlan> PlanFastMemory(
+    const Problem& problem, const Solution& solution,
+    const EvaluateOptions& options, const MemoryPlanOptions& plan_options) {
+  if (plan_options.alignment <= 0) {
+    return absl::InvalidArgumentError("The alignment must be positive");
+  }
+  const int num_engines = std::max(options.num_engines, 1);
+  const size_t num_subgraphs = solution.subgraphs.size();
+
+  // Whole tensors: those resident in or retained in fast memory by each
+  // subgraph, merged over consecutive subgraphs of an engine.
+  MemoryPlan plan;
+  std::vector<size_t> position(num_subgraphs);
+  std::vector<size_t> engine_size(num_engines, 0);
+  std::vector<std::vector<size_t>> resident(num_engines);
+  std::vector<absl::flat_hash_map<size_t, size_t>> open(num_engines);
+  std::vector<std::vector<size_t>> retained(num_subgraphs);  // Sorted.
+  for (size_t index = 0; index < num_subgraphs; ++index) {
+    const Subgraph& subgraph = solution.subgraphs[index];
+    const int64_t engine = subgraph.engine.value_or(0);
+    if (engine < 0 || engine >= num_engines) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Subgraph ", index, " runs on engine ", engine,
+                       " of ", num_engines));
+    }
+    position[index] = engine_size[engine]++;
+    std::vector<size_t> whole = resident[engine];
+    resident[engine].clear();
+    for (size_t i = 0; i < subgraph.tensors_to_retain.size(); ++i) {
+      const size_t tensor = subgraph.tensors_to_retain[i];
+      if (RetentionLevel(subgraph, i) != MemoryLevel::kFast ||
+          tensor >= problem.tensors.size()) {
+        continue;
+      }
+      retained[index].push_back(tensor);
+      resident[engine].push_back(tensor);
+      whole.push_back(tensor);
+    }
+    std::sort(retained[index].begin(), retained[index].end());
+    std::sort(whole.begin(), whole.end());
+    whole.erase(std::unique(whole.begin(), whole.end()), whole.end());
+    absl::flat_hash_map<size_t, size_t> still_open;
+    for (size_t tensor : whole) {
+      const auto it = open[engine].find(tensor);
+      if (it != open[engine].end()) {
+        plan.buffers[it->second].last = index;
+        still_open[tensor] = it->second;
+        continue;
+      }
+      const Tensor& shape = problem.tensors[tensor];
+      still_open[tensor] = plan.buffers.size();
+      plan.buffers.push_back(
+          {tensor, engine, index, index, true,
+            shape.width * shape.height * shape.element_bytes});
+    }
+    open[engine] = std::move(still_open);
+  }
+  if (options.repeated) {
+    // Tensors the last subgraph of an engine retains into the next iteration
+    // keep their place throughout.
+    std::vector<int64_t> first(num_engines, -1);
+    std::vector<int64_t> last(num_engines, -1);
+    for (size_t index = num_subgraphs; index-- > 0;) {
+      const int64_t engine = solution.subgraphs[index].engine.value_or(0);
+      first[engine] = index;
+      if (last[engine] < 0) last[engine] = index;
+    }
+    for (int engine = 0; engine < num_engines; ++engine) {
+      for (const auto& [tensor, buffer] : open[engine]) {
+        const std::vector<size_t>& wrapped = retained[last[engine]];
+        if (std::binary_search(wrapped.begin(), wrapped.end(), tensor)) {
+          plan.buffers[buffer].first = first[engine];
+        }
+      }
+    }
+  }
+
+  // Tile buffers, sized by the largest slice of each tensor a subgraph moves.
+  // The replay also validates the solution.
+  Replayer replayer(problem, options);
+  std::vector<absl::flat_hash_map<size_t, int64_t>> tiles(num_subgraphs);
+  const auto held_bytes = [&](size_t tensor) {
+    const int64_t producer = replayer.Producer(tensor);
+    if (producer >= 0 && problem.accumulator_bytes.has_value() &&
+        ReductionDepth(problem, problem.ops[producer]) > 0) {
+      return *problem.accumulator_bytes;
+    }
+    return problem.tensors[tensor].element_bytes;
+  };
+  if (absl::Status status = replayer.Replay(
+          solution,
+          [&](const Step& step) {
+            absl::flat_hash_map<size_t, int64_t>& sizes = tiles[step.subgraph];
+            for (const Transfer& load : step.loads) {
+              if (std::binary_search(retained[step.subgraph].begin(),
+                                     retained[step.subgraph].end(),
+                                     load.tensor)) {
+                continue;  // Loaded whole.
+              }
+              int64_t& size = sizes[load.tensor];
+              size = std::max(size, TransferBytes(problem, load));
+            }
+            for (const Transfer& store : step.stores) {
+              int64_t& size = sizes[store.tensor];
+              size = std::max(size, store.region.size() *
+                                        held_bytes(store.tensor));
+            }
+          });
+      !status.ok()) {
+    return status;
+  }
+  for (size_t index = 0; index < num_subgraphs; ++index) {
+    std::vector<std::pair<size_t, int64_t>> sizes(tiles[index].begin(),
+                                                  tiles[index].end());
+    std::sort(sizes.begin(), sizes.end());
+    for (const auto& [tensor, size] : sizes) {
+      plan.buffers.push_back(
+          {tensor, solution.subgraphs[index].engine.value_or(0), index,
+            index, false, size});
+    }
+  }
+
+  plan.arenas.resize(num_engines);
+  std::vector<std::vector<Buffer*>> buffers(num_engines);
+  std::vector<std::vector<int64_t>> live(num_engines);
+  for (int engine = 0; engine < num_engines; ++engine) {
+    live[engine].assign(engine_size[engine], 0);
+  }
+  for (Buffer& buffer : plan.buffers) {
+    buffers[buffer.engine].push_back(&buffer);
+    for (size_t index = position[buffer.first];
+         index <= position[buffer.last]; ++index) {
+      live[buffer.engine][index] += buffer.size;
+    }
+  }
+  for (int engine = 0; engine < num_engines; ++engine) {
+    Arena& arena = plan.arenas[engine];
+    arena.capacity = replayer.capacity();
+    for (int64_t bytes : live[engine]) arena.peak = std::max(arena.peak, bytes);
+    arena.extent = Place(buffers[engine], position, plan_options.alignment);
+    if (plan_options.strict && arena.extent > arena.capacity) {
+      return absl::ResourceExhaustedError(absl::StrCat(
+          "Engine ", engine, " needs ", arena.extent,
+          " bytes of fast memory once placed, ", arena.fragmentation(),
+          " more than live at once; capacity is ", arena.capacity));
+    }
+  }
+  return plan;
+}
+
+std::string MemoryPlanToJson(const MemoryPlan& plan) {
+  std::vector<std::string> arenas;
+  for (const Arena& arena : plan.arenas) {
+    arenas.push_back(absl::StrCat(
+        "    {\"capacity\": ", arena.capacity, ", \"peak\": ", arena.peak,
+        ", \"extent\": ", arena.extent, ", \"fragmentation\": ",
+        arena.fragmentation(), "}"));
+  }
+  std::vector<std::string> buffers;
+  for (const Buffer& buffer : plan.buffers) {
+    buffers.push_back(absl::StrCat(
+        "    {\"tensor\": ", buffer.tensor, ", \"engine\": ", buffer.engine,
+        ", \"subgraphs\": [", buffer.first, ", ", buffer.last,
+        "], \"whole\": ", buffer.whole ? "true" : "false",
+        ", \"offset\": ", buffer.offset, ", \"size\": ", buffer.size, "}"));
+  }
+  return absl::StrCat("{\n  \"arenas\": [\n", absl::StrJoin(arenas, ",\n"),
+                      "\n  ],\n  \"buffers\": [\n",
+                      absl::StrJoin(buffers, ",\n"), "\n  ]\n}\n");
+}
+
+}  // namespace mlsys
@@ -0,0 +1,85 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_MEMORY_PLANNER_H_
+#define MLSYS_MEMORY_PLANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mlsys.h"
+#include "third_party/absl/status/statusor.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Placement of fast memory buffers at concrete offsets.       /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+struct MemoryPlanOptions {
+  // Every offset is a multiple of this.
+  int64_t alignment = 1;
+  // Fails if the placed buffers of an engine extend past its capacity, even
+  // though the bytes live at once would fit.
+  bool strict = false;
+};
+
+// A range of fast memory reserved over consecutive subgraphs of one engine.
+struct Buffer {
+  size_t tensor = 0;
+  int64_t engine = 0;
+  size_t first = 0;  // The subgraphs using it, as indices of the solution.
+  size_t last = 0;
+  // A whole tensor retained across subgraphs, rather than the tile buffer
+  // of one subgraph, sized for the largest slice it holds.
+  bool whole = false;
+  int64_t size = 0;
+  int64_t offset = 0;
+};
+
+struct Arena {
+  FastMemoryCapacity capacity = 0;
+  int64_t peak = 0;    // The most bytes live at once.
+  int64_t extent = 0;  // The end of the highest placed buffer.
+  // What placement costs beyond the live bytes: gaps and alignment.
+  int64_t fragmentation() const { return extent - peak; }
+};
+
+struct MemoryPlan {
+  std::vector<Buffer> buffers;
+  std::vector<Arena> arenas;  // Per engine.
+};
+
+// Gives every tensor a subgraph holds in fast memory an offset into its
+// engine's partition, the way an arena planner would: the retained tensors
+// for as long as they stay resident, and one buffer per input or output of a
+// subgraph for its tiles.  Buffers are placed largest first, each in the
+// tightest gap left by the placed buffers whose subgraphs overlap its own,
+// or above all of them.
+//
+// `solution` must be valid under Evaluate() with `options`.
+absl::StatusOr<MemoryPlan> PlanFastMemory(
+    const Problem& problem, const Solution& solution,
+    const EvaluateOptions& options = {},
+    const MemoryPlanOptions& plan_options = {});
+
+std::string MemoryPlanToJson(const MemoryPlan& plan);
+
+}  // namespace mlsys
+
+#endif  // MLSYS_MEMORY_PLANNER_H_
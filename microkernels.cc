@@ -0,0 +1,155 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "microkernels.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "third_party/absl/strings/string_view.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace mlsys {
+
+namespace {
+
+void GemmScalar(int64_t m, int64_t n, int64_t k, const float* a, int64_t lda,
+                const float* b, int64_t ldb, float* c, int64_t ldc) {
+  for (int64_t i = 0; i < m; ++i) {
+    for (int64_t p = 0; p < k; ++p) {
+      const float scale = a[i * lda + p];
+      for (int64_t j = 0; j < n; ++j) c[i * ldc + j] += scale * b[p * ldb + j];
+    }
+  }
+}
+
+}  // namespace
+
+#if defined(__AVX2__) && defined(__FMA__)
+
+// Blocks of 4 x 16 outputs accumulate in eight registers over all of `k`.
+void Gemm(int64_t m, int64_t n, int64_t k, const float* a, int64_t lda,
+          const float* b, int64_t ldb, float* c, int64_t ldc) {
+  int64_t i = 0;
+  for (; i + 4 <= m; i += 4) {
+    int64_t j = 0;
+    for (; j + 16 <= n; j += 16) {
+      __m256 acc[4][2];
+      for (int r = 0; r < 4; ++r) {
+        acc[r][0] = _mm256_loadu_ps(c + (i + r) * ldc + j);
+        acc[r][1] = _mm256_loadu_ps(c + (i + r) * ldc + j + 8);
+      }
+      for (int64_t p = 0; p < k; ++p) {
+        const __m256 b0 = _mm256_loadu_ps(b + p * ldb + j);
+        const __m256 b1 = _mm256_loadu_ps(b + p * ldb + j + 8);
+        for (int r = 0; r < 4; ++r) {
+          const __m256 scale = _mm256_broadcast_ss(a + (i + r) * lda + p);
+          acc[r][0] = _mm256_fmadd_ps(scale, b0, acc[r][0]);
+          acc[r][1] = _mm256_fmadd_ps(scale, b1, acc[r][1]);
+        }
+      }
+      for (int r = 0; r < 4; ++r) {
+        _mm256_storeu_ps(c + (i + r) * ldc + j, acc[r][0]);
+        _mm256_storeu_ps(c + (i + r) * ldc + j + 8, acc[r][1]);
+      }
+    }
+    GemmScalar(4, n - j, k, a + i * lda, lda, b + j, ldb, c + i * ldc + j,
+               ldc);
+  }
+  GemmScalar(m - i, n, k, a + i * lda, lda, b, ldb, c + i * ldc, ldc);
+}
+
+void AddRow(float* out, const float* in, int64_t n) {
+  int64_t j = 0;
+  for (; j + 8 <= n; j += 8) {
+    _mm256_storeu_ps(out + j, _mm256_add_ps(_mm256_loadu_ps(out + j),
+                                            _mm256_loadu_ps(in + j)));
+  }
+  for (; j < n; ++j) out[j] += in[j];
+}
+
+void AddScalar(float* out, float value, int64_t n) {
+  const __m256 broadcast = _mm256_set1_ps(value);
+  int64_t j = 0;
+  for (; j + 8 <= n; j += 8) {
+    _mm256_storeu_ps(out + j, _mm256_add_ps(_mm256_loadu_ps(out + j),
+                                            broadcast));
+  }
+  for (; j < n; ++j) out[j] += value;
+}
+
+void Clamp(float* out, int64_t n) {
+  const __m256 low = _mm256_set1_ps(-1.0f);
+  const __m256 high = _mm256_set1_ps(1.0f);
+  int64_t j = 0;
+  for (; j + 8 <= n; j += 8) {
+    _mm256_storeu_ps(out + j, _mm256_min_ps(_mm256_max_ps(
+                                  _mm256_loadu_ps(out + j), low), high));
+  }
+  for (; j < n; ++j) out[j] = std::clamp(out[j], -1.0f, 1.0f);
+}
+
+float SumRow(const float* in, int64_t n) {
+  __m256 acc = _mm256_setzero_ps();
+  int64_t j = 0;
+  for (; j + 8 <= n; j += 8) acc = _mm256_add_ps(acc, _mm256_loadu_ps(in + j));
+  alignas(32) float lanes[8];
+  _mm256_store_ps(lanes, acc);
+  float sum = 0.0f;
+  for (float lane : lanes) sum += lane;
+  for (; j < n; ++j) sum += in[j];
+  return sum;
+}
+
+absl::string_view MicrokernelIsa() { return "avx2"; }
+
+#else
+
+void Gemm(int64_t m, int64_t n, int64_t k, const float* a, int64_t lda,
+          const float* b, int64_t ldb, float* c, int64_t ldc) {
+  GemmScalar(m, n, k, a, lda, b, ldb, c, ldc);
+}
+
+void AddRow(float* out, const float* in, int64_t n) {
+  for (int64_t j = 0; j < n; ++j) out[j] += in[j];
+}
+
+void AddScalar(float* out, float value, int64_t n) {
+  for (int64_t j = 0; j < n; ++j) out[j] += value;
+}
+
+void Clamp(float* out, int64_t n) {
+  for (int64_t j = 0; j < n; ++j) out[j] = std::clamp(out[j], -1.0f, 1.0f);
+}
+
+float SumRow(const float* in, int64_t n) {
+  float sum = 0.0f;
+  for (int64_t j = 0; j < n; ++j) sum += in[j];
+  return sum;
+}
+
+absl::string_view MicrokernelIsa() { return "scalar"; }
+
+#endif
+
+void TransposeRow(float* out, const float* in, int64_t stride, int64_t n) {
+  for (int64_t j = 0; j < n; ++j) out[j] = in[j * stride];
+}
+
+}  // namespace mlsys
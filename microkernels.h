@@ -0,0 +1,58 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_MICROKERNELS_H_
+#define MLSYS_MICROKERNELS_H_
+
+#include <cstdint>
+
+#include "third_party/absl/strings/string_view.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Float kernels of the CPU executor.                          /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// Operands are row-major, with explicit leading dimensions where they are
+// strided.  With AVX2 and FMA enabled at build time the kernels use them;
+// otherwise they are plain loops.
+
+// c[m x n] += a[m x k] * b[k x n].
+void Gemm(int64_t m, int64_t n, int64_t k, const float* a, int64_t lda,
+          const float* b, int64_t ldb, float* c, int64_t ldc);
+
+// out[j] += in[j].
+void AddRow(float* out, const float* in, int64_t n);
+
+// out[j] += value.
+void AddScalar(float* out, float value, int64_t n);
+
+// Clamps out[j] to [-1, 1].
+void Clamp(float* out, int64_t n);
+
+// The sum of in[0, n).
+float SumRow(const float* in, int64_t n);
+
+// out[j] = in[j * stride], a column of a row-major matrix.
+void TransposeRow(float* out, const float* in, int64_t stride, int64_t n);
+
+// "avx2" or "scalar".
+absl::string_view MicrokernelIsa();
+
+}  // namespace mlsys
+
+#endif  // MLSYS_MICROKERNELS_H_
@@ -0,0 +1,559 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "mlsys.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "file_util.h"
+#include "json_util.h"
+#include "roofline.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/strings/str_join.h"
+#include "third_party/absl/strings/string_view.h"
+
+namespace mlsys {
+
+const Granularity& NativeGranularity(const Problem& problem,
+                                     const OpType& op_type) {
+  if (problem.op_native_granularities.empty()) {
+    return problem.native_granularity;
+  }
+  const auto it = problem.op_native_granularities.find(op_type);
+  return it != problem.op_native_granularities.end()
+             ? it->second
+             : problem.native_granularity;
+}
+
+absl::StatusOr<SliceRule> GetSliceRule(const Problem& problem, size_t op) {
+  const Op& spec = problem.ops[op];
+  if (spec.op_type == "Pointwise") return SliceRule::kPointwise;
+  if (spec.op_type == "MatMul") {
+    if (spec.inputs.size() != 2) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("MatMul op ", op, " must have two inputs"));
+    }
+    return SliceRule::kMatMul;
+  }
+  if (spec.op_type != "Reduction" && spec.op_type != "Transpose") {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Op ", op, " has unsupported type ", spec.op_type));
+  }
+  if (spec.inputs.size() != 1 || spec.outputs.size() != 1) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        spec.op_type, " op ", op, " must have one input and one output"));
+  }
+  const Tensor& input = problem.tensors[spec.inputs[0]];
+  const Tensor& output = problem.tensors[spec.outputs[0]];
+  if (spec.op_type == "Transpose") {
+    if (output.width == input.height && output.height == input.width) {
+      return SliceRule::kTranspose;
+    }
+  } else if (output.width == 1 && output.height == input.height) {
+    return SliceRule::kRowReduction;
+  } else if (output.height == 1 && output.width == input.width) {
+    return SliceRule::kColumnReduction;
+  }
+  return absl::InvalidArgumentError(absl::StrCat(
+      spec.op_type, " op ", op, " has a mismatched output shape"));
+}
+
+Depth ReductionDepth(const Problem& problem, const Op& op) {
+  if (op.inputs.empty()) return 0;
+  if (op.op_type == "MatMul") return problem.tensors[op.inputs[0]].width;
+  if (op.op_type != "Reduction" || op.outputs.empty()) return 0;
+  const Tensor& output = problem.tensors[op.outputs[0]];
+  const Tensor& input = problem.tensors[op.inputs[0]];
+  return output.width == 1 && output.height == input.height ? input.width
+                                                            : input.height;
+}
+
+SlowMemoryBandwidth ReadBandwidth(const Problem& problem) {
+  return problem.slow_memory_read_bandwidth.value_or(
+      problem.slow_memory_bandwidth);
+}
+
+SlowMemoryBandwidth WriteBandwidth(const Problem& problem) {
+  return problem.slow_memory_write_bandwidth.value_or(
+      problem.slow_memory_bandwidth);
+}
+
+bool HasMiddleMemory(const Problem& problem) {
+  return problem.middle_memory_capacity.has_value();
+}
+
+MemoryLevel RetentionLevel(const Subgraph& subgraph, size_t i) {
+  return i < subgraph.retention_levels.size() ? subgraph.retention_levels[i]
+                                              : MemoryLevel::kFast;
+}
+
+absl::StatusOr<Problem> ParseProblem(absl::string_view json) {
+  JsonReader reader(json);
+  std::vector<Width> widths;
+  std::vector<Height> heights;
+  std::vector<Inputs> inputs;
+  std::vector<Outputs> outputs;
+  std::vector<BaseCost> base_costs;
+  std::vector<OpType> op_types;
+  std::vector<int64_t> native;
+  std::vector<ElementBytes> element_bytes;
+  Problem problem;
+  bool has_capacity = false;
+  bool has_bandwidth = false;
+  absl::Status status = reader.ReadObject([&](const std::string& key) {
+    if (key == "widths") return reader.ReadNumbers(&widths);
+    if (key == "heights") return reader.ReadNumbers(&heights);
+    if (key == "inputs") return ReadNestedNumbers(reader, &inputs);
+    if (key == "outputs") return ReadNestedNumbers(reader, &outputs);
+    if (key == "base_costs") return reader.ReadNumbers(&base_costs);
+    if (key == "native_granularity") return reader.ReadNumbers(&native);
+    if (key == "element_bytes") return reader.ReadNumbers(&element_bytes);
+    if (key == "dma_setup_latency") {
+      absl::StatusOr<double> value = reader.ReadNumber<double>();
+      if (!value.ok()) return value.status();
+      problem.dma_setup_latency = *value;
+      return absl::OkStatus();
+    }
+    if (key == "native_granularities") {
+      return reader.ReadObject([&](const std::string& op_type) {
+        std::vector<int64_t> dims;
+        if (absl::Status status = reader.ReadNumbers(&dims); !status.ok()) {
+          return status;
+        }
+        if (dims.size() < 2) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "native_granularities of ", op_type, " needs two dimensions"));
+        }
+        problem.op_native_granularities[op_type] = {
+            dims[0], dims[1], dims.size() > 2 ? dims[2] : 1};
+        return absl::OkStatus();
+      });
+    }
+    if (key == "op_types") {
+      return reader.ReadArray([&]() -> absl::Status {
+        absl::StatusOr<std::string> op_type = reader.ReadString();
+        if (!op_type.ok()) return op_type.status();
+        op_types.push_back(*std::move(op_type));
+        return absl::OkStatus();
+      });
+    }
+    if (key == "fast_memory_capacity" || key == "slow_memory_bandwidth" ||
+        key == "slow_memory_read_bandwidth" ||
+        key == "slow_memory_write_bandwidth" || key == "accumulator_bytes" ||
+        key == "middle_memory_capacity" || key == "middle_memory_bandwidth") {
+      absl::StatusOr<int64_t> value = reader.ReadNumber<int64_t>();
+      if (!value.ok()) return value.status();
+      if (key == "fast_memory_capacity") {
+        problem.fast_memory_capacity = *value;
+        has_capacity = true;
+      } else if (key == "slow_memory_bandwidth") {
+        problem.slow_memory_bandwidth = *value;
+        has_bandwidth = true;
+      } else if (key == "slow_memory_read_bandwidth") {
+        problem.slow_memory_read_bandwidth = *value;
+      } else if (key == "slow_memory_write_bandwidth") {
+        problem.slow_memory_write_bandwidth = *value;
+      } else if (key == "accumulator_bytes") {
+        problem.accumulator_bytes = *value;
+      } else if (key == "middle_memory_capacity") {
+        problem.middle_memory_capacity = *value;
+      } else {
+        problem.middle_memory_bandwidth = *value;
+      }
+      return absl::OkStatus();
+    }
+    return reader.SkipValue();
+  });
+  if (status.ok()) status = reader.ExpectEnd();
+  if (!status.ok()) return status;
+
+  if (widths.size() != heights.size()) {
+    return absl::InvalidArgumentError("widths and heights differ in length");
+  }
+  if (!element_bytes.empty() && element_bytes.size() != widths.size()) {
+    return absl::InvalidArgumentError(
+        "element_bytes and widths differ in length");
+  }
+  const size_t num_ops = op_types.size();
+  if (inputs.size() != num_ops || outputs.size() != num_ops ||
+      base_costs.size() != num_ops) {
+    return absl::InvalidArgumentError(
+        "inputs, outputs, base_costs and op_types differ in length");
+  }
+  if (!has_capacity || !has_bandwidth || native.size() < 2) {
+    return absl::InvalidArgumentError(
+        "Missing fast_memory_capacity, slow_memory_bandwidth or "
+        "native_granularity");
+  }
+  problem.native_granularity = {native[0], native[1],
+                                native.size() > 2 ? native[2] : 1};
+  problem.tensors.reserve(widths.size());
+  for (size_t i = 0; i < widths.size(); ++i) {
+    problem.tensors.push_back(
+        {widths[i], heights[i],
+         element_bytes.empty() ? ElementBytes{1} : element_bytes[i]});
+  }
+  problem.ops.reserve(num_ops);
+  for (size_t i = 0; i < num_ops; ++i) {
+    problem.ops.push_back({std::move(op_types[i]), std::move(inputs[i]),
+                           std::move(outputs[i]), base_costs[i]});
+  }
+  if (absl::Status status = ValidateProblem(problem); !status.ok()) {
+    return status;
+  }
+  return problem;
+}
+
+absl::Status ValidateProblem(const Problem& problem) {
+  const Granularity& native = problem.native_granularity;
+  if (problem.fast_memory_capacity <= 0 ||
+      problem.slow_memory_bandwidth <= 0 || native.width <= 0 ||
+      native.height <= 0 || ReadBandwidth(problem) <= 0 ||
+      WriteBandwidth(problem) <= 0 ||
+      problem.accumulator_bytes.value_or(1) <= 0 ||
+      problem.middle_memory_capacity.value_or(1) <= 0 ||
+      problem.middle_memory_bandwidth.value_or(1) <= 0) {
+    return absl::InvalidArgumentError("Hardware parameters must be positive");
+  }
+  if (problem.middle_memory_capacity.has_value() !=
+      problem.middle_memory_bandwidth.has_value()) {
+    return absl::InvalidArgumentError(
+        "middle_memory_capacity and middle_memory_bandwidth go together");
+  }
+  if (!(problem.dma_setup_latency.value_or(0.0) >= 0.0)) {
+    return absl::InvalidArgumentError(
+        "dma_setup_latency must be non-negative");
+  }
+  for (const auto& [op_type, granularity] : problem.op_native_granularities) {
+    if (granularity.width <= 0 || granularity.height <= 0) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Native granularity of ", op_type, " must be positive"));
+    }
+  }
+  for (size_t i = 0; i < problem.tensors.size(); ++i) {
+    if (problem.tensors[i].width <= 0 || problem.tensors[i].height <= 0) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Tensor ", i, " has a non-positive dimension"));
+    }
+    if (problem.tensors[i].element_bytes <= 0) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Tensor ", i, " has a non-positive element size"));
+    }
+  }
+  std::vector<char> produced(problem.tensors.size(), 0);
+  for (size_t i = 0; i < problem.ops.size(); ++i) {
+    const Op& op = problem.ops[i];
+    for (const std::vector<size_t>* tensors : {&op.inputs, &op.outputs}) {
+      for (size_t tensor : *tensors) {
+        if (tensor >= problem.tensors.size()) {
+          return absl::InvalidArgumentError(
+              absl::StrCat("Op ", i, " references unknown tensor ", tensor));
+        }
+      }
+    }
+    for (size_t tensor : op.outputs) {
+      if (produced[tensor]++) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Tensor ", tensor, " has more than one producer"));
+      }
+    }
+    if (absl::Status status = GetSliceRule(problem, i).status();
+        !status.ok()) {
+      return status;
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<Problem> ReadProblem(const std::string& filename) {
+  absl::StatusOr<std::string> json = ReadFile(filename);
+  if (!json.ok()) return json.status();
+  return ParseProblem(*json);
+}
+
+absl::StatusOr<Solution> ParseSolution(absl::string_view json) {
+  JsonReader reader(json);
+  std::vector<std::vector<size_t>> ops;
+  std::vector<std::vector<int64_t>> granularities;
+  std::vector<std::vector<size_t>> tensors_to_retain;
+  std::vector<std::optional<TraversalOrder>> traversal_orders;
+  std::vector<SubgraphLatency> latencies;
+  std::vector<std::optional<int64_t>> engines;
+  std::vector<std::vector<size_t>> dependencies;
+  std::vector<std::vector<int64_t>> retention_levels;
+  absl::Status status = reader.ReadObject([&](const std::string& key) {
+    if (key == "subgraphs") return ReadNestedNumbers(reader, &ops);
+    if (key == "retention_levels") {
+      return ReadNestedNumbers(reader, &retention_levels);
+    }
+    if (key == "dependencies") return ReadNestedNumbers(reader, &dependencies);
+    if (key == "engines") {
+      return reader.ReadArray([&]() -> absl::Status {
+        engines.emplace_back();
+        if (reader.ConsumeNull()) return absl::OkStatus();
+        absl::StatusOr<int64_t> engine = reader.ReadNumber<int64_t>();
+        if (!engine.ok()) return engine.status();
+        engines.back() = *engine;
+        return absl::OkStatus();
+      });
+    }
+    if (key == "granularities") {
+      return ReadNestedNumbers(reader, &granularities);
+    }
+    if (key == "tensors_to_retain") {
+      return ReadNestedNumbers(reader, &tensors_to_retain);
+    }
+    if (key == "subgraph_latencies") return reader.ReadNumbers(&latencies);
+    if (key == "traversal_orders") {
+      return reader.ReadArray([&]() -> absl::Status {
+        traversal_orders.emplace_back();
+        if (reader.ConsumeNull()) return absl::OkStatus();
+        return reader.ReadNumbers(&traversal_orders.back().emplace());
+      });
+    }
+    return reader.SkipValue();
+  });
+  if (status.ok()) status = reader.ExpectEnd();
+  if (!status.ok()) return status;
+
+  const size_t num_subgraphs = ops.size();
+  if (granularities.size() != num_subgraphs ||
+      tensors_to_retain.size() != num_subgraphs) {
+    return absl::InvalidArgumentError(
+        "subgraphs, granularities and tensors_to_retain differ in length");
+  }
+  if ((!traversal_orders.empty() &&
+       traversal_orders.size() != num_subgraphs) ||
+      (!latencies.empty() && latencies.size() != num_subgraphs)) {
+    return absl::InvalidArgumentError(
+        "traversal_orders or subgraph_latencies has the wrong length");
+  }
+  if ((!engines.empty() && engines.size() != num_subgraphs) ||
+      (!dependencies.empty() && dependencies.size() != num_subgraphs)) {
+    return absl::InvalidArgumentError(
+        "engines or dependencies has the wrong length");
+  }
+  if (!retention_levels.empty() && retention_levels.size() != num_subgraphs) {
+    return absl::InvalidArgumentError(
+        "retention_levels has the wrong length");
+  }
+  Solution solution;
+  solution.subgraphs.reserve(num_subgraphs);
+  for (size_t i = 0; i < num_subgraphs; ++i) {
+    if (granularities[i].size() != 3) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Granularity ", i, " must have three entries"));
+    }
+    solution.subgraphs.push_back(
+        {std::move(ops[i]),
+         std::move(tensors_to_retain[i]),
+         {granularities[i][0], granularities[i][1], granularities[i][2]},
+         traversal_orders.empty() ? std::nullopt
+                                  : std::move(traversal_orders[i]),
+         latencies.empty() ? 0.0 : latencies[i],
+         engines.empty() ? std::nullopt : engines[i],
+         dependencies.empty() ? std::vector<size_t>()
+                              : std::move(dependencies[i])});
+    if (retention_levels.empty() || retention_levels[i].empty()) continue;
+    Subgraph& subgraph = solution.subgraphs.back();
+    if (retention_levels[i].size() != subgraph.tensors_to_retain.size()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "retention_levels ", i, " and tensors_to_retain differ in length"));
+    }
+    for (int64_t level : retention_levels[i]) {
+      if (level != static_cast<int64_t>(MemoryLevel::kFast) &&
+          level != static_cast<int64_t>(MemoryLevel::kMiddle)) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Unknown retention level ", level));
+      }
+      subgraph.retention_levels.push_back(static_cast<MemoryLevel>(level));
+    }
+  }
+  return solution;
+}
+
+absl::StatusOr<Solution> ReadSolution(const std::string& filename) {
+  absl::StatusOr<std::string> json = ReadFile(filename);
+  if (!json.ok()) return json.status();
+  return ParseSolution(*json);
+}
+
+absl::StatusOr<TotalLatency> Evaluate(const Problem& problem,
+                                      const Solution& solution,
+                                      const EvaluateOptions& options) {
+  return Replayer(problem, options).Evaluate(solution);
+}
+
+std::string ProblemToJson(const Problem& problem) {
+  std::vector<Width> widths;
+  std::vector<Height> heights;
+  std::vector<ElementBytes> element_bytes;
+  widths.reserve(problem.tensors.size());
+  heights.reserve(problem.tensors.size());
+  element_bytes.reserve(problem.tensors.size());
+  bool uniform_bytes = true;
+  for (const Tensor& tensor : problem.tensors) {
+    widths.push_back(tensor.width);
+    heights.push_back(tensor.height);
+    element_bytes.push_back(tensor.element_bytes);
+    uniform_bytes &= tensor.element_bytes == 1;
+  }
+  std::vector<Inputs> inputs;
+  std::vector<Outputs> outputs;
+  std::vector<BaseCost> base_costs;
+  std::vector<OpType> op_types;
+  inputs.reserve(problem.ops.size());
+  outputs.reserve(problem.ops.size());
+  base_costs.reserve(problem.ops.size());
+  op_types.reserve(problem.ops.size());
+  for (const Op& op : problem.ops) {
+    inputs.push_back(op.inputs);
+    outputs.push_back(op.outputs);
+    base_costs.push_back(op.base_cost);
+    op_types.push_back(op.op_type);
+  }
+  std::string json = "{\n";
+  absl::StrAppend(&json, "  \"widths\": ", JsonList(widths), ",\n");
+  absl::StrAppend(&json, "  \"heights\": ", JsonList(heights), ",\n");
+  if (!uniform_bytes) {
+    absl::StrAppend(&json, "  \"element_bytes\": ", JsonList(element_bytes),
+                    ",\n");
+  }
+  absl::StrAppend(&json, "  \"inputs\": ", JsonNestedList(inputs), ",\n");
+  absl::StrAppend(&json, "  \"outputs\": ", JsonNestedList(outputs), ",\n");
+  absl::StrAppend(&json, "  \"base_costs\": ", JsonList(base_costs), ",\n");
+  absl::StrAppend(&json, "  \"op_types\": ", JsonStringList(op_types), ",\n");
+  absl::StrAppend(&json, "  \"fast_memory_capacity\": ",
+                  problem.fast_memory_capacity, ",\n");
+  absl::StrAppend(&json, "  \"slow_memory_bandwidth\": ",
+                  problem.slow_memory_bandwidth, ",\n");
+  if (problem.slow_memory_read_bandwidth.has_value()) {
+    absl::StrAppend(&json, "  \"slow_memory_read_bandwidth\": ",
+                    *problem.slow_memory_read_bandwidth, ",\n");
+  }
+  if (problem.slow_memory_write_bandwidth.has_value()) {
+    absl::StrAppend(&json, "  \"slow_memory_write_bandwidth\": ",
+                    *problem.slow_memory_write_bandwidth, ",\n");
+  }
+  if (problem.accumulator_bytes.has_value()) {
+    absl::StrAppend(&json, "  \"accumulator_bytes\": ",
+                    *problem.accumulator_bytes, ",\n");
+  }
+  if (HasMiddleMemory(problem)) {
+    absl::StrAppend(&json, "  \"middle_memory_capacity\": ",
+                    *problem.middle_memory_capacity, ",\n");
+    absl::StrAppend(&json, "  \"middle_memory_bandwidth\": ",
+                    *problem.middle_memory_bandwidth, ",\n");
+  }
+  if (problem.dma_setup_latency.has_value()) {
+    absl::StrAppend(&json, "  \"dma_setup_latency\": ",
+                    JsonDouble(*problem.dma_setup_latency), ",\n");
+  }
+  if (!problem.op_native_granularities.empty()) {
+    absl::StrAppend(
+        &json, "  \"native_granularities\": {",
+        absl::StrJoin(problem.op_native_granularities, ", ",
+                      [](std::string* out, const auto& entry) {
+                        absl::StrAppend(out, "\"", entry.first, "\": [",
+                                        entry.second.width, ", ",
+                                        entry.second.height, "]");
+                      }),
+        "},\n");
+  }
+  absl::StrAppend(&json, "  \"native_granularity\": [",
+                  problem.native_granularity.width, ", ",
+                  problem.native_granularity.height, "]\n");
+  absl::StrAppend(&json, "}\n");
+  return json;
+}
+
+absl::Status WriteProblem(const Problem& problem,
+                          const std::string& filename) {
+  return WriteFile(filename, ProblemToJson(problem));
+}
+
+std::string SolutionToJson(const Solution& solution) {
+  std::vector<std::vector<size_t>> ops;
+  std::vector<std::vector<int64_t>> granularities;
+  std::vector<std::vector<size_t>> tensors_to_retain;
+  std::vector<std::string> traversal_orders;
+  std::vector<std::string> latencies;
+  std::vector<std::string> engines;
+  std::vector<std::vector<size_t>> dependencies;
+  std::vector<std::vector<int64_t>> retention_levels;
+  bool has_engines = false;
+  bool has_dependencies = false;
+  bool has_retention_levels = false;
+  for (const Subgraph& subgraph : solution.subgraphs) {
+    std::vector<int64_t>& levels = retention_levels.emplace_back();
+    for (MemoryLevel level : subgraph.retention_levels) {
+      levels.push_back(static_cast<int64_t>(level));
+    }
+    has_retention_levels |= !levels.empty();
+    engines.push_back(subgraph.engine.has_value()
+                          ? absl::StrCat(*subgraph.engine)
+                          : "null");
+    dependencies.push_back(subgraph.dependencies);
+    has_engines |= subgraph.engine.has_value();
+    has_dependencies |= !subgraph.dependencies.empty();
+    ops.push_back(subgraph.ops);
+    granularities.push_back({subgraph.granularity.width,
+                             subgraph.granularity.height,
+                             subgraph.granularity.depth});
+    tensors_to_retain.push_back(subgraph.tensors_to_retain);
+    traversal_orders.push_back(subgraph.traversal_order.has_value()
+                                   ? JsonList(*subgraph.traversal_order)
+                                   : "null");
+    latencies.push_back(JsonDouble(subgraph.subgraph_latency));
+  }
+  std::string json = "{\n";
+  absl::StrAppend(&json, "  \"subgraphs\": ", JsonNestedList(ops), ",\n");
+  absl::StrAppend(&json, "  \"granularities\": ",
+                  JsonNestedList(granularities), ",\n");
+  absl::StrAppend(&json, "  \"tensors_to_retain\": ",
+                  JsonNestedList(tensors_to_retain), ",\n");
+  absl::StrAppend(&json, "  \"traversal_orders\": ",
+                  JsonList(traversal_orders), ",\n");
+  if (has_engines) {
+    absl::StrAppend(&json, "  \"engines\": ", JsonList(engines), ",\n");
+  }
+  if (has_dependencies) {
+    absl::StrAppend(&json, "  \"dependencies\": ",
+                    JsonNestedList(dependencies), ",\n");
+  }
+  if (has_retention_levels) {
+    absl::StrAppend(&json, "  \"retention_levels\": ",
+                    JsonNestedList(retention_levels), ",\n");
+  }
+  absl::StrAppend(&json, "  \"subgraph_latencies\": ", JsonList(latencies),
+                  "\n");
+  absl::StrAppend(&json, "}\n");
+  return json;
+}
+
+absl::Status WriteSolution(const Solution& solution,
+                           const std::string& filename) {
+  return WriteFile(filename, SolutionToJson(solution));
+}
+
+}  // namespace mlsys
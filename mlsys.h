@@ -24,7 +24,10 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "third_party/absl/container/btree_map.h"
+#include "third_party/absl/status/status.h"
 #include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/string_view.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 /////////  Basic definitions for problem & solution data structures.   /////////
@@ -46,9 +49,15 @@ using TotalLatency = double;
 using TraversalOrder = std::vector<int64_t>;
 using Width = int64_t;
 
+// Fast memory capacity and bandwidths count bytes.  Every element takes one
+// byte unless a problem says otherwise, so by default bytes and elements
+// coincide as in PROBLEM.md.
+using ElementBytes = int64_t;
+
 struct Tensor {
   Width width;
   Height height;
+  ElementBytes element_bytes = 1;
   bool operator==(const Tensor& other) const = default;
 };
 
@@ -73,10 +82,84 @@ struct Problem {
   FastMemoryCapacity fast_memory_capacity;
   SlowMemoryBandwidth slow_memory_bandwidth;
   Granularity native_granularity;
+  // Overrides `native_granularity` for ops of the given types, e.g. a vector
+  // unit narrower than the matrix unit.  Use NativeGranularity().  An op's
+  // `base_cost` is charged per native tile of its own override, so adding
+  // one rescales its compute: Pointwise at 128x8 costs 16 base_costs per
+  // 128x128 tile, so its base_cost should shrink to match.
+  absl::btree_map<OpType, Granularity> op_native_granularities;
+  // Loads and stores may run at different rates; either defaults to
+  // `slow_memory_bandwidth`.  Use ReadBandwidth() and WriteBandwidth().
+  std::optional<SlowMemoryBandwidth> slow_memory_read_bandwidth;
+  std::optional<SlowMemoryBandwidth> slow_memory_write_bandwidth;
+  // The width of a MatMul or Reduction result while fast memory accumulates
+  // it; defaults to the result's own `element_bytes`, the width it is stored
+  // at.
+  std::optional<ElementBytes> accumulator_bytes;
+  // An optional middle memory between fast and slow memory, with its own
+  // link to fast memory.  Data moving between fast and slow memory passes
+  // through it; Subgraph::retention_levels may keep tensors in it instead
+  // of slow memory.  Either both are set or neither.
+  std::optional<FastMemoryCapacity> middle_memory_capacity;
+  std::optional<SlowMemoryBandwidth> middle_memory_bandwidth;
+  // A fixed cost of every transfer to or from slow memory, on top of its
+  // bytes over the bandwidth: DMA descriptor setup and handshake.
+  std::optional<SubgraphLatency> dma_setup_latency;
   bool operator==(const Problem& other) const = default;
 };
 
+bool HasMiddleMemory(const Problem& problem);
+
+// The native granularity of ops of type `op_type`.
+const Granularity& NativeGranularity(const Problem& problem,
+                                     const OpType& op_type);
+
+// How an op maps the slice of its output a step computes to the slices of
+// its inputs it reads, under a `[w, h, k]` granularity.
+enum class SliceRule {
+  kPointwise,        // The same slice of every input, or its broadcast.
+  kMatMul,           // `h x k` of the LHS and `k x w` of the RHS.
+  kRowReduction,     // `h` full rows of the input, `k` columns at a time.
+  kColumnReduction,  // `w` full columns of the input, `k` rows at a time.
+  kTranspose,        // The mirrored `h x w` slice of the input.
+};
+
+// "Pointwise", "MatMul", "Reduction" or "Transpose".  A Reduction has one
+// input and one output, either one element wide (reducing each row) or one
+// element tall (reducing each column); a Transpose has one input and one
+// output with the dimensions swapped.  Fails for any other type or shape.
+absl::StatusOr<SliceRule> GetSliceRule(const Problem& problem, size_t op);
+
+// The extent an op reduces over and slices along `k`: the LHS width of a
+// MatMul, the reduced dimension of a Reduction, and zero otherwise, including
+// for an op missing the tensors its type needs.
+Depth ReductionDepth(const Problem& problem, const Op& op);
+
+// The rates of loads into and stores out of fast memory.
+SlowMemoryBandwidth ReadBandwidth(const Problem& problem);
+SlowMemoryBandwidth WriteBandwidth(const Problem& problem);
+
 absl::StatusOr<Problem> ReadProblem(const std::string& filename);
+absl::StatusOr<Problem> ParseProblem(absl::string_view json);
+
+// The checks ParseProblem() applies, for problems obtained otherwise:
+// positive hardware parameters (including any read and write bandwidths, the
+// accumulator width, per-op-type native granularities and a complete middle
+// memory, if any), a non-negative DMA setup latency, tensor dimensions and
+// element sizes, ops referencing known tensors only, ops of a known type and
+// arity that GetSliceRule() accepts, and at most one producer per tensor.
+absl::Status ValidateProblem(const Problem& problem);
+
+// Serializes a problem in the input format described in PROBLEM.md.
+std::string ProblemToJson(const Problem& problem);
+
+absl::Status WriteProblem(const Problem& problem, const std::string& filename);
+
+// Where a subgraph retains a tensor for its successor.
+enum class MemoryLevel : int64_t {
+  kFast = 0,
+  kMiddle = 1,  // Problem::middle_memory_capacity.
+};
 
 struct Subgraph {
   std::vector<size_t> ops;
@@ -84,18 +167,71 @@ struct Subgraph {
   Granularity granularity;
   std::optional<TraversalOrder> traversal_order;
   SubgraphLatency subgraph_latency;
+  // For EvaluateOptions::num_engines: the engine running the subgraph
+  // (engine 0 if absent), and earlier subgraphs it must wait for besides
+  // those writing its inputs and those before it on its engine.
+  std::optional<int64_t> engine = std::nullopt;
+  std::vector<size_t> dependencies = {};
+  // Parallel to `tensors_to_retain`; empty retains everything in fast
+  // memory.  Unlike fast memory, middle memory may also keep a tensor the
+  // subgraph does not touch if it was already there.
+  std::vector<MemoryLevel> retention_levels = {};
   bool operator==(const Subgraph& other) const = default;
 };
 
+// The level at which `subgraph` retains its `i`-th tensor to retain.
+MemoryLevel RetentionLevel(const Subgraph& subgraph, size_t i);
+
 struct Solution {
   std::vector<Subgraph> subgraphs;
   bool operator==(const Solution& other) const = default;
 };
 
 absl::StatusOr<Solution> ReadSolution(const std::string& filename);
+absl::StatusOr<Solution> ParseSolution(absl::string_view json);
+
+// Serializes a solution in the output format described in PROBLEM.md.
+std::string SolutionToJson(const Solution& solution);
+
+absl::Status WriteSolution(const Solution& solution,
+                           const std::string& filename);
+
+// Extensions of the cost model in PROBLEM.md.  The defaults are the contest
+// semantics.
+enum class BandwidthSharing {
+  kFair,       // Engines moving data split the bandwidth evenly.
+  kDedicated,  // Every engine has a link of the full bandwidth.
+};
+
+struct EvaluateOptions {
+  // Compute engines, each with an even partition of the fast memory, running
+  // subgraphs concurrently.  The latency is then the makespan.  Retained
+  // tensors pass to the next subgraph on the same engine.
+  int num_engines = 1;
+  BandwidthSharing bandwidth_sharing = BandwidthSharing::kFair;
+
+  // Lets the loads of each subgraph's first step start during the last step
+  // of its predecessor, in whatever time that step leaves the slow memory
+  // idle and into whatever fast memory it leaves free.  Tensors the
+  // predecessor itself writes back cannot be prefetched.  Ignored with more
+  // than one engine.
+  bool overlap_prefetch = false;
+
+  // Prices one iteration of the graph run back to back, as when serving
+  // requests: what the last subgraph of an engine retains is resident in the
+  // first subgraph of that engine in the next iteration.  Only weights may
+  // wrap around: graph inputs read solely as the right-hand side of MatMuls,
+  // taken to be the same in every iteration, while other graph inputs arrive
+  // with each request.  A subgraph may also retain a resident weight it does
+  // not touch, so a weight can stay in fast memory for the whole iteration.
+  // The latency is that of an iteration in the steady state; nothing is
+  // prefetched across the wrap.
+  bool repeated = false;
+};
 
 absl::StatusOr<TotalLatency> Evaluate(const Problem& problem,
-                                      const Solution& solution);
+                                      const Solution& solution,
+                                      const EvaluateOptions& options = {});
 
 }  // namespace mlsys
 
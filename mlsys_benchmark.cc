@@ -0,0 +1,398 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Microbenchmarks for the hot paths of the core API: parsing, serialization,
+// evaluation and granularity sweeps, on the released benchmarks and on
+// synthetic problems.
+//
+//   $ ./mlsys_benchmark --benchmark_out=out.json --benchmark_out_format=json
+//
+// Where perf_event_open(2) is permitted, every benchmark also reports
+// per-iteration cycles, instructions, cache misses and branch misses.  Two
+// JSON result files can be diffed with Google Benchmark's tools/compare.py.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "generator.h"
+#include "granularity_sweep.h"
+#include "mlsys.h"
+#include "perf_counters.h"
+#include "roofline.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/flags/parse.h"
+#include "third_party/absl/strings/numbers.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/strings/str_split.h"
+#include "third_party/benchmark/include/benchmark/benchmark.h"
+
+ABSL_FLAG(std::string, benchmark_dir, "benchmarks",
+          "Directory holding the released problem files.");
+ABSL_FLAG(std::string, synthetic_ops, "1000,10000,100000",
+          "Op counts of the synthetic transformer problems.");
+ABSL_FLAG(std::string, tile_sizes, "128,64,32,16",
+          "Square granularities for the tile-count sweeps.");
+
+namespace mlsys {
+namespace {
+
+struct Case {
+  std::string name;
+  Problem problem;
+  Solution solution;
+  std::string problem_json;
+  std::string solution_json;
+  std::string problem_path;
+  std::string solution_path;
+};
+
+std::vector<size_t> TopologicalOrder(const Problem& problem) {
+  std::vector<int64_t> producer(problem.tensors.size(), -1);
+  for (size_t op = 0; op < problem.ops.size(); ++op) {
+    for (size_t tensor : problem.ops[op].outputs) producer[tensor] = op;
+  }
+  std::vector<std::vector<size_t>> consumers(problem.ops.size());
+  std::vector<int64_t> pending(problem.ops.size(), 0);
+  for (size_t op = 0; op < problem.ops.size(); ++op) {
+    for (size_t tensor : problem.ops[op].inputs) {
+      if (producer[tensor] < 0) continue;
+      consumers[producer[tensor]].push_back(op);
+      ++pending[op];
+    }
+  }
+  std::vector<size_t> order;
+  for (size_t op = 0; op < problem.ops.size(); ++op) {
+    if (pending[op] == 0) order.push_back(op);
+  }
+  for (size_t i = 0; i < order.size(); ++i) {
+    for (size_t consumer : consumers[order[i]]) {
+      if (--pending[consumer] == 0) order.push_back(consumer);
+    }
+  }
+  return order;
+}
+
+// Serpentine order over a `rows x cols` grid, so that consecutive tiles share
+// a row or column strip.
+TraversalOrder SnakeOrder(int64_t rows, int64_t cols) {
+  TraversalOrder order;
+  order.reserve(rows * cols);
+  for (int64_t row = 0; row < rows; ++row) {
+    for (int64_t i = 0; i < cols; ++i) {
+      order.push_back(row * cols + (row % 2 == 0 ? i : cols - 1 - i));
+    }
+  }
+  return order;
+}
+
+// One subgraph per op with a `tile x tile` granularity, halving the reduction
+// depth and then the tile until the working set fits.
+Solution SingleOpSolution(const Problem& problem, int64_t tile,
+                          bool traversal) {
+  Replayer replayer(problem);
+  Solution solution;
+  for (size_t op : TopologicalOrder(problem)) {
+    const Tensor& output = problem.tensors[problem.ops[op].outputs.front()];
+    const Depth reduction =
+        std::max<Depth>(1, ReductionDepth(problem, problem.ops[op]));
+    Subgraph subgraph{{op}, {}, {}, std::nullopt, 0.0};
+    for (int64_t size = tile; size >= 1; size /= 2) {
+      subgraph.granularity = {std::min(size, output.width),
+                              std::min(size, output.height), reduction};
+      bool fits = false;
+      for (; subgraph.granularity.depth >= 1;
+           subgraph.granularity.depth /= 2) {
+        if (traversal) {
+          subgraph.traversal_order = SnakeOrder(
+              (output.height + subgraph.granularity.height - 1) /
+                  subgraph.granularity.height,
+              (output.width + subgraph.granularity.width - 1) /
+                  subgraph.granularity.width);
+        }
+        absl::StatusOr<SubgraphLatency> latency =
+            replayer.SubgraphCost(subgraph, {});
+        if (latency.ok()) {
+          subgraph.subgraph_latency = *latency;
+          fits = true;
+          break;
+        }
+      }
+      if (fits) break;
+    }
+    solution.subgraphs.push_back(std::move(subgraph));
+  }
+  return solution;
+}
+
+std::unique_ptr<Case> MakeCase(std::string name, Problem problem,
+                               int64_t tile, bool traversal) {
+  auto c = std::make_unique<Case>();
+  c->name = std::move(name);
+  c->problem = std::move(problem);
+  c->solution = SingleOpSolution(c->problem, tile, traversal);
+  c->problem_json = ProblemToJson(c->problem);
+  c->solution_json = SolutionToJson(c->solution);
+  const std::filesystem::path dir = std::filesystem::temp_directory_path();
+  c->problem_path = dir / absl::StrCat("mlsys_benchmark_", c->name, ".json");
+  c->solution_path =
+      dir / absl::StrCat("mlsys_benchmark_", c->name, "_solution.json");
+  if (!WriteProblem(c->problem, c->problem_path).ok() ||
+      !WriteSolution(c->solution, c->solution_path).ok()) {
+    std::cerr << "Cannot write benchmark inputs for " << c->name << "\n";
+  }
+  return c;
+}
+
+int64_t CountSteps(const Case& c) {
+  int64_t steps = 0;
+  Replayer replayer(c.problem);
+  (void)replayer.Replay(c.solution, [&](const Step&) { ++steps; });
+  return steps;
+}
+
+// Measures the benchmark loop with hardware counters, reported per iteration.
+template <typename F>
+void Measure(benchmark::State& state, F body) {
+  PerfCounters counters;
+  counters.Start();
+  for (auto _ : state) body();
+  counters.Stop();
+  for (int event = 0; event < PerfCounters::kNumEvents; ++event) {
+    const auto e = static_cast<PerfCounters::Event>(event);
+    if (std::optional<uint64_t> value = counters.Read(e)) {
+      state.counters[std::string(PerfCounters::Name(e))] =
+          benchmark::Counter(*value, benchmark::Counter::kAvgIterations);
+    }
+  }
+}
+
+void RegisterParsing(const Case& c) {
+  benchmark::RegisterBenchmark(
+      absl::StrCat("ParseProblem/", c.name).c_str(),
+      [&c](benchmark::State& state) {
+        Measure(state, [&] {
+          benchmark::DoNotOptimize(ParseProblem(c.problem_json));
+        });
+        state.SetBytesProcessed(state.iterations() * c.problem_json.size());
+      });
+  benchmark::RegisterBenchmark(
+      absl::StrCat("ReadProblem/", c.name).c_str(),
+      [&c](benchmark::State& state) {
+        Measure(state, [&] {
+          benchmark::DoNotOptimize(ReadProblem(c.problem_path));
+        });
+        state.SetBytesProcessed(state.iterations() * c.problem_json.size());
+      });
+  benchmark::RegisterBenchmark(
+      absl::StrCat("ParseSolution/", c.name).c_str(),
+      [&c](benchmark::State& state) {
+        Measure(state, [&] {
+          benchmark::DoNotOptimize(ParseSolution(c.solution_json));
+        });
+        state.SetBytesProcessed(state.iterations() * c.solution_json.size());
+      });
+  benchmark::RegisterBenchmark(
+      absl::StrCat("ReadSolution/", c.name).c_str(),
+      [&c](benchmark::State& state) {
+        Measure(state, [&] {
+          benchmark::DoNotOptimize(ReadSolution(c.solution_path));
+        });
+        state.SetBytesProcessed(state.iterations() * c.solution_json.size());
+      });
+}
+
+void RegisterEvaluate(const std::string& family, const Case& c,
+                      int max_threads) {
+  const int64_t steps = CountSteps(c);
+  benchmark::RegisterBenchmark(
+      absl::StrCat(family, "/", c.name).c_str(),
+      [&c, steps](benchmark::State& state) {
+        Measure(state, [&] {
+          benchmark::DoNotOptimize(Evaluate(c.problem, c.solution));
+        });
+        state.counters["subgraphs"] = c.solution.subgraphs.size();
+        state.counters["steps"] = steps;
+        state.counters["steps_per_second"] = benchmark::Counter(
+            state.iterations() * steps, benchmark::Counter::kIsRate);
+      })
+      ->ThreadRange(1, max_threads)
+      ->UseRealTime();
+  // The path taken by solvers: one replayer per thread, reused.
+  benchmark::RegisterBenchmark(
+      absl::StrCat(family, "Reused/", c.name).c_str(),
+      [&c, steps](benchmark::State& state) {
+        Replayer replayer(c.problem);
+        Measure(state, [&] {
+          benchmark::DoNotOptimize(replayer.Evaluate(c.solution));
+        });
+        state.counters["steps_per_second"] = benchmark::Counter(
+            state.iterations() * steps, benchmark::Counter::kIsRate);
+      });
+}
+
+// The granularities a solver would weigh for a subgraph: powers of two up to
+// each extent, and the extent itself, at most 4096 steps each.
+std::vector<Granularity> SweepCandidates(const SubgraphBoundary& boundary) {
+  const auto sizes = [](int64_t extent) {
+    std::vector<int64_t> sizes;
+    for (int64_t size = 1; size < extent; size *= 2) sizes.push_back(size);
+    sizes.push_back(extent);
+    return sizes;
+  };
+  const auto steps = [](int64_t extent, int64_t size) {
+    return (extent + size - 1) / size;
+  };
+  const int64_t reduction = std::max<int64_t>(boundary.reduction, 1);
+  std::vector<Granularity> candidates;
+  for (int64_t width : sizes(boundary.width)) {
+    for (int64_t height : sizes(boundary.height)) {
+      for (int64_t depth : sizes(reduction)) {
+        if (steps(boundary.width, width) * steps(boundary.height, height) *
+                steps(reduction, depth) <=
+            4096) {
+          candidates.push_back({width, height, depth});
+        }
+      }
+    }
+  }
+  return candidates;
+}
+
+// Scores the candidate granularities of the first op of a problem alone:
+// replaying each, and all at once with the sweep.
+void RegisterGranularitySweep(const Case& c) {
+  const std::vector<size_t> ops = {0};
+  absl::StatusOr<SubgraphBoundary> boundary =
+      DescribeBoundary(c.problem, ops);
+  if (!boundary.ok()) return;
+  std::vector<Granularity> candidates = SweepCandidates(*boundary);
+  benchmark::RegisterBenchmark(
+      absl::StrCat("ReplayGranularities/", c.name).c_str(),
+      [&c, ops, candidates](benchmark::State& state) {
+        Replayer replayer(c.problem);
+        Measure(state, [&] {
+          for (const Granularity& granularity : candidates) {
+            const Subgraph subgraph{ops, {}, granularity, std::nullopt, 0.0};
+            benchmark::DoNotOptimize(replayer.SubgraphCost(subgraph, {}));
+          }
+        });
+        state.counters["candidates_per_second"] = benchmark::Counter(
+            state.iterations() * candidates.size(),
+            benchmark::Counter::kIsRate);
+      });
+  benchmark::RegisterBenchmark(
+      absl::StrCat("SweepGranularities/", c.name).c_str(),
+      [&c, boundary = *std::move(boundary),
+       candidates](benchmark::State& state) {
+        Measure(state, [&] {
+          benchmark::DoNotOptimize(
+              SweepGranularities(c.problem, boundary, candidates));
+        });
+        state.counters["candidates_per_second"] = benchmark::Counter(
+            state.iterations() * candidates.size(),
+            benchmark::Counter::kIsRate);
+      });
+}
+
+std::vector<int64_t> ParseList(const std::string& list) {
+  std::vector<int64_t> values;
+  for (absl::string_view item : absl::StrSplit(list, ',', absl::SkipEmpty())) {
+    int64_t value;
+    if (absl::SimpleAtoi(item, &value) && value > 0) values.push_back(value);
+  }
+  return values;
+}
+
+}  // namespace
+}  // namespace mlsys
+
+int main(int argc, char* argv[]) {
+  benchmark::Initialize(&argc, argv);
+  absl::ParseCommandLine(argc, argv);
+
+  using mlsys::Case;
+  std::vector<std::unique_ptr<Case>> cases;
+  const int max_threads =
+      std::max<int>(1, std::thread::hardware_concurrency());
+
+  // Released benchmarks, each with a single-op-per-subgraph solution.
+  std::vector<std::filesystem::path> paths;
+  std::error_code error;
+  for (const auto& entry : std::filesystem::directory_iterator(
+           absl::GetFlag(FLAGS_benchmark_dir), error)) {
+    if (entry.path().extension() == ".json") paths.push_back(entry.path());
+  }
+  std::sort(paths.begin(), paths.end());
+  for (const std::filesystem::path& path : paths) {
+    absl::StatusOr<mlsys::Problem> problem = mlsys::ReadProblem(path);
+    if (!problem.ok()) {
+      std::cerr << path << ": " << problem.status() << "\n";
+      continue;
+    }
+    cases.push_back(mlsys::MakeCase(path.stem(), *std::move(problem), 128,
+                                    /*traversal=*/false));
+    mlsys::RegisterParsing(*cases.back());
+    mlsys::RegisterEvaluate("Evaluate", *cases.back(), max_threads);
+    mlsys::RegisterGranularitySweep(*cases.back());
+  }
+
+  // Latency versus subgraph count.
+  for (int64_t ops : mlsys::ParseList(absl::GetFlag(FLAGS_synthetic_ops))) {
+    mlsys::GeneratorOptions options;
+    options.target_num_ops = ops;
+    absl::StatusOr<mlsys::Problem> problem = mlsys::GenerateProblem(options);
+    if (!problem.ok()) continue;
+    cases.push_back(mlsys::MakeCase(absl::StrCat("transformer_", ops),
+                                    *std::move(problem), 128,
+                                    /*traversal=*/false));
+    mlsys::RegisterParsing(*cases.back());
+    mlsys::RegisterEvaluate("EvaluateSubgraphs", *cases.back(), 1);
+  }
+
+  // Latency versus tile count, with default and explicit traversal orders.
+  mlsys::GeneratorOptions block;
+  block.num_layers = 1;
+  if (absl::StatusOr<mlsys::Problem> problem = mlsys::GenerateProblem(block);
+      problem.ok()) {
+    for (int64_t tile : mlsys::ParseList(absl::GetFlag(FLAGS_tile_sizes))) {
+      for (bool traversal : {false, true}) {
+        cases.push_back(mlsys::MakeCase(
+            absl::StrCat("tile_", tile, traversal ? "_snake" : "_raster"),
+            *problem, tile, traversal));
+        mlsys::RegisterEvaluate(
+            traversal ? "EvaluateTraversal" : "EvaluateTiles", *cases.back(),
+            1);
+      }
+    }
+  }
+
+  mlsys::PerfCounters probe;
+  benchmark::AddCustomContext("perf_counters",
+                              probe.available() ? "enabled" : "unavailable");
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
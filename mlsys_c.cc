@@ -0,0 +1,236 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "mlsys_c.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "binary_format.h"
+#include "mlsys.h"
+#include "roofline.h"
+#include "solver.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/string_view.h"
+#include "third_party/absl/time/clock.h"
+#include "third_party/absl/time/time.h"
+
+struct mlsys_problem {
+  std::shared_ptr<const mlsys::Problem> problem;
+};
+
+struct mlsys_solution {
+  mlsys::Solution solution;
+};
+
+struct mlsys_solver {
+  std::shared_ptr<const mlsys::Problem> problem;
+  std::optional<mlsys::Solver> solver;  // Refers to *problem.
+  bool initialized = false;
+};
+
+namespace {
+
+void* DefaultAllocate(void*, size_t size) { return std::malloc(size); }
+void DefaultDeallocate(void*, void* pointer, size_t) { std::free(pointer); }
+
+mlsys_allocator allocator = {DefaultAllocate, DefaultDeallocate, nullptr};
+
+thread_local std::string last_error;
+
+mlsys_status Fail(const absl::Status& status) {
+  last_error = status.ToString();
+  const int code = static_cast<int>(status.code());
+  // absl reserves the right to add codes; those read as internal errors.
+  if (code < MLSYS_OK || code > MLSYS_UNAUTHENTICATED) return MLSYS_INTERNAL;
+  return static_cast<mlsys_status>(code);
+}
+
+mlsys_status OutOfMemory() {
+  return Fail(absl::ResourceExhaustedError("The allocator returned null"));
+}
+
+// Handles live in memory from the hooks.
+template <typename T, typename... Args>
+T* New(Args&&... args) {
+  void* memory = allocator.allocate(allocator.context, sizeof(T));
+  if (memory == nullptr) return nullptr;
+  return new (memory) T{std::forward<Args>(args)...};
+}
+
+template <typename T>
+void Delete(T* object) {
+  if (object == nullptr) return;
+  object->~T();
+  allocator.deallocate(allocator.context, object, sizeof(T));
+}
+
+// Copies `bytes` into a buffer from the hooks.
+mlsys_status Export(absl::string_view bytes, void** buffer, size_t* size) {
+  *buffer = allocator.allocate(allocator.context, bytes.size());
+  if (*buffer == nullptr && !bytes.empty()) return OutOfMemory();
+  if (!bytes.empty()) std::memcpy(*buffer, bytes.data(), bytes.size());
+  *size = bytes.size();
+  return MLSYS_OK;
+}
+
+mlsys_status NewProblem(absl::StatusOr<mlsys::Problem> problem,
+                        mlsys_problem** handle) {
+  if (!problem.ok()) return Fail(problem.status());
+  *handle = New<mlsys_problem>(
+      std::make_shared<const mlsys::Problem>(*std::move(problem)));
+  return *handle == nullptr ? OutOfMemory() : MLSYS_OK;
+}
+
+mlsys_status NewSolution(absl::StatusOr<mlsys::Solution> solution,
+                         mlsys_solution** handle) {
+  if (!solution.ok()) return Fail(solution.status());
+  *handle = New<mlsys_solution>(*std::move(solution));
+  return *handle == nullptr ? OutOfMemory() : MLSYS_OK;
+}
+
+absl::string_view View(const void* bytes, size_t size) {
+  return absl::string_view(static_cast<const char*>(bytes), size);
+}
+
+}  // namespace
+
+extern "C" {
+
+void mlsys_set_allocator(const mlsys_allocator* hooks) {
+  allocator = hooks != nullptr
+                  ? *hooks
+                  : mlsys_allocator{DefaultAllocate, DefaultDeallocate,
+                                    nullptr};
+}
+
+void mlsys_free(void* buffer, size_t size) {
+  if (buffer != nullptr) {
+    allocator.deallocate(allocator.context, buffer, size);
+  }
+}
+
+const char* mlsys_last_error(void) { return last_error.c_str(); }
+
+mlsys_status mlsys_problem_from_json(const char* json, size_t size,
+                                     mlsys_problem** problem) {
+  return NewProblem(mlsys::ParseProblem(View(json, size)), problem);
+}
+
+mlsys_status mlsys_problem_from_binary(const void* bytes, size_t size,
+                                       mlsys_problem** problem) {
+  return NewProblem(mlsys::ParseBinaryProblem(View(bytes, size)), problem);
+}
+
+mlsys_status mlsys_problem_to_binary(const mlsys_problem* problem,
+                                     void** bytes, size_t* size) {
+  return Export(mlsys::ProblemToBinary(*problem->problem), bytes, size);
+}
+
+void mlsys_problem_destroy(mlsys_problem* problem) { Delete(problem); }
+
+mlsys_status mlsys_solution_from_json(const char* json, size_t size,
+                                      mlsys_solution** solution) {
+  return NewSolution(mlsys::ParseSolution(View(json, size)), solution);
+}
+
+mlsys_status mlsys_solution_from_binary(const void* bytes, size_t size,
+                                        mlsys_solution** solution) {
+  return NewSolution(mlsys::ParseBinarySolution(View(bytes, size)), solution);
+}
+
+mlsys_status mlsys_solution_to_json(const mlsys_solution* solution,
+                                    char** json, size_t* size) {
+  void* buffer;
+  const mlsys_status status =
+      Export(mlsys::SolutionToJson(solution->solution), &buffer, size);
+  *json = static_cast<char*>(buffer);
+  return status;
+}
+
+mlsys_status mlsys_solution_to_binary(const mlsys_solution* solution,
+                                      void** bytes, size_t* size) {
+  return Export(mlsys::SolutionToBinary(solution->solution), bytes, size);
+}
+
+void mlsys_solution_destroy(mlsys_solution* solution) { Delete(solution); }
+
+mlsys_status mlsys_evaluate(const mlsys_problem* problem,
+                            const mlsys_solution* solution, double* latency) {
+  const absl::StatusOr<mlsys::TotalLatency> result =
+      mlsys::Replayer(*problem->problem).Evaluate(solution->solution);
+  if (!result.ok()) return Fail(result.status());
+  *latency = *result;
+  return MLSYS_OK;
+}
+
+void mlsys_solver_options_init(mlsys_solver_options* options) {
+  *options = {};
+  options->struct_size = sizeof(mlsys_solver_options);
+  options->num_threads = 1;
+  options->seed = 1;
+}
+
+mlsys_status mlsys_solver_create(const mlsys_problem* problem,
+                                  const mlsys_solver_options* options,
+                                  mlsys_solver** solver) {
+  mlsys_solver_options given;
+  mlsys_solver_options_init(&given);
+  if (options != nullptr) {
+    // Fields beyond what the caller was compiled with keep their defaults.
+    std::memcpy(&given, options,
+                std::min(options->struct_size, sizeof(given)));
+    given.struct_size = sizeof(given);
+  }
+  mlsys::SolverOptions solver_options;
+  solver_options.num_threads = std::max(1, given.num_threads);
+  solver_options.seed = given.seed;
+  if (given.initial_solution != nullptr) {
+    solver_options.initial_solution = given.initial_solution->solution;
+  }
+  *solver = New<mlsys_solver>();
+  if (*solver == nullptr) return OutOfMemory();
+  (*solver)->problem = problem->problem;
+  (*solver)->solver.emplace(*(*solver)->problem, std::move(solver_options));
+  return MLSYS_OK;
+}
+
+mlsys_status mlsys_solver_solve(mlsys_solver* solver, double budget_seconds,
+                                mlsys_solution** solution) {
+  const absl::Time deadline = absl::Now() + absl::Seconds(budget_seconds);
+  if (!solver->initialized) {
+    if (absl::Status status = solver->solver->Initialize(deadline);
+        !status.ok()) {
+      return Fail(status);
+    }
+    solver->initialized = true;
+  }
+  solver->solver->Improve(deadline);
+  return NewSolution(solver->solver->best(), solution);
+}
+
+void mlsys_solver_cancel(mlsys_solver* solver) { solver->solver->Cancel(); }
+
+void mlsys_solver_destroy(mlsys_solver* solver) { Delete(solver); }
+
+}  // extern "C"
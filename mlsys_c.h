@@ -0,0 +1,152 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_MLSYS_C_H_
+#define MLSYS_MLSYS_C_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  A C interface to the evaluator and solver, for embedding.   /////////
+////////////////////////////////////////////////////////////////////////////////
+
+// Every object is an opaque handle owned by the caller and released with
+// the matching *_destroy function.  Handles may be used from any thread;
+// one solver handle may not be solved from two threads at once, but may be
+// cancelled from any thread while it solves.  Functions that can fail
+// return a status and leave a description in mlsys_last_error().
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define MLSYS_C_API __attribute__((visibility("default")))
+#else
+#define MLSYS_C_API
+#endif
+
+// The absl::StatusCode values.
+typedef enum {
+  MLSYS_OK = 0,
+  MLSYS_CANCELLED = 1,
+  MLSYS_UNKNOWN = 2,
+  MLSYS_INVALID_ARGUMENT = 3,
+  MLSYS_DEADLINE_EXCEEDED = 4,
+  MLSYS_NOT_FOUND = 5,
+  MLSYS_ALREADY_EXISTS = 6,
+  MLSYS_PERMISSION_DENIED = 7,
+  MLSYS_RESOURCE_EXHAUSTED = 8,
+  MLSYS_FAILED_PRECONDITION = 9,
+  MLSYS_ABORTED = 10,
+  MLSYS_OUT_OF_RANGE = 11,
+  MLSYS_UNIMPLEMENTED = 12,
+  MLSYS_INTERNAL = 13,
+  MLSYS_UNAVAILABLE = 14,
+  MLSYS_DATA_LOSS = 15,
+  MLSYS_UNAUTHENTICATED = 16,
+} mlsys_status;
+
+typedef struct mlsys_problem mlsys_problem;
+typedef struct mlsys_solution mlsys_solution;
+typedef struct mlsys_solver mlsys_solver;
+
+// Memory hooks.  `allocate` returns null on failure; `deallocate` receives
+// the size that was allocated.
+typedef struct {
+  void* (*allocate)(void* context, size_t size);
+  void (*deallocate)(void* context, void* pointer, size_t size);
+  void* context;
+} mlsys_allocator;
+
+// Routes the allocation of handles and of every buffer returned to the
+// caller through `allocator`, or back to malloc() when null.  Must be called
+// while no handle or returned buffer is alive.
+MLSYS_C_API void mlsys_set_allocator(const mlsys_allocator* allocator);
+
+// Releases a buffer returned by this library.
+MLSYS_C_API void mlsys_free(void* buffer, size_t size);
+
+// The message of the last failure on the calling thread, valid until the
+// next call on it.
+MLSYS_C_API const char* mlsys_last_error(void);
+
+// Problems, from the JSON of PROBLEM.md or the encoding of binary_format.h.
+MLSYS_C_API mlsys_status mlsys_problem_from_json(const char* json,
+                                                 size_t size,
+                                                 mlsys_problem** problem);
+MLSYS_C_API mlsys_status mlsys_problem_from_binary(const void* bytes,
+                                                   size_t size,
+                                                   mlsys_problem** problem);
+// Allocates `*bytes`, to be released with mlsys_free(*bytes, *size).
+MLSYS_C_API mlsys_status mlsys_problem_to_binary(const mlsys_problem* problem,
+                                                 void** bytes, size_t* size);
+MLSYS_C_API void mlsys_problem_destroy(mlsys_problem* problem);
+
+MLSYS_C_API mlsys_status mlsys_solution_from_json(const char* json,
+                                                  size_t size,
+                                                  mlsys_solution** solution);
+MLSYS_C_API mlsys_status mlsys_solution_from_binary(
+    const void* bytes, size_t size, mlsys_solution** solution);
+// Allocate `*json` (not null-terminated) or `*bytes`, to be released with
+// mlsys_free().
+MLSYS_C_API mlsys_status mlsys_solution_to_json(
+    const mlsys_solution* solution, char** json, size_t* size);
+MLSYS_C_API mlsys_status mlsys_solution_to_binary(
+    const mlsys_solution* solution, void** bytes, size_t* size);
+MLSYS_C_API void mlsys_solution_destroy(mlsys_solution* solution);
+
+// The latency of `solution`; fails if it is invalid.
+MLSYS_C_API mlsys_status mlsys_evaluate(const mlsys_problem* problem,
+                                        const mlsys_solution* solution,
+                                        double* latency);
+
+typedef struct {
+  // sizeof(mlsys_solver_options), so that fields may be added later.
+  size_t struct_size;
+  int num_threads;
+  uint64_t seed;
+  // Optional starting point of the search; not retained.
+  const mlsys_solution* initial_solution;
+} mlsys_solver_options;
+
+MLSYS_C_API void mlsys_solver_options_init(mlsys_solver_options* options);
+
+// The solver keeps its own reference to the problem.  `options` may be null.
+MLSYS_C_API mlsys_status mlsys_solver_create(
+    const mlsys_problem* problem, const mlsys_solver_options* options,
+    mlsys_solver** solver);
+
+// Searches for `budget_seconds` more, starting where the previous call
+// stopped, and returns the best solution so far.  Returns early once
+// cancelled.
+MLSYS_C_API mlsys_status mlsys_solver_solve(mlsys_solver* solver,
+                                            double budget_seconds,
+                                            mlsys_solution** solution);
+
+// Makes a running mlsys_solver_solve() return promptly, and later ones
+// immediately.  Cancelling before the first call still yields an unfused
+// starting schedule.
+MLSYS_C_API void mlsys_solver_cancel(mlsys_solver* solver);
+
+MLSYS_C_API void mlsys_solver_destroy(mlsys_solver* solver);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // MLSYS_MLSYS_C_H_
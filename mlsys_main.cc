@@ -0,0 +1,234 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// The contest entry point:
+//
+//   $ ./mlsys <path_to_input.json> <path_to_output.json>
+//
+// Writes a first valid solution as soon as one is known and overwrites it
+// with the final one before the problem's timeout (see README.md).  With
+// --telemetry_out, solver telemetry is dumped there at exit and whenever the
+// process receives SIGUSR1.  With --cache_dir, a solution cached for the
+// same problem is returned at once, or with --cache_improve used as the
+// starting point of the search; the result goes back into the cache.
+//
+//   $ ./mlsys --batch=manifest.txt --jobs=8
+//
+// solves every `<input.json> <output.json>` pair listed in the manifest in
+// one process (see RunBatch()).
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "batch.h"
+#include "mlsys.h"
+#include "solution_cache.h"
+#include "solver.h"
+#include "telemetry.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/flags/parse.h"
+#include "third_party/absl/flags/usage.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/time/clock.h"
+#include "third_party/absl/time/time.h"
+
+ABSL_FLAG(std::optional<absl::Duration>, time_limit, std::nullopt,
+          "Search budget; defaults to the contest timeout for the problem "
+          "size, less a safety margin.  With --batch, the wall time of the "
+          "whole batch.");
+ABSL_FLAG(int, threads, 0, "Search threads; 0 uses every hardware thread.");
+ABSL_FLAG(uint64_t, seed, 1, "Random seed.");
+ABSL_FLAG(bool, overlap_prefetch, false,
+          "Optimize for hardware that prefetches a subgraph's first inputs "
+          "during its predecessor, instead of the contest's cost model.");
+ABSL_FLAG(int, num_engines, 1,
+          "Compute engines sharing the slow-memory link, each with an equal "
+          "partition of fast memory.");
+ABSL_FLAG(std::string, bandwidth_sharing, "fair",
+          "With --num_engines > 1, how engines share slow-memory bandwidth: "
+          "`fair` or `dedicated`.");
+ABSL_FLAG(bool, repeated, false,
+          "Optimize the steady-state latency of the graph run back to back, "
+          "with weights retained from one iteration for the next.");
+ABSL_FLAG(std::string, telemetry_out, "",
+          "If set, dumps solver telemetry to this file (CSV if it ends in "
+          ".csv, JSON otherwise).");
+ABSL_FLAG(std::string, cache_dir, "",
+          "If set, a directory of solutions to previously seen problems.");
+ABSL_FLAG(bool, cache_isomorphic, false,
+          "Also match cached problems whose ops and tensors are renumbered.");
+ABSL_FLAG(bool, cache_improve, false,
+          "On a cache hit, keep searching from the cached solution instead "
+          "of returning it.");
+ABSL_FLAG(std::string, batch, "",
+          "If set, a manifest of `<input.json> <output.json>` lines to solve "
+          "instead of the positional arguments.");
+ABSL_FLAG(int, jobs, 0,
+          "With --batch, problems solved concurrently; 0 uses every hardware "
+          "thread.");
+
+namespace {
+
+int HardwareThreads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+absl::StatusOr<mlsys::EvaluateOptions> EvaluateOptionsFromFlags() {
+  mlsys::EvaluateOptions options;
+  options.overlap_prefetch = absl::GetFlag(FLAGS_overlap_prefetch);
+  options.repeated = absl::GetFlag(FLAGS_repeated);
+  options.num_engines = absl::GetFlag(FLAGS_num_engines);
+  if (options.num_engines < 1) {
+    return absl::InvalidArgumentError("--num_engines must be positive");
+  }
+  const std::string sharing = absl::GetFlag(FLAGS_bandwidth_sharing);
+  if (sharing == "fair") {
+    options.bandwidth_sharing = mlsys::BandwidthSharing::kFair;
+  } else if (sharing == "dedicated") {
+    options.bandwidth_sharing = mlsys::BandwidthSharing::kDedicated;
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrCat("unknown --bandwidth_sharing: ", sharing));
+  }
+  return options;
+}
+
+int SolveBatch(mlsys::Telemetry* telemetry) {
+  const absl::StatusOr<mlsys::EvaluateOptions> evaluate =
+      EvaluateOptionsFromFlags();
+  if (!evaluate.ok()) {
+    std::cerr << evaluate.status() << "\n";
+    return 1;
+  }
+  mlsys::BatchOptions options;
+  options.manifest = absl::GetFlag(FLAGS_batch);
+  options.num_jobs = absl::GetFlag(FLAGS_jobs);
+  if (options.num_jobs <= 0) options.num_jobs = HardwareThreads();
+  options.time_limit = absl::GetFlag(FLAGS_time_limit);
+  options.solver.seed = absl::GetFlag(FLAGS_seed);
+  options.solver.evaluate = *evaluate;
+  options.solver.telemetry = telemetry;
+  options.cache_dir = absl::GetFlag(FLAGS_cache_dir);
+  options.cache_isomorphic = absl::GetFlag(FLAGS_cache_isomorphic);
+  options.cache_improve = absl::GetFlag(FLAGS_cache_improve);
+  if (const absl::Status status = mlsys::RunBatch(options); !status.ok()) {
+    std::cerr << status << "\n";
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const absl::Time start = absl::Now();
+  absl::SetProgramUsageMessage(
+      "Usage: mlsys [flags] <path_to_input.json> <path_to_output.json>\n"
+      "       mlsys [flags] --batch=<manifest.txt>");
+  const std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+
+  std::unique_ptr<mlsys::Telemetry> telemetry;
+  std::optional<mlsys::TelemetryDumper> dumper;
+  if (const std::string path = absl::GetFlag(FLAGS_telemetry_out);
+      !path.empty()) {
+    telemetry = mlsys::NewSolverTelemetry();
+    dumper.emplace(telemetry.get(), path);
+  }
+
+  if (!absl::GetFlag(FLAGS_batch).empty() && args.size() == 1) {
+    return SolveBatch(telemetry.get());
+  }
+  if (args.size() != 3 || !absl::GetFlag(FLAGS_batch).empty()) {
+    std::cerr << "Usage: " << args[0]
+              << " [flags] <path_to_input.json> <path_to_output.json>\n";
+    return 1;
+  }
+  const std::string output = args[2];
+
+  const absl::StatusOr<mlsys::Problem> problem = mlsys::ReadProblem(args[1]);
+  if (!problem.ok()) {
+    std::cerr << problem.status() << "\n";
+    return 1;
+  }
+  const absl::Time deadline =
+      start + absl::GetFlag(FLAGS_time_limit)
+                  .value_or(mlsys::ContestTimeLimit(*problem));
+
+  const absl::StatusOr<mlsys::EvaluateOptions> evaluate =
+      EvaluateOptionsFromFlags();
+  if (!evaluate.ok()) {
+    std::cerr << evaluate.status() << "\n";
+    return 1;
+  }
+
+  std::optional<mlsys::SolutionCache> cache;
+  std::optional<mlsys::SolutionCache::Entry> cached;
+  if (const std::string directory = absl::GetFlag(FLAGS_cache_dir);
+      !directory.empty()) {
+    cache.emplace(directory, absl::GetFlag(FLAGS_cache_isomorphic), *evaluate);
+    cached = cache->Lookup(*problem);
+    if (cached.has_value() && !absl::GetFlag(FLAGS_cache_improve)) {
+      if (const absl::Status status =
+              mlsys::WriteSolution(cached->solution, output);
+          !status.ok()) {
+        std::cerr << status << "\n";
+        return 1;
+      }
+      return 0;
+    }
+  }
+
+  mlsys::SolverOptions options;
+  options.num_threads = absl::GetFlag(FLAGS_threads);
+  if (options.num_threads <= 0) {
+    options.num_threads = HardwareThreads();
+  }
+  options.seed = absl::GetFlag(FLAGS_seed);
+  options.evaluate = *evaluate;
+  options.telemetry = telemetry.get();
+  if (cached.has_value()) options.initial_solution = cached->solution;
+  mlsys::Solver solver(*problem, options);
+  if (const absl::Status status = solver.Initialize(deadline); !status.ok()) {
+    std::cerr << status << "\n";
+    return 1;
+  }
+  if (const absl::Status status = mlsys::WriteSolution(solver.best(), output);
+      !status.ok()) {
+    std::cerr << status << "\n";
+    return 1;
+  }
+  solver.Improve(deadline);
+  if (const absl::Status status = mlsys::WriteSolution(solver.best(), output);
+      !status.ok()) {
+    std::cerr << status << "\n";
+    return 1;
+  }
+  if (cache.has_value()) {
+    // A failure to cache leaves the written solution valid; only warn.
+    if (const absl::Status status = cache->Store(*problem, solver.best());
+        !status.ok()) {
+      std::cerr << status << "\n";
+    }
+  }
+  return 0;
+}
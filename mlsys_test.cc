@@ -0,0 +1,67 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Checks that malformed problems are rejected when they are loaded.
+
+#include "mlsys.h"
+
+#include <string>
+
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/googletest/googletest/include/gtest/gtest.h"
+
+namespace mlsys {
+namespace {
+
+// A single op reading tensor 0 (and tensor 1, if `inputs` says so) and
+// writing tensor 2, all 128x128.
+std::string OneOpProblem(const std::string& op_type,
+                         const std::string& inputs) {
+  return absl::StrCat(R"({
+    "widths": [128, 128, 128],
+    "heights": [128, 128, 128],
+    "inputs": [)", inputs, R"(],
+    "outputs": [[2]],
+    "base_costs": [1000],
+    "op_types": [")", op_type, R"("],
+    "fast_memory_capacity": 50000,
+    "slow_memory_bandwidth": 10,
+    "native_granularity": [128, 128]
+  })");
+}
+
+TEST(ParseProblemTest, AcceptsWellFormedOps) {
+  EXPECT_TRUE(ParseProblem(OneOpProblem("MatMul", "[0, 1]")).ok());
+  EXPECT_TRUE(ParseProblem(OneOpProblem("Pointwise", "[0, 1]")).ok());
+  EXPECT_TRUE(ParseProblem(OneOpProblem("Transpose", "[0]")).ok());
+}
+
+TEST(ParseProblemTest, RejectsUnknownOpType) {
+  const absl::StatusOr<Problem> problem =
+      ParseProblem(OneOpProblem("Conv", "[0, 1]"));
+  EXPECT_EQ(problem.status().code(), absl::StatusCode::kInvalidArgument);
+}
+
+TEST(ParseProblemTest, RejectsMatMulWithOneInput) {
+  const absl::StatusOr<Problem> problem =
+      ParseProblem(OneOpProblem("MatMul", "[0]"));
+  EXPECT_EQ(problem.status().code(), absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace mlsys
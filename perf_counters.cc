@@ -0,0 +1,124 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "perf_counters.h"
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+#include "third_party/absl/strings/string_view.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace mlsys {
+
+namespace {
+
+#ifdef __linux__
+constexpr uint64_t kConfigs[PerfCounters::kNumEvents] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+int OpenCounter(uint64_t config) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  // pid 0, cpu -1: the calling thread on whichever CPU it runs.
+  return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+}  // namespace
+
+PerfCounters::PerfCounters() {
+  fds_.fill(-1);
+#ifdef __linux__
+  for (int event = 0; event < kNumEvents; ++event) {
+    fds_[event] = OpenCounter(kConfigs[event]);
+  }
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+  for (int fd : fds_) {
+    if (fd >= 0) close(fd);
+  }
+#endif
+}
+
+absl::string_view PerfCounters::Name(Event event) {
+  switch (event) {
+    case kCycles:
+      return "cycles";
+    case kInstructions:
+      return "instructions";
+    case kCacheMisses:
+      return "cache_misses";
+    case kBranchMisses:
+      return "branch_misses";
+  }
+  return "unknown";
+}
+
+bool PerfCounters::available() const {
+  for (int fd : fds_) {
+    if (fd >= 0) return true;
+  }
+  return false;
+}
+
+void PerfCounters::Start() {
+#ifdef __linux__
+  for (int fd : fds_) {
+    if (fd < 0) continue;
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+#endif
+}
+
+void PerfCounters::Stop() {
+#ifdef __linux__
+  for (int fd : fds_) {
+    if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+  }
+#endif
+}
+
+std::optional<uint64_t> PerfCounters::Read(Event event) const {
+#ifdef __linux__
+  uint64_t value = 0;
+  if (fds_[event] >= 0 &&
+      read(fds_[event], &value, sizeof(value)) == sizeof(value)) {
+    return value;
+  }
+#endif
+  return std::nullopt;
+}
+
+}  // namespace mlsys
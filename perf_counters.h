@@ -0,0 +1,58 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_PERF_COUNTERS_H_
+#define MLSYS_PERF_COUNTERS_H_
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "third_party/absl/strings/string_view.h"
+
+namespace mlsys {
+
+// User-space hardware counters of the calling thread, read through
+// perf_event_open(2).  Each event is opened on its own, so a kernel or VM
+// that exposes only some of them (or forbids all of them through
+// perf_event_paranoid) still yields whatever is permitted.
+class PerfCounters {
+ public:
+  enum Event { kCycles, kInstructions, kCacheMisses, kBranchMisses };
+  static constexpr int kNumEvents = 4;
+
+  PerfCounters();
+  ~PerfCounters();
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  static absl::string_view Name(Event event);
+
+  bool available() const;
+
+  // Resets and enables every available counter.
+  void Start();
+  void Stop();
+  // Counts accumulated between Start() and Stop(); nullopt if unavailable.
+  std::optional<uint64_t> Read(Event event) const;
+
+ private:
+  std::array<int, kNumEvents> fds_;
+};
+
+}  // namespace mlsys
+
+#endif  // MLSYS_PERF_COUNTERS_H_
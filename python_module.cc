@@ -0,0 +1,819 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// A CPython extension exposing problems, solutions and the evaluator:
+//
+//   >>> import mlsys, numpy
+//   >>> problem = mlsys.ReadProblem("example_problem.json")
+//   >>> numpy.asarray(problem.tensor_shapes)   # Zero-copy, (tensors, 2).
+//   >>> mlsys.Evaluate(problem, mlsys.ReadSolution("solution.json"))
+//
+// Built against the limited API of CPython 3.11 (the first to include the
+// buffer protocol), the module loads unchanged into every later version:
+//
+//   $ c++ -std=c++20 -O2 -shared -fPIC $(python3-config --includes)
+//       python_module.cc mlsys.cc roofline.cc file_util.cc <absl libs>
+//       -o mlsys.abi3.so
+//
+// Evaluation releases the GIL, so Python threads evaluate in parallel.
+
+#define PY_SSIZE_T_CLEAN
+#define Py_LIMITED_API 0x030B0000
+#include <Python.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mlsys.h"
+#include "roofline.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+
+namespace mlsys {
+namespace {
+
+PyTypeObject* array_type = nullptr;
+PyTypeObject* problem_type = nullptr;
+PyTypeObject* solution_type = nullptr;
+
+PyObject* RaiseStatus(const absl::Status& status) {
+  PyErr_SetString(absl::IsNotFound(status) ? PyExc_FileNotFoundError
+                                           : PyExc_ValueError,
+                  status.ToString().c_str());
+  return nullptr;
+}
+
+// A Python object owning a C++ object of type T.  The C++ object lives on
+// the C++ heap, out of the way of the memory CPython manages.
+template <typename T>
+struct Object {
+  PyObject_HEAD
+  T* impl;
+};
+
+template <typename T>
+T& Impl(PyObject* self) {
+  return *reinterpret_cast<Object<T>*>(self)->impl;
+}
+
+template <typename T>
+PyObject* Allocate(PyTypeObject* type) {
+  auto alloc = reinterpret_cast<allocfunc>(PyType_GetSlot(type, Py_tp_alloc));
+  PyObject* self = alloc(type, 0);
+  if (self == nullptr) return nullptr;
+  reinterpret_cast<Object<T>*>(self)->impl = new T();
+  return self;
+}
+
+// Frees an object of a heap type, whose instances own a type reference.
+template <typename T>
+void Deallocate(PyObject* self) {
+  PyTypeObject* type = Py_TYPE(self);
+  delete reinterpret_cast<Object<T>*>(self)->impl;
+  auto free = reinterpret_cast<freefunc>(PyType_GetSlot(type, Py_tp_free));
+  free(self);
+  Py_DECREF(type);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Arrays: read-only buffers into the memory of other objects. /////////
+////////////////////////////////////////////////////////////////////////////////
+
+struct Array {
+  PyObject* owner = nullptr;  // Strong reference keeping `data` alive.
+  const void* data = nullptr;
+  int ndim = 1;
+  Py_ssize_t shape[2] = {0, 0};
+  Py_ssize_t strides[2] = {0, 0};
+  Py_ssize_t itemsize = 0;
+  const char* format = nullptr;
+
+  ~Array() { Py_XDECREF(owner); }
+};
+
+template <typename T>
+constexpr const char* kFormat = nullptr;
+template <>
+constexpr const char* kFormat<int64_t> = "q";
+template <>
+constexpr const char* kFormat<double> = "d";
+
+// A (rows, columns) view of `data`, or a vector when `columns` is zero.
+template <typename T>
+PyObject* NewArray(PyObject* owner, const T* data, Py_ssize_t rows,
+                   Py_ssize_t columns = 0) {
+  PyObject* self = Allocate<Array>(array_type);
+  if (self == nullptr) return nullptr;
+  Array* array = &Impl<Array>(self);
+  Py_INCREF(owner);
+  array->owner = owner;
+  array->data = data;
+  array->itemsize = sizeof(T);
+  array->format = kFormat<T>;
+  array->shape[0] = rows;
+  if (columns == 0) {
+    array->strides[0] = sizeof(T);
+  } else {
+    array->ndim = 2;
+    array->shape[1] = columns;
+    array->strides[0] = columns * sizeof(T);
+    array->strides[1] = sizeof(T);
+  }
+  return self;
+}
+
+int ArrayGetBuffer(PyObject* self, Py_buffer* view, int flags) {
+  const Array& array = Impl<Array>(self);
+  if (flags & PyBUF_WRITABLE) {
+    PyErr_SetString(PyExc_BufferError, "mlsys arrays are read-only");
+    return -1;
+  }
+  Py_ssize_t length = array.itemsize;
+  for (int i = 0; i < array.ndim; ++i) length *= array.shape[i];
+  view->obj = Py_NewRef(self);
+  view->buf = const_cast<void*>(array.data);
+  view->len = length;
+  view->readonly = 1;
+  view->itemsize = array.itemsize;
+  view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>(array.format)
+                                        : nullptr;
+  view->ndim = array.ndim;
+  // Every array is C-contiguous, so shapes and strides may always be given.
+  view->shape = const_cast<Py_ssize_t*>(array.shape);
+  view->strides = const_cast<Py_ssize_t*>(array.strides);
+  view->suboffsets = nullptr;
+  view->internal = nullptr;
+  return 0;
+}
+
+Py_ssize_t ArrayLength(PyObject* self) {
+  return Impl<Array>(self).shape[0];
+}
+
+PyType_Slot array_slots[] = {
+    {Py_tp_doc, const_cast<char*>(
+                    "A read-only array view; wrap it with numpy.asarray().")},
+    {Py_tp_dealloc, reinterpret_cast<void*>(Deallocate<Array>)},
+    {Py_bf_getbuffer, reinterpret_cast<void*>(ArrayGetBuffer)},
+    {Py_sq_length, reinterpret_cast<void*>(ArrayLength)},
+    {0, nullptr},
+};
+
+PyType_Spec array_spec = {"mlsys.Array", sizeof(Object<Array>), 0,
+                          Py_TPFLAGS_DEFAULT, array_slots};
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Problem.                                                    /////////
+////////////////////////////////////////////////////////////////////////////////
+
+// Holds the problem and, for the array views, its ops flattened into
+// columns: `inputs[input_offsets[op]:input_offsets[op + 1]]` are the inputs
+// of `op`, and likewise for outputs.
+struct ProblemData {
+  std::shared_ptr<const Problem> problem;
+  std::vector<int64_t> tensor_shapes;
+  std::vector<int64_t> element_bytes;
+  std::vector<int64_t> base_costs;
+  std::vector<int64_t> input_offsets;
+  std::vector<int64_t> inputs;
+  std::vector<int64_t> output_offsets;
+  std::vector<int64_t> outputs;
+};
+
+PyObject* NewProblem(absl::StatusOr<Problem> problem) {
+  if (!problem.ok()) return RaiseStatus(problem.status());
+  PyObject* self = Allocate<ProblemData>(problem_type);
+  if (self == nullptr) return nullptr;
+  ProblemData& data = Impl<ProblemData>(self);
+  data.problem = std::make_shared<const Problem>(*std::move(problem));
+  for (const Tensor& tensor : data.problem->tensors) {
+    data.tensor_shapes.push_back(tensor.width);
+    data.tensor_shapes.push_back(tensor.height);
+    data.element_bytes.push_back(tensor.element_bytes);
+  }
+  data.input_offsets.push_back(0);
+  data.output_offsets.push_back(0);
+  for (const Op& op : data.problem->ops) {
+    data.base_costs.push_back(op.base_cost);
+    data.inputs.insert(data.inputs.end(), op.inputs.begin(), op.inputs.end());
+    data.input_offsets.push_back(data.inputs.size());
+    data.outputs.insert(data.outputs.end(), op.outputs.begin(),
+                        op.outputs.end());
+    data.output_offsets.push_back(data.outputs.size());
+  }
+  return self;
+}
+
+const Problem& GetProblem(PyObject* self) {
+  return *Impl<ProblemData>(self).problem;
+}
+
+PyObject* ProblemNumTensors(PyObject* self, void*) {
+  return PyLong_FromSize_t(GetProblem(self).tensors.size());
+}
+
+PyObject* ProblemNumOps(PyObject* self, void*) {
+  return PyLong_FromSize_t(GetProblem(self).ops.size());
+}
+
+PyObject* ProblemFastMemoryCapacity(PyObject* self, void*) {
+  return PyLong_FromLongLong(GetProblem(self).fast_memory_capacity);
+}
+
+PyObject* ProblemSlowMemoryBandwidth(PyObject* self, void*) {
+  return PyLong_FromLongLong(GetProblem(self).slow_memory_bandwidth);
+}
+
+PyObject* ProblemSlowMemoryReadBandwidth(PyObject* self, void*) {
+  return PyLong_FromLongLong(ReadBandwidth(GetProblem(self)));
+}
+
+PyObject* ProblemSlowMemoryWriteBandwidth(PyObject* self, void*) {
+  return PyLong_FromLongLong(WriteBandwidth(GetProblem(self)));
+}
+
+PyObject* ProblemNativeGranularity(PyObject* self, void*) {
+  const Granularity& native = GetProblem(self).native_granularity;
+  return Py_BuildValue("(LL)", static_cast<long long>(native.width),
+                       static_cast<long long>(native.height));
+}
+
+PyObject* ProblemNativeGranularities(PyObject* self, void*) {
+  PyObject* dict = PyDict_New();
+  if (dict == nullptr) return nullptr;
+  for (const auto& [op_type, native] :
+       GetProblem(self).op_native_granularities) {
+    PyObject* value =
+        Py_BuildValue("(LL)", static_cast<long long>(native.width),
+                      static_cast<long long>(native.height));
+    if (value == nullptr ||
+        PyDict_SetItemString(dict, op_type.c_str(), value) < 0) {
+      Py_XDECREF(value);
+      Py_DECREF(dict);
+      return nullptr;
+    }
+    Py_DECREF(value);
+  }
+  return dict;
+}
+
+PyObject* ProblemTensorShapes(PyObject* self, void*) {
+  const std::vector<int64_t>& shapes = Impl<ProblemData>(self).tensor_shapes;
+  return NewArray(self, shapes.data(), shapes.size() / 2, 2);
+}
+
+PyObject* ProblemAccumulatorBytes(PyObject* self, void*) {
+  const std::optional<ElementBytes>& bytes =
+      GetProblem(self).accumulator_bytes;
+  if (!bytes.has_value()) Py_RETURN_NONE;
+  return PyLong_FromLongLong(*bytes);
+}
+
+// Getters for the optional middle memory parameters.
+template <std::optional<int64_t> Problem::*parameter>
+PyObject* ProblemMiddleMemory(PyObject* self, void*) {
+  const std::optional<int64_t>& value = GetProblem(self).*parameter;
+  if (!value.has_value()) Py_RETURN_NONE;
+  return PyLong_FromLongLong(*value);
+}
+
+PyObject* ProblemDmaSetupLatency(PyObject* self, void*) {
+  const std::optional<SubgraphLatency>& latency =
+      GetProblem(self).dma_setup_latency;
+  if (!latency.has_value()) Py_RETURN_NONE;
+  return PyFloat_FromDouble(*latency);
+}
+
+PyObject* ProblemOpTypes(PyObject* self, void*) {
+  const std::vector<Op>& ops = GetProblem(self).ops;
+  PyObject* list = PyList_New(ops.size());
+  if (list == nullptr) return nullptr;
+  for (size_t op = 0; op < ops.size(); ++op) {
+    PyObject* type = PyUnicode_FromStringAndSize(ops[op].op_type.data(),
+                                                 ops[op].op_type.size());
+    if (type == nullptr) {
+      Py_DECREF(list);
+      return nullptr;
+    }
+    PyList_SetItem(list, op, type);
+  }
+  return list;
+}
+
+// Getters for the flattened tensor and op columns.
+template <std::vector<int64_t> ProblemData::*column>
+PyObject* ProblemColumn(PyObject* self, void*) {
+  const std::vector<int64_t>& values = Impl<ProblemData>(self).*column;
+  return NewArray(self, values.data(), values.size());
+}
+
+PyObject* ProblemToJson(PyObject* self, PyObject*) {
+  const std::string json = ProblemToJson(GetProblem(self));
+  return PyUnicode_FromStringAndSize(json.data(), json.size());
+}
+
+PyGetSetDef problem_getset[] = {
+    {"num_tensors", ProblemNumTensors, nullptr, nullptr, nullptr},
+    {"num_ops", ProblemNumOps, nullptr, nullptr, nullptr},
+    {"fast_memory_capacity", ProblemFastMemoryCapacity, nullptr, nullptr,
+     nullptr},
+    {"slow_memory_bandwidth", ProblemSlowMemoryBandwidth, nullptr, nullptr,
+     nullptr},
+    {"slow_memory_read_bandwidth", ProblemSlowMemoryReadBandwidth, nullptr,
+     "slow_memory_bandwidth unless given separately", nullptr},
+    {"slow_memory_write_bandwidth", ProblemSlowMemoryWriteBandwidth, nullptr,
+     "slow_memory_bandwidth unless given separately", nullptr},
+    {"native_granularity", ProblemNativeGranularity, nullptr,
+     "(width, height)", nullptr},
+    {"native_granularities", ProblemNativeGranularities, nullptr,
+     "{op_type: (width, height)} overriding native_granularity", nullptr},
+    {"tensor_shapes", ProblemTensorShapes, nullptr,
+     "int64 array of (width, height) rows, one per tensor", nullptr},
+    {"element_bytes", ProblemColumn<&ProblemData::element_bytes>, nullptr,
+     "int64 array, one per tensor", nullptr},
+    {"accumulator_bytes", ProblemAccumulatorBytes, nullptr,
+     "None unless given: MatMul results accumulate at their element size",
+     nullptr},
+    {"middle_memory_capacity",
+     ProblemMiddleMemory<&Problem::middle_memory_capacity>, nullptr,
+     "None unless the problem has a middle memory", nullptr},
+    {"middle_memory_bandwidth",
+     ProblemMiddleMemory<&Problem::middle_memory_bandwidth>, nullptr,
+     "None unless the problem has a middle memory", nullptr},
+    {"dma_setup_latency", ProblemDmaSetupLatency, nullptr,
+     "None unless transfers to and from slow memory cost extra", nullptr},
+    {"op_types", ProblemOpTypes, nullptr, nullptr, nullptr},
+    {"base_costs", ProblemColumn<&ProblemData::base_costs>, nullptr,
+     "int64 array, one per op", nullptr},
+    {"input_offsets", ProblemColumn<&ProblemData::input_offsets>, nullptr,
+     "The inputs of op i are inputs[input_offsets[i]:input_offsets[i + 1]]",
+     nullptr},
+    {"inputs", ProblemColumn<&ProblemData::inputs>, nullptr, nullptr,
+     nullptr},
+    {"output_offsets", ProblemColumn<&ProblemData::output_offsets>, nullptr,
+     "The outputs of op i are outputs[output_offsets[i]:output_offsets[i + "
+     "1]]",
+     nullptr},
+    {"outputs", ProblemColumn<&ProblemData::outputs>, nullptr, nullptr,
+     nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyMethodDef problem_methods[] = {
+    {"to_json", ProblemToJson, METH_NOARGS, "The problem in JSON."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyType_Slot problem_slots[] = {
+    {Py_tp_doc, const_cast<char*>("A problem; see ReadProblem().")},
+    {Py_tp_dealloc, reinterpret_cast<void*>(Deallocate<ProblemData>)},
+    {Py_tp_getset, problem_getset},
+    {Py_tp_methods, problem_methods},
+    {0, nullptr},
+};
+
+PyType_Spec problem_spec = {"mlsys.Problem", sizeof(Object<ProblemData>), 0,
+                            Py_TPFLAGS_DEFAULT, problem_slots};
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Solution.                                                   /////////
+////////////////////////////////////////////////////////////////////////////////
+
+struct SolutionData {
+  std::shared_ptr<const Solution> solution;
+  std::vector<double> latencies;  // Per subgraph, as given.
+};
+
+PyObject* NewSolution(PyTypeObject* type, absl::StatusOr<Solution> solution) {
+  if (!solution.ok()) return RaiseStatus(solution.status());
+  PyObject* self = Allocate<SolutionData>(type);
+  if (self == nullptr) return nullptr;
+  SolutionData& data = Impl<SolutionData>(self);
+  data.solution = std::make_shared<const Solution>(*std::move(solution));
+  for (const Subgraph& subgraph : data.solution->subgraphs) {
+    data.latencies.push_back(subgraph.subgraph_latency);
+  }
+  return self;
+}
+
+const Solution& GetSolution(PyObject* self) {
+  return *Impl<SolutionData>(self).solution;
+}
+
+template <typename T>
+PyObject* ToList(const std::vector<T>& values) {
+  PyObject* list = PyList_New(values.size());
+  if (list == nullptr) return nullptr;
+  for (size_t i = 0; i < values.size(); ++i) {
+    PyObject* value = PyLong_FromLongLong(static_cast<long long>(values[i]));
+    if (value == nullptr) {
+      Py_DECREF(list);
+      return nullptr;
+    }
+    PyList_SetItem(list, i, value);
+  }
+  return list;
+}
+
+// Reads a sequence of non-negative integers.
+template <typename T>
+bool FromSequence(PyObject* sequence, std::vector<T>* values) {
+  const Py_ssize_t size = PySequence_Size(sequence);
+  if (size < 0) return false;
+  values->clear();
+  for (Py_ssize_t i = 0; i < size; ++i) {
+    PyObject* item = PySequence_GetItem(sequence, i);
+    if (item == nullptr) return false;
+    const long long value = PyLong_AsLongLong(item);
+    Py_DECREF(item);
+    if (value == -1 && PyErr_Occurred()) return false;
+    if (value < 0) {
+      PyErr_SetString(PyExc_ValueError, "Negative index");
+      return false;
+    }
+    values->push_back(value);
+  }
+  return true;
+}
+
+PyObject* SubgraphToDict(const Subgraph& subgraph) {
+  const Granularity& granularity = subgraph.granularity;
+  PyObject* ops = ToList(subgraph.ops);
+  PyObject* retain = ToList(subgraph.tensors_to_retain);
+  PyObject* traversal = subgraph.traversal_order.has_value()
+                            ? ToList(*subgraph.traversal_order)
+                            : Py_NewRef(Py_None);
+  PyObject* engine = subgraph.engine.has_value()
+                         ? PyLong_FromLongLong(*subgraph.engine)
+                         : Py_NewRef(Py_None);
+  PyObject* dependencies = ToList(subgraph.dependencies);
+  PyObject* levels = ToList(subgraph.retention_levels);
+  PyObject* dict = nullptr;
+  if (ops != nullptr && retain != nullptr && traversal != nullptr &&
+      engine != nullptr && dependencies != nullptr && levels != nullptr) {
+    dict = Py_BuildValue(
+        "{sOsOs(LLL)sOsdsOsOsO}", "ops", ops, "tensors_to_retain", retain,
+        "granularity", static_cast<long long>(granularity.width),
+        static_cast<long long>(granularity.height),
+        static_cast<long long>(granularity.depth), "traversal_order",
+        traversal, "subgraph_latency", subgraph.subgraph_latency, "engine",
+        engine, "dependencies", dependencies, "retention_levels", levels);
+  }
+  Py_XDECREF(ops);
+  Py_XDECREF(retain);
+  Py_XDECREF(traversal);
+  Py_XDECREF(engine);
+  Py_XDECREF(dependencies);
+  Py_XDECREF(levels);
+  return dict;
+}
+
+// Reads a subgraph from a mapping shaped like SubgraphToDict()'s result;
+// traversal_order, subgraph_latency, engine, dependencies and
+// retention_levels (0 for fast memory, 1 for middle memory) are optional.
+bool SubgraphFromDict(PyObject* dict, Subgraph* subgraph) {
+  const auto field = [dict](const char* key) {
+    return PyMapping_HasKeyString(dict, key)
+               ? PyMapping_GetItemString(dict, key)
+               : nullptr;
+  };
+  PyObject* ops = field("ops");
+  PyObject* retain = field("tensors_to_retain");
+  PyObject* granularity = field("granularity");
+  PyObject* traversal = field("traversal_order");
+  PyObject* latency = field("subgraph_latency");
+  PyObject* engine = field("engine");
+  PyObject* dependencies = field("dependencies");
+  PyObject* levels = field("retention_levels");
+  bool ok = false;
+  std::vector<int64_t> sizes;
+  if (ops == nullptr || retain == nullptr || granularity == nullptr) {
+    PyErr_SetString(PyExc_KeyError,
+                    "A subgraph needs ops, tensors_to_retain and granularity");
+  } else if (FromSequence(ops, &subgraph->ops) &&
+             FromSequence(retain, &subgraph->tensors_to_retain) &&
+             FromSequence(granularity, &sizes)) {
+    ok = true;
+    if (sizes.size() != 3) {
+      PyErr_SetString(PyExc_ValueError, "granularity is [width, height, k]");
+      ok = false;
+    } else {
+      subgraph->granularity = {sizes[0], sizes[1], sizes[2]};
+    }
+    if (ok && traversal != nullptr && traversal != Py_None) {
+      subgraph->traversal_order.emplace();
+      ok = FromSequence(traversal, &*subgraph->traversal_order);
+    }
+    if (ok && latency != nullptr) {
+      subgraph->subgraph_latency = PyFloat_AsDouble(latency);
+      ok = !PyErr_Occurred();
+    }
+    if (ok && engine != nullptr && engine != Py_None) {
+      subgraph->engine = PyLong_AsLongLong(engine);
+      ok = !PyErr_Occurred();
+    }
+    if (ok && dependencies != nullptr) {
+      ok = FromSequence(dependencies, &subgraph->dependencies);
+    }
+    if (ok && levels != nullptr) {
+      std::vector<int64_t> values;
+      ok = FromSequence(levels, &values);
+      for (size_t i = 0; ok && i < values.size(); ++i) {
+        if (values[i] > static_cast<int64_t>(MemoryLevel::kMiddle)) {
+          PyErr_SetString(PyExc_ValueError, "Unknown retention level");
+          ok = false;
+        } else {
+          subgraph->retention_levels.push_back(
+              static_cast<MemoryLevel>(values[i]));
+        }
+      }
+    }
+  }
+  Py_XDECREF(ops);
+  Py_XDECREF(retain);
+  Py_XDECREF(granularity);
+  Py_XDECREF(traversal);
+  Py_XDECREF(latency);
+  Py_XDECREF(engine);
+  Py_XDECREF(dependencies);
+  Py_XDECREF(levels);
+  return ok;
+}
+
+// Solution(subgraphs): builds a solution from a sequence of dicts, without
+// going through JSON.
+PyObject* SolutionNew(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+  static const char* keywords[] = {"subgraphs", nullptr};
+  PyObject* subgraphs;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O",
+                                   const_cast<char**>(keywords), &subgraphs)) {
+    return nullptr;
+  }
+  const Py_ssize_t size = PySequence_Size(subgraphs);
+  if (size < 0) return nullptr;
+  Solution solution;
+  solution.subgraphs.resize(size);
+  for (Py_ssize_t i = 0; i < size; ++i) {
+    PyObject* dict = PySequence_GetItem(subgraphs, i);
+    if (dict == nullptr) return nullptr;
+    const bool ok = SubgraphFromDict(dict, &solution.subgraphs[i]);
+    Py_DECREF(dict);
+    if (!ok) return nullptr;
+  }
+  return NewSolution(type, std::move(solution));
+}
+
+PyObject* SolutionNumSubgraphs(PyObject* self, void*) {
+  return PyLong_FromSize_t(GetSolution(self).subgraphs.size());
+}
+
+PyObject* SolutionSubgraphs(PyObject* self, void*) {
+  const std::vector<Subgraph>& subgraphs = GetSolution(self).subgraphs;
+  PyObject* list = PyList_New(subgraphs.size());
+  if (list == nullptr) return nullptr;
+  for (size_t i = 0; i < subgraphs.size(); ++i) {
+    PyObject* dict = SubgraphToDict(subgraphs[i]);
+    if (dict == nullptr) {
+      Py_DECREF(list);
+      return nullptr;
+    }
+    PyList_SetItem(list, i, dict);
+  }
+  return list;
+}
+
+PyObject* SolutionLatencies(PyObject* self, void*) {
+  const std::vector<double>& latencies = Impl<SolutionData>(self).latencies;
+  return NewArray(self, latencies.data(), latencies.size());
+}
+
+PyObject* SolutionToJson(PyObject* self, PyObject*) {
+  const std::string json = SolutionToJson(GetSolution(self));
+  return PyUnicode_FromStringAndSize(json.data(), json.size());
+}
+
+PyGetSetDef solution_getset[] = {
+    {"num_subgraphs", SolutionNumSubgraphs, nullptr, nullptr, nullptr},
+    {"subgraphs", SolutionSubgraphs, nullptr,
+     "The subgraphs as a list of dicts, as accepted by Solution()", nullptr},
+    {"subgraph_latencies", SolutionLatencies, nullptr,
+     "float64 array of the latencies as given, one per subgraph", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyMethodDef solution_methods[] = {
+    {"to_json", SolutionToJson, METH_NOARGS, "The solution in JSON."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyType_Slot solution_slots[] = {
+    {Py_tp_doc,
+     const_cast<char*>("Solution(subgraphs): a solution; see also "
+                       "ReadSolution().")},
+    {Py_tp_new, reinterpret_cast<void*>(SolutionNew)},
+    {Py_tp_dealloc, reinterpret_cast<void*>(Deallocate<SolutionData>)},
+    {Py_tp_getset, solution_getset},
+    {Py_tp_methods, solution_methods},
+    {0, nullptr},
+};
+
+PyType_Spec solution_spec = {"mlsys.Solution", sizeof(Object<SolutionData>),
+                             0,
+                             Py_TPFLAGS_DEFAULT, solution_slots};
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Module functions.                                           /////////
+////////////////////////////////////////////////////////////////////////////////
+
+// Parses the single string argument of a module function.
+std::optional<std::string> StringArgument(PyObject* args) {
+  const char* data;
+  Py_ssize_t size;
+  if (!PyArg_ParseTuple(args, "s#", &data, &size)) return std::nullopt;
+  return std::string(data, size);
+}
+
+PyObject* PyReadProblem(PyObject*, PyObject* args) {
+  const std::optional<std::string> filename = StringArgument(args);
+  if (!filename.has_value()) return nullptr;
+  return NewProblem(ReadProblem(*filename));
+}
+
+PyObject* PyParseProblem(PyObject*, PyObject* args) {
+  const std::optional<std::string> json = StringArgument(args);
+  if (!json.has_value()) return nullptr;
+  return NewProblem(ParseProblem(*json));
+}
+
+PyObject* PyReadSolution(PyObject*, PyObject* args) {
+  const std::optional<std::string> filename = StringArgument(args);
+  if (!filename.has_value()) return nullptr;
+  return NewSolution(solution_type, ReadSolution(*filename));
+}
+
+PyObject* PyParseSolution(PyObject*, PyObject* args) {
+  const std::optional<std::string> json = StringArgument(args);
+  if (!json.has_value()) return nullptr;
+  return NewSolution(solution_type, ParseSolution(*json));
+}
+
+PyObject* PyEvaluate(PyObject*, PyObject* args) {
+  PyObject* problem;
+  PyObject* solution;
+  if (!PyArg_ParseTuple(args, "O!O!", problem_type, &problem, solution_type,
+                        &solution)) {
+    return nullptr;
+  }
+  // The shared pointers keep both alive whatever Python does meanwhile.
+  const std::shared_ptr<const Problem> shared_problem =
+      Impl<ProblemData>(problem).problem;
+  const std::shared_ptr<const Solution> shared_solution =
+      Impl<SolutionData>(solution).solution;
+  absl::StatusOr<TotalLatency> latency;
+  Py_BEGIN_ALLOW_THREADS
+  latency = Replayer(*shared_problem).Evaluate(*shared_solution);
+  Py_END_ALLOW_THREADS
+  if (!latency.ok()) return RaiseStatus(latency.status());
+  return PyFloat_FromDouble(*latency);
+}
+
+PyObject* PyEvaluateBatch(PyObject*, PyObject* args, PyObject* kwargs) {
+  static const char* keywords[] = {"problem", "solutions", "bound", nullptr};
+  PyObject* problem;
+  PyObject* solutions;
+  double bound = std::numeric_limits<double>::infinity();
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O|d",
+                                   const_cast<char**>(keywords), problem_type,
+                                   &problem, &solutions, &bound)) {
+    return nullptr;
+  }
+  const std::shared_ptr<const Problem> shared_problem =
+      Impl<ProblemData>(problem).problem;
+  const Py_ssize_t size = PySequence_Size(solutions);
+  if (size < 0) return nullptr;
+  std::vector<std::shared_ptr<const Solution>> batch;
+  for (Py_ssize_t i = 0; i < size; ++i) {
+    PyObject* solution = PySequence_GetItem(solutions, i);
+    if (solution == nullptr) return nullptr;
+    const bool ok = PyObject_TypeCheck(solution, solution_type);
+    if (ok) {
+      batch.push_back(Impl<SolutionData>(solution).solution);
+    }
+    Py_DECREF(solution);
+    if (!ok) {
+      PyErr_SetString(PyExc_TypeError, "Expected a sequence of Solutions");
+      return nullptr;
+    }
+  }
+
+  // Invalid solutions come out as NaN, and solutions beyond the bound as
+  // infinity, so that the result is a plain float per solution.
+  std::vector<double> latencies(batch.size());
+  Py_BEGIN_ALLOW_THREADS
+  Replayer replayer(*shared_problem);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    const absl::StatusOr<TotalLatency> latency =
+        replayer.EvaluateBounded(*batch[i], bound);
+    if (!latency.ok()) {
+      latencies[i] = std::numeric_limits<double>::quiet_NaN();
+    } else if (*latency > bound) {
+      latencies[i] = std::numeric_limits<double>::infinity();
+    } else {
+      latencies[i] = *latency;
+    }
+  }
+  Py_END_ALLOW_THREADS
+
+  PyObject* list = PyList_New(latencies.size());
+  if (list == nullptr) return nullptr;
+  for (size_t i = 0; i < latencies.size(); ++i) {
+    PyObject* value = PyFloat_FromDouble(latencies[i]);
+    if (value == nullptr) {
+      Py_DECREF(list);
+      return nullptr;
+    }
+    PyList_SetItem(list, i, value);
+  }
+  return list;
+}
+
+PyMethodDef module_methods[] = {
+    {"ReadProblem", PyReadProblem, METH_VARARGS,
+     "ReadProblem(filename) -> Problem"},
+    {"ParseProblem", PyParseProblem, METH_VARARGS,
+     "ParseProblem(json) -> Problem"},
+    {"ReadSolution", PyReadSolution, METH_VARARGS,
+     "ReadSolution(filename) -> Solution"},
+    {"ParseSolution", PyParseSolution, METH_VARARGS,
+     "ParseSolution(json) -> Solution"},
+    {"Evaluate", PyEvaluate, METH_VARARGS,
+     "Evaluate(problem, solution) -> float\n\n"
+     "Raises ValueError if the solution is invalid."},
+    // Through void(*)(): METH_KEYWORDS functions take a third argument.
+    {"EvaluateBatch",
+     reinterpret_cast<PyCFunction>(
+         reinterpret_cast<void (*)()>(PyEvaluateBatch)),
+     METH_VARARGS | METH_KEYWORDS,
+     "EvaluateBatch(problem, solutions, bound=inf) -> list of float\n\n"
+     "Evaluates every solution with the GIL released.  Invalid solutions\n"
+     "yield NaN.  Evaluation of a solution stops once its latency exceeds\n"
+     "`bound`, yielding inf."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyModuleDef module_def = {
+    PyModuleDef_HEAD_INIT,
+    "mlsys",
+    "Problems, solutions and the latency model of the MLSys 2026 contest.",
+    -1,
+    module_methods,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+};
+
+}  // namespace
+}  // namespace mlsys
+
+PyMODINIT_FUNC PyInit_mlsys() {
+  using namespace mlsys;  // NOLINT: Only to reach the anonymous namespace.
+  PyObject* module = PyModule_Create(&module_def);
+  if (module == nullptr) return nullptr;
+  const struct {
+    PyTypeObject** type;
+    PyType_Spec* spec;
+    const char* name;
+  } types[] = {{&array_type, &array_spec, "Array"},
+               {&problem_type, &problem_spec, "Problem"},
+               {&solution_type, &solution_spec, "Solution"}};
+  for (const auto& [type, spec, name] : types) {
+    *type = reinterpret_cast<PyTypeObject*>(PyType_FromSpec(spec));
+    if (*type == nullptr ||
+        PyModule_AddObjectRef(module, name,
+                              reinterpret_cast<PyObject*>(*type)) < 0) {
+      Py_DECREF(module);
+      return nullptr;
+    }
+  }
+  return module;
+}
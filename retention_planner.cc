@@ -0,0 +1,275 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "retention_planner.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "mlsys.h"
+#include "roofline.h"
+#include "third_party/absl/status/statusor.h"
+
+namespace mlsys {
+
+namespace {
+
+// A tensor that can bypass slow memory by staying in middle memory over
+// positions [first, last] of its engine's subgraphs.
+struct Candidate {
+  size_t tensor;
+  int64_t engine;
+  size_t first;
+  size_t last;
+  int64_t bytes;
+  int64_t saved;  // Slow memory traffic avoided, in bytes.
+};
+
+Solution WithoutMiddleRetention(const Solution& solution) {
+  Solution stripped = solution;
+  for (Subgraph& subgraph : stripped.subgraphs) {
+    std::vector<size_t> retain;
+    for (size_t i = 0; i < subgraph.tensors_to_retain.size(); ++i) {
+      if (RetentionLevel(subgraph, i) == MemoryLevel::kFast) {
+        retain.push_back(subgraph.tensors_to_retain[i]);
+      }
+    }
+    subgraph.tensors_to_retain = std::move(retain);
+    subgraph.retention_levels.clear();
+  }
+  return stripped;
+}
+
+}  // namespace
+
+absl::StatusOr<Solution> PlanMiddleRetention(const Problem& problem,
+                                             const Solution& solution,
+                                             const EvaluateOptions& options) {
+  Replayer replayer(problem, options);
+  const absl::StatusOr<TotalLatency> original = replayer.Evaluate(solution);
+  if (!original.ok()) return original.status();
+  if (!HasMiddleMemory(problem)) return solution;
+
+  Solution planned = WithoutMiddleRetention(solution);
+  const size_t num_subgraphs = planned.subgraphs.size();
+  const size_t num_tensors = problem.tensors.size();
+  const int num_engines = std::max(options.num_engines, 1);
+
+  // Walk every engine's subgraphs in order, noting per tensor the subgraph
+  // storing it to slow memory and those loading it from there.  Tensors
+  // retained in fast memory anywhere are left alone.
+  std::vector<std::vector<size_t>> sequence(num_engines);
+  std::vector<size_t> position(num_subgraphs);
+  std::vector<int64_t> storer(num_tensors, -1);
+  std::vector<std::vector<size_t>> loaders(num_tensors);
+  std::vector<char> pinned(num_tensors, 0);
+  std::vector<int64_t> produced_in(num_tensors, -1);
+  std::vector<int64_t> consumed_in(num_tensors, -1);
+  std::vector<int64_t> held_for(num_tensors, -1);
+  std::vector<int64_t> previous(num_engines, -1);
+  for (size_t index = 0; index < num_subgraphs; ++index) {
+    const Subgraph& subgraph = planned.subgraphs[index];
+    const int64_t engine = subgraph.engine.value_or(0);
+    const int64_t current = index;
+    position[index] = sequence[engine].size();
+    sequence[engine].push_back(index);
+    if (previous[engine] >= 0) {
+      for (size_t tensor :
+           planned.subgraphs[previous[engine]].tensors_to_retain) {
+        held_for[tensor] = current;
+      }
+    }
+    previous[engine] = current;
+    for (size_t tensor : subgraph.tensors_to_retain) pinned[tensor] = 1;
+    for (size_t op : subgraph.ops) {
+      for (size_t tensor : problem.ops[op].outputs) {
+        produced_in[tensor] = current;
+      }
+      for (size_t tensor : problem.ops[op].inputs) {
+        consumed_in[tensor] = current;
+      }
+    }
+    for (size_t op : subgraph.ops) {
+      for (size_t tensor : problem.ops[op].inputs) {
+        if (produced_in[tensor] == current || held_for[tensor] == current ||
+            (!loaders[tensor].empty() && loaders[tensor].back() == index)) {
+          continue;
+        }
+        loaders[tensor].push_back(index);
+      }
+      for (size_t tensor : problem.ops[op].outputs) {
+        if (consumed_in[tensor] != current) {
+          storer[tensor] = index;
+        }
+      }
+    }
+  }
+
+  std::vector<Candidate> candidates;
+  for (size_t tensor = 0; tensor < num_tensors; ++tensor) {
+    const std::vector<size_t>& loads = loaders[tensor];
+    const bool input = replayer.IsGraphInput(tensor);
+    if (pinned[tensor] || loads.size() < (input ? 2 : 1) ||
+        (!input && storer[tensor] < 0)) {
+      continue;
+    }
+    const size_t first = input ? loads.front() : storer[tensor];
+    const int64_t engine = planned.subgraphs[first].engine.value_or(0);
+    if (!std::all_of(loads.begin(), loads.end(), [&](size_t index) {
+          return planned.subgraphs[index].engine.value_or(0) == engine;
+        })) {
+      continue;
+    }
+    const Tensor& shape = problem.tensors[tensor];
+    const int64_t bytes = shape.width * shape.height * shape.element_bytes;
+    const int64_t transfers = input ? loads.size() - 1 : loads.size() + 1;
+    candidates.push_back({tensor, engine, position[first],
+                          position[loads.back()], bytes, bytes * transfers});
+  }
+  const auto density = [](const Candidate& candidate) {
+    return static_cast<double>(candidate.saved) /
+           (static_cast<double>(candidate.bytes) *
+            (candidate.last - candidate.first + 1));
+  };
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [&](const Candidate& a, const Candidate& b) {
+                     return density(a) > density(b);
+                   });
+
+  // Middle memory in use at each position of each engine.
+  const int64_t capacity = *problem.middle_memory_capacity / num_engines;
+  std::vector<std::vector<int64_t>> usage(num_engines);
+  for (int engine = 0; engine < num_engines; ++engine) {
+    usage[engine].assign(sequence[engine].size(), 0);
+  }
+  for (const Candidate& candidate : candidates) {
+    std::vector<int64_t>& used = usage[candidate.engine];
+    if (std::any_of(used.begin() + candidate.first,
+                    used.begin() + candidate.last + 1, [&](int64_t bytes) {
+                      return bytes + candidate.bytes > capacity;
+                    })) {
+      continue;
+    }
+    for (size_t i = candidate.first; i <= candidate.last; ++i) {
+      used[i] += candidate.bytes;
+      if (i == candidate.last) continue;
+      Subgraph& subgraph =
+          planned.subgraphs[sequence[candidate.engine][i]];
+      subgraph.retention_levels.resize(subgraph.tensors_to_retain.size(),
+                                       MemoryLevel::kFast);
+      subgraph.tensors_to_retain.push_back(candidate.tensor);
+      subgraph.retention_levels.push_back(MemoryLevel::kMiddle);
+    }
+  }
+
+  const absl::StatusOr<TotalLatency> latency = replayer.Evaluate(planned);
+  if (!latency.ok() || *latency >= *original) return solution;
+  const absl::StatusOr<std::vector<SubgraphLatency>> latencies =
+      replayer.SubgraphLatencies(planned);
+  if (!latencies.ok()) return latencies.status();
+  for (size_t index = 0; index < num_subgraphs; ++index) {
+    planned.subgraphs[index].subgraph_latency = (*latencies)[index];
+  }
+  return planned;
+}
+
+absl::StatusOr<Solution> PlanResidentInputs(const Problem& problem,
+                                            const Solution& solution,
+                                            const EvaluateOptions& options) {
+  Replayer replayer(problem, options);
+  std::vector<int64_t> loaded(problem.tensors.size(), 0);
+  TotalLatency best = 0.0;
+  if (absl::Status status = replayer.Replay(
+          solution,
+          [&](const Step& step) {
+            best += step.latency;
+            for (const Transfer& load : step.loads) {
+              if (!load.middle) {
+                loaded[load.tensor] += TransferBytes(problem, load);
+              }
+            }
+          });
+      !status.ok()) {
+    return status;
+  }
+  if (!options.repeated) return solution;
+  if (options.num_engines > 1) {
+    const absl::StatusOr<TotalLatency> makespan = replayer.Evaluate(solution);
+    if (!makespan.ok()) return makespan.status();
+    best = *makespan;
+  }
+
+  // By bytes loaded per byte held.
+  std::vector<std::pair<double, size_t>> candidates;
+  for (size_t tensor = 0; tensor < problem.tensors.size(); ++tensor) {
+    const Tensor& shape = problem.tensors[tensor];
+    const int64_t bytes = shape.width * shape.height * shape.element_bytes;
+    if (!replayer.IsWeight(tensor) || loaded[tensor] == 0 ||
+        bytes > replayer.capacity()) {
+      continue;
+    }
+    candidates.emplace_back(static_cast<double>(loaded[tensor]) / bytes,
+                            tensor);
+  }
+  std::stable_sort(
+      candidates.begin(), candidates.end(),
+      [](const auto& a, const auto& b) { return a.first > b.first; });
+
+  Solution planned = solution;
+  for (const auto& candidate : candidates) {
+    const size_t tensor = candidate.second;
+    // Every engine consuming the tensor holds its own copy.
+    std::vector<char> engines(std::max(options.num_engines, 1), 0);
+    for (const Subgraph& subgraph : planned.subgraphs) {
+      for (size_t op : subgraph.ops) {
+        const Inputs& inputs = problem.ops[op].inputs;
+        if (std::find(inputs.begin(), inputs.end(), tensor) != inputs.end()) {
+          engines[subgraph.engine.value_or(0)] = 1;
+        }
+      }
+    }
+    Solution trial = planned;
+    for (Subgraph& subgraph : trial.subgraphs) {
+      std::vector<size_t>& retain = subgraph.tensors_to_retain;
+      if (!engines[subgraph.engine.value_or(0)] ||
+          std::find(retain.begin(), retain.end(), tensor) != retain.end()) {
+        continue;
+      }
+      if (!subgraph.retention_levels.empty()) {
+        subgraph.retention_levels.push_back(MemoryLevel::kFast);
+      }
+      retain.push_back(tensor);
+    }
+    const absl::StatusOr<TotalLatency> latency = replayer.Evaluate(trial);
+    if (latency.ok() && *latency < best) {
+      best = *latency;
+      planned = std::move(trial);
+    }
+  }
+
+  const absl::StatusOr<std::vector<SubgraphLatency>> latencies =
+      replayer.SubgraphLatencies(planned);
+  if (!latencies.ok()) return latencies.status();
+  for (size_t index = 0; index < planned.subgraphs.size(); ++index) {
+    planned.subgraphs[index].subgraph_latency = (*latencies)[index];
+  }
+  return planned;
+}
+
+}  // namespace mlsys
@@ -0,0 +1,55 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_RETENTION_PLANNER_H_
+#define MLSYS_RETENTION_PLANNER_H_
+
+#include "mlsys.h"
+#include "third_party/absl/status/statusor.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Placement of long-lived tensors across subgraphs.           /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// Keeps tensors that `solution` sends through slow memory in middle memory
+// instead, when the problem has one.  A candidate is a result stored by one
+// subgraph and loaded back by later ones, or a graph input loaded by several,
+// all on one engine; it is retained in middle memory from the first of them
+// to the last.  Candidates are taken greedily by slow memory traffic saved
+// per byte and subgraph of middle memory held, as long as they fit.
+//
+// Any middle memory retention in `solution` is planned afresh.  The result
+// is never slower under Evaluate() with `options` than `solution`.
+absl::StatusOr<Solution> PlanMiddleRetention(const Problem& problem,
+                                             const Solution& solution,
+                                             const EvaluateOptions& options);
+
+// Under EvaluateOptions::repeated, keeps weights in fast memory for the
+// whole iteration, retained by every subgraph of each engine consuming them,
+// so that the steady state never loads them.  Candidates are taken greedily
+// by bytes loaded per byte held, each only if it lowers the latency.
+//
+// The result is never slower under Evaluate() with `options` than
+// `solution`, which it returns unchanged without `options.repeated`.
+absl::StatusOr<Solution> PlanResidentInputs(const Problem& problem,
+                                            const Solution& solution,
+                                            const EvaluateOptions& options);
+
+}  // namespace mlsys
+
+#endif  // MLSYS_RETENTION_PLANNER_H_
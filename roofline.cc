@@ -0,0 +1,862 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "roofline.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "mlsys.h"
+#include "third_party/absl/cleanup/cleanup.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/types/span.h"
+
+namespace mlsys {
+
+namespace {
+
+constexpr int32_t kOutside = -1;
+constexpr int32_t kUnvisited = -2;
+constexpr int32_t kVisiting = -3;
+
+int64_t CeilDiv(int64_t a, int64_t b) { return (a + b - 1) / b; }
+
+int64_t Bytes(const Tensor& tensor) {
+  return tensor.width * tensor.height * tensor.element_bytes;
+}
+
+}  // namespace
+
+Region Union(const Region& a, const Region& b) {
+  if (a.empty()) return b;
+  if (b.empty()) return a;
+  const int64_t row = std::min(a.row, b.row);
+  const int64_t col = std::min(a.col, b.col);
+  return {row, col,
+          std::max(a.row + a.height, b.row + b.height) - row,
+          std::max(a.col + a.width, b.col + b.width) - col};
+}
+
+Region Clip(int64_t row, int64_t height, int64_t col, int64_t width,
+            const Tensor& tensor) {
+  Region region;
+  if (tensor.height == 1) {
+    region.row = 0;
+    region.height = height > 0 ? 1 : 0;
+  } else {
+    region.row = std::max<int64_t>(row, 0);
+    region.height = std::min(row + height, tensor.height) - region.row;
+  }
+  if (tensor.width == 1) {
+    region.col = 0;
+    region.width = width > 0 ? 1 : 0;
+  } else {
+    region.col = std::max<int64_t>(col, 0);
+    region.width = std::min(col + width, tensor.width) - region.col;
+  }
+  if (region.empty()) return Region();
+  return region;
+}
+
+int64_t PaddedTiles(const Granularity& granularity,
+                    const Granularity& native) {
+  return CeilDiv(granularity.width, native.width) *
+         CeilDiv(granularity.height, native.height);
+}
+
+int64_t TransferBytes(const Problem& problem, const Transfer& transfer) {
+  return transfer.region.size() *
+         problem.tensors[transfer.tensor].element_bytes;
+}
+
+double PrefetchTime(const Problem& problem, int64_t prefetchable, double slack,
+                    int64_t free) {
+  const int64_t bytes = std::min(prefetchable, std::max<int64_t>(free, 0));
+  return std::min(slack, static_cast<double>(bytes) / ReadBandwidth(problem));
+}
+
+Replayer::Replayer(const Problem& problem, EvaluateOptions options)
+    : problem_(problem),
+      options_(options),
+      num_engines_(std::max(options.num_engines, 1)),
+      capacity_(problem.fast_memory_capacity / num_engines_),
+      middle_capacity_(problem.middle_memory_capacity.value_or(0) /
+                       num_engines_),
+      producer_(problem.tensors.size(), -1),
+      has_consumer_(problem.tensors.size(), 0),
+      weight_(problem.tensors.size(), 1),
+      op_position_(problem.ops.size(), kOutside),
+      tensor_slot_(problem.tensors.size(), -1) {
+  for (size_t op = 0; op < problem.ops.size(); ++op) {
+    for (size_t tensor : problem.ops[op].outputs) {
+      if (tensor < producer_.size()) producer_[tensor] = op;
+    }
+    const Inputs& inputs = problem.ops[op].inputs;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      if (inputs[i] >= has_consumer_.size()) continue;
+      has_consumer_[inputs[i]] = 1;
+      if (problem.ops[op].op_type != "MatMul" || i != 1) {
+        weight_[inputs[i]] = 0;
+      }
+    }
+  }
+  for (size_t tensor = 0; tensor < weight_.size(); ++tensor) {
+    weight_[tensor] &= producer_[tensor] < 0 && has_consumer_[tensor];
+  }
+}
+
+Replayer::LocalTensor& Replayer::Local(size_t tensor) {
+  int32_t& slot = tensor_slot_[tensor];
+  if (slot < 0) {
+    slot = locals_.size();
+    locals_.emplace_back().id = tensor;
+  }
+  return locals_[slot];
+}
+
+void Replayer::Reset() {
+  for (const LocalTensor& local : locals_) tensor_slot_[local.id] = -1;
+  for (size_t op : order_) op_position_[op] = kOutside;
+  locals_.clear();
+  order_.clear();
+}
+
+absl::Status Replayer::Prepare(size_t index, const Subgraph& subgraph,
+                               absl::Span<const size_t> resident,
+                               absl::Span<const size_t> middle_resident) {
+  const Granularity& granularity = subgraph.granularity;
+  if (granularity.width <= 0 || granularity.height <= 0 ||
+      granularity.depth <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Subgraph ", index, " has a non-positive granularity"));
+  }
+  if (subgraph.ops.empty()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Subgraph ", index, " has no ops"));
+  }
+  for (size_t op : subgraph.ops) {
+    if (op >= problem_.ops.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Subgraph ", index, " references unknown op ", op));
+    }
+    if (op_position_[op] != kOutside) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Subgraph ", index, " lists op ", op, " twice"));
+    }
+    op_position_[op] = kUnvisited;
+    // Registered right away so that Reset() can undo the marking on error.
+    order_.push_back(op);
+  }
+  for (size_t op : subgraph.ops) {
+    const Op& spec = problem_.ops[op];
+    if (absl::Status status = GetSliceRule(problem_, op).status();
+        !status.ok()) {
+      return status;
+    }
+    for (size_t tensor : spec.outputs) Local(tensor).produced = true;
+    for (size_t tensor : spec.inputs) Local(tensor).consumed = true;
+  }
+  for (size_t tensor : resident) {
+    if (tensor >= problem_.tensors.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown resident tensor ", tensor));
+    }
+    Local(tensor).resident = true;
+  }
+  for (size_t tensor : middle_resident) {
+    if (tensor >= problem_.tensors.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown resident tensor ", tensor));
+    }
+    LocalTensor& local = Local(tensor);
+    local.middle_resident = true;
+    local.in_middle = true;
+  }
+  if (!subgraph.retention_levels.empty() &&
+      subgraph.retention_levels.size() != subgraph.tensors_to_retain.size()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Subgraph ", index, " has ", subgraph.retention_levels.size(),
+        " retention levels for ", subgraph.tensors_to_retain.size(),
+        " tensors to retain"));
+  }
+  for (size_t i = 0; i < subgraph.tensors_to_retain.size(); ++i) {
+    const size_t tensor = subgraph.tensors_to_retain[i];
+    if (tensor >= problem_.tensors.size() || tensor_slot_[tensor] < 0) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Subgraph ", index, " retains tensor ", tensor,
+                       ", which it neither loads nor produces"));
+    }
+    LocalTensor& local = locals_[tensor_slot_[tensor]];
+    if (RetentionLevel(subgraph, i) == MemoryLevel::kMiddle) {
+      if (!HasMiddleMemory(problem_)) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Subgraph ", index, " retains tensor ", tensor,
+                         " in middle memory, which the problem lacks"));
+      }
+      // Besides what the subgraph loads or produces, middle memory may keep
+      // what it already holds, but not take over a fast memory tensor.
+      if (local.retained || (local.produced && local.consumed) ||
+          (!local.middle_resident &&
+           (local.resident || (!local.produced && !local.consumed)))) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Subgraph ", index, " cannot retain tensor ", tensor,
+            " in middle memory"));
+      }
+      local.middle_retained = true;
+      continue;
+    }
+    if (local.middle_retained) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Subgraph ", index, " retains tensor ", tensor,
+                       " in both fast and middle memory"));
+    }
+    // Running repeatedly, fast memory may also keep a weight the subgraph
+    // does not touch, so that it stays resident all the way round.
+    const bool kept = options_.repeated && local.resident &&
+                      IsWeight(tensor) && !local.consumed;
+    if (local.produced == local.consumed && !kept) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Subgraph ", index, " retains tensor ", tensor,
+          local.produced ? ", which is ephemeral inside it"
+                         : ", which it neither loads nor produces"));
+    }
+    local.retained = true;
+  }
+
+  // Topological order of the ops by an iterative depth-first search over the
+  // producers that belong to the subgraph.
+  std::vector<size_t> listed = std::move(order_);
+  order_.clear();
+  std::vector<std::pair<size_t, size_t>> stack;
+  for (size_t root : listed) {
+    if (op_position_[root] != kUnvisited) continue;
+    op_position_[root] = kVisiting;
+    stack.push_back({root, 0});
+    while (!stack.empty()) {
+      auto& [op, next_input] = stack.back();
+      const Inputs& inputs = problem_.ops[op].inputs;
+      if (next_input < inputs.size()) {
+        const int64_t producer = producer_[inputs[next_input++]];
+        if (producer < 0) continue;
+        if (op_position_[producer] == kVisiting) {
+          order_ = std::move(listed);
+          return absl::InvalidArgumentError(
+              absl::StrCat("Subgraph ", index, " contains a cycle"));
+        }
+        if (op_position_[producer] == kUnvisited) {
+          op_position_[producer] = kVisiting;
+          stack.push_back({static_cast<size_t>(producer), 0});
+        }
+        continue;
+      }
+      op_position_[op] = order_.size();
+      order_.push_back(op);
+      stack.pop_back();
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Replayer::ReplaySubgraphImpl(
+    size_t index, const Subgraph& subgraph, absl::Span<const size_t> resident,
+    absl::Span<const size_t> middle_resident,
+    std::vector<char>* in_slow_memory, Handoff* handoff,
+    StepVisitor visitor) {
+  absl::Cleanup reset = [this] { Reset(); };
+  if (absl::Status status = Prepare(index, subgraph, resident,
+                                    middle_resident);
+      !status.ok()) {
+    return status;
+  }
+  const Granularity& granularity = subgraph.granularity;
+
+  // A reduction is split into `k` slices only for MatMuls and Reductions
+  // whose result feeds the output grid directly or through Pointwise and
+  // Transpose ops (output-stationary accumulation).  Those feeding another
+  // reducing op compute their full reduction for whatever slice the consumer
+  // asks for.
+  split_.assign(order_.size(), 0);
+  rule_.resize(order_.size());
+  std::vector<char> split_demand(locals_.size(), 0);
+  int64_t num_k_steps = 1;
+  for (size_t position = order_.size(); position-- > 0;) {
+    const Op& op = problem_.ops[order_[position]];
+    rule_[position] = *GetSliceRule(problem_, order_[position]);
+    bool split = false;
+    for (size_t tensor : op.outputs) {
+      const int32_t slot = tensor_slot_[tensor];
+      split |= !locals_[slot].consumed || split_demand[slot];
+    }
+    split_[position] = split;
+    if (!split) continue;
+    if (const Depth reduction = ReductionDepth(problem_, op); reduction > 0) {
+      num_k_steps =
+          std::max(num_k_steps, CeilDiv(reduction, granularity.depth));
+    } else {
+      for (size_t tensor : op.inputs) split_demand[tensor_slot_[tensor]] = 1;
+    }
+  }
+
+  // The output grid spans the largest boundary output.
+  Width grid_width = 1;
+  Height grid_height = 1;
+  int64_t resident_size = 0;
+  int64_t middle_size = 0;
+  for (LocalTensor& local : locals_) {
+    const Tensor& tensor = problem_.tensors[local.id];
+    local.element_bytes = tensor.element_bytes;
+    local.held_bytes = tensor.element_bytes;
+    if (local.produced && problem_.accumulator_bytes.has_value() &&
+        ReductionDepth(problem_, problem_.ops[producer_[local.id]]) > 0) {
+      local.held_bytes = *problem_.accumulator_bytes;
+    }
+    if (local.produced && !local.consumed) {
+      grid_width = std::max(grid_width, tensor.width);
+      grid_height = std::max(grid_height, tensor.height);
+    }
+    if (local.middle_resident || local.middle_retained) {
+      middle_size += Bytes(tensor);
+    }
+    if (local.resident || local.retained) {
+      resident_size += Bytes(tensor);
+    } else if (!local.produced && !local.middle_resident &&
+               in_slow_memory != nullptr && !(*in_slow_memory)[local.id]) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Subgraph ", index, " needs tensor ", local.id,
+                       ", which is in neither fast nor slow memory"));
+    }
+  }
+  if (middle_size > middle_capacity_) {
+    return absl::ResourceExhaustedError(absl::StrCat(
+        "Subgraph ", index, " keeps ", middle_size,
+        " bytes in middle memory; capacity is ", middle_capacity_));
+  }
+  const int64_t grid_cols = CeilDiv(grid_width, granularity.width);
+  const int64_t grid_rows = CeilDiv(grid_height, granularity.height);
+  const int64_t num_tiles = grid_cols * grid_rows;
+
+  const std::optional<TraversalOrder>& traversal = subgraph.traversal_order;
+  if (traversal.has_value()) {
+    if (static_cast<int64_t>(traversal->size()) != num_tiles) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Subgraph ", index, " traversal order has ", traversal->size(),
+          " entries for ", num_tiles, " tiles"));
+    }
+    std::vector<char> seen(num_tiles, 0);
+    for (int64_t tile : *traversal) {
+      if (tile < 0 || tile >= num_tiles || seen[tile]) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Subgraph ", index, " traversal order is not a permutation"));
+      }
+      seen[tile] = 1;
+    }
+  }
+
+  // Every op pays its base cost per native tile of its type covered by the
+  // granularity, spread evenly across the reduction steps.
+  double compute_per_tile = 0.0;
+  for (size_t op : order_) {
+    const Op& spec = problem_.ops[op];
+    compute_per_tile +=
+        spec.base_cost *
+        PaddedTiles(granularity, NativeGranularity(problem_, spec.op_type));
+  }
+  const double read_bandwidth = ReadBandwidth(problem_);
+  const double write_bandwidth = WriteBandwidth(problem_);
+  const bool has_middle = HasMiddleMemory(problem_);
+  const double middle_bandwidth =
+      problem_.middle_memory_bandwidth.value_or(1);
+  const double setup = problem_.dma_setup_latency.value_or(0.0);
+
+  Step& step = step_;
+  step.subgraph = index;
+  step.num_tiles = num_tiles;
+  step.num_k_steps = num_k_steps;
+  step.compute_time = compute_per_tile / num_k_steps;
+  for (int64_t position = 0; position < num_tiles; ++position) {
+    const int64_t tile = traversal ? (*traversal)[position] : position;
+    const int64_t tile_row = tile / grid_cols;
+    const int64_t tile_col = tile % grid_cols;
+    step.tile = tile;
+    step.position = position;
+    step.output = {tile_row * granularity.height,
+                   tile_col * granularity.width, granularity.height,
+                   granularity.width};
+    step.valid = step.output;
+    step.valid.height = std::min(step.output.height,
+                                 grid_height - step.output.row);
+    step.valid.width = std::min(step.output.width,
+                                grid_width - step.output.col);
+    for (int64_t k_step = 0; k_step < num_k_steps; ++k_step) {
+      step.k_step = k_step;
+      step.loads.clear();
+      step.stores.clear();
+      step.stages.clear();
+
+      // Propagate the slices each op needs from the outputs back to the
+      // boundary inputs.
+      for (LocalTensor& local : locals_) {
+        local.need = Region();
+        if (local.produced && !local.consumed) {
+          local.need = Clip(step.output.row, step.output.height,
+                            step.output.col, step.output.width,
+                            problem_.tensors[local.id]);
+        }
+      }
+      for (size_t position_in_order = order_.size();
+           position_in_order-- > 0;) {
+        const Op& op = problem_.ops[order_[position_in_order]];
+        Region out;
+        for (size_t tensor : op.outputs) {
+          out = Union(out, locals_[tensor_slot_[tensor]].need);
+        }
+        if (out.empty()) continue;
+        const SliceRule rule = rule_[position_in_order];
+        if (rule == SliceRule::kPointwise) {
+          for (size_t tensor : op.inputs) {
+            LocalTensor& input = locals_[tensor_slot_[tensor]];
+            input.need = Union(input.need,
+                               Clip(out.row, out.height, out.col, out.width,
+                                    problem_.tensors[tensor]));
+          }
+          continue;
+        }
+        const Tensor& lhs = problem_.tensors[op.inputs[0]];
+        LocalTensor& left = locals_[tensor_slot_[op.inputs[0]]];
+        if (rule == SliceRule::kTranspose) {
+          left.need = Union(left.need,
+                            Clip(out.col, out.width, out.row, out.height, lhs));
+          continue;
+        }
+        const int64_t reduction = ReductionDepth(problem_, op);
+        int64_t k_begin = 0;
+        int64_t k_size = reduction;
+        if (split_[position_in_order]) {
+          k_begin = k_step * granularity.depth;
+          k_size = std::min(granularity.depth, reduction - k_begin);
+          if (k_size <= 0) continue;
+        }
+        if (rule == SliceRule::kRowReduction) {
+          left.need = Union(left.need,
+                            Clip(out.row, out.height, k_begin, k_size, lhs));
+        } else if (rule == SliceRule::kColumnReduction) {
+          left.need = Union(left.need,
+                            Clip(k_begin, k_size, out.col, out.width, lhs));
+        } else {
+          const Tensor& rhs = problem_.tensors[op.inputs[1]];
+          LocalTensor& right = locals_[tensor_slot_[op.inputs[1]]];
+          left.need = Union(left.need,
+                            Clip(out.row, out.height, k_begin, k_size, lhs));
+          right.need = Union(right.need,
+                             Clip(k_begin, k_size, out.col, out.width, rhs));
+        }
+      }
+
+      const bool last_k_step = k_step + 1 == num_k_steps;
+      const bool reuse = k_step > 0 || traversal.has_value();
+      int64_t working_set = resident_size;
+      int64_t loaded = 0;  // Over the slow memory link.
+      int64_t stored = 0;
+      int64_t linked = 0;  // Over the middle memory link.
+      int64_t loads = 0;  // Transfers from and to slow memory.
+      int64_t stores = 0;
+      const auto load = [&](LocalTensor& local, const Region& region) {
+        const int64_t bytes = region.size() * local.element_bytes;
+        if (!local.in_middle && local.middle_retained) {
+          // An input kept in middle memory is staged whole first.
+          const Region whole = {0, 0, problem_.tensors[local.id].height,
+                                problem_.tensors[local.id].width};
+          step.stages.push_back({local.id, whole, true});
+          loaded += whole.size() * local.element_bytes;
+          ++loads;
+          local.in_middle = true;
+        }
+        step.loads.push_back({local.id, region, local.in_middle});
+        if (!local.in_middle) {
+          loaded += bytes;
+          ++loads;
+        }
+        if (has_middle) linked += bytes;
+      };
+      for (LocalTensor& local : locals_) {
+        if (local.resident) continue;
+        const Tensor& tensor = problem_.tensors[local.id];
+        if (!local.produced) {
+          if (local.retained) {
+            // A retained input is brought in whole the first time any of it
+            // is needed and stays until the subgraph ends.
+            if (!local.need.empty() && local.previous.empty()) {
+              local.previous = {0, 0, tensor.height, tensor.width};
+              load(local, local.previous);
+            }
+            continue;
+          }
+          if (!local.need.empty() &&
+              !(reuse && local.need == local.previous)) {
+            load(local, local.need);
+          }
+          local.previous = local.need;
+          working_set += local.need.size() * local.element_bytes;
+        } else if (!local.consumed && !local.retained) {
+          working_set += local.need.size() * local.held_bytes;
+          if (last_k_step && !local.need.empty()) {
+            const int64_t bytes = local.need.size() * local.element_bytes;
+            step.stores.push_back({local.id, local.need,
+                                   local.middle_retained});
+            if (!local.middle_retained) {
+              stored += bytes;
+              ++stores;
+            }
+            if (has_middle) linked += bytes;
+          }
+        }
+      }
+      if (working_set > capacity_) {
+        return absl::ResourceExhaustedError(absl::StrCat(
+            "Subgraph ", index, " needs ", working_set,
+            " bytes of fast memory at tile ", tile, ", step ", k_step,
+            "; capacity is ", capacity_));
+      }
+      step.working_set = working_set;
+      step.resident = resident_size;
+      step.prefetch_time = 0.0;
+      if (handoff != nullptr && index > 0 && position == 0 && k_step == 0) {
+        // Only the first step prefetches, from what the predecessor's last
+        // step leaves idle.
+        int64_t prefetchable = 0;
+        for (const Transfer& load : step.loads) {
+          if (!load.middle &&
+              handoff->writer[load.tensor] + 1 != static_cast<int64_t>(index)) {
+            prefetchable += TransferBytes(problem_, load);
+          }
+        }
+        step.prefetch_time = PrefetchTime(problem_, prefetchable,
+                                          handoff->slack, handoff->free);
+      }
+      step.memory_in_time =
+          loaded / read_bandwidth + loads * setup - step.prefetch_time;
+      step.memory_out_time = stored / write_bandwidth + stores * setup;
+      step.middle_time = linked / middle_bandwidth;
+      step.latency = std::max({step.compute_time,
+                               step.memory_in_time + step.memory_out_time,
+                               step.middle_time});
+      if (handoff != nullptr) {
+        handoff->slack = std::max(0.0, step.compute_time -
+                                           step.memory_in_time -
+                                           step.memory_out_time);
+        handoff->free = capacity_ - working_set;
+      }
+      visitor(step);
+    }
+  }
+
+  if (in_slow_memory != nullptr) {
+    for (const LocalTensor& local : locals_) {
+      if (local.produced && !local.consumed && !local.retained &&
+          !local.middle_retained) {
+        (*in_slow_memory)[local.id] = 1;
+        if (handoff != nullptr) handoff->writer[local.id] = index;
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Replayer::ReplaySubgraph(size_t index, const Subgraph& subgraph,
+                                      absl::Span<const size_t> resident,
+                                      StepVisitor visitor) {
+  return ReplaySubgraph(index, subgraph, resident, {}, visitor);
+}
+
+absl::Status Replayer::ReplaySubgraph(size_t index, const Subgraph& subgraph,
+                                      absl::Span<const size_t> resident,
+                                      absl::Span<const size_t> middle_resident,
+                                      StepVisitor visitor) {
+  return ReplaySubgraphImpl(index, subgraph, resident, middle_resident,
+                            nullptr, nullptr, visitor);
+}
+
+absl::StatusOr<SubgraphLatency> Replayer::SubgraphCost(
+    const Subgraph& subgraph, absl::Span<const size_t> resident,
+    absl::Span<const size_t> middle_resident) {
+  SubgraphLatency latency = 0.0;
+  if (absl::Status status =
+          ReplaySubgraph(0, subgraph, resident, middle_resident,
+                         [&](const Step& step) { latency += step.latency; });
+      !status.ok()) {
+    return status;
+  }
+  return latency;
+}
+
+absl::Status Replayer::Replay(const Solution& solution, StepVisitor visitor) {
+  return ReplayUntil(solution, visitor, [] { return false; });
+}
+
+absl::Status Replayer::ReplayUntil(const Solution& solution,
+                                   StepVisitor visitor,
+                                   absl::FunctionRef<bool()> stop) {
+  std::vector<char> in_slow_memory(problem_.tensors.size(), 0);
+  for (size_t tensor = 0; tensor < problem_.tensors.size(); ++tensor) {
+    in_slow_memory[tensor] = IsGraphInput(tensor);
+  }
+  std::vector<char> covered(problem_.ops.size(), 0);
+  std::optional<Handoff> handoff;
+  if (options_.overlap_prefetch && num_engines_ == 1) {
+    handoff.emplace();
+    handoff->writer.assign(problem_.tensors.size(), -1);
+  }
+  // Retained tensors pass to the next subgraph on the same engine.
+  std::vector<std::vector<size_t>> resident(num_engines_);
+  std::vector<std::vector<size_t>> middle_resident(num_engines_);
+  if (options_.repeated) {
+    // Each engine starts with what its last subgraph retains.
+    std::vector<char> wrapped(num_engines_, 0);
+    for (size_t index = solution.subgraphs.size(); index-- > 0;) {
+      const Subgraph& subgraph = solution.subgraphs[index];
+      const int64_t engine = subgraph.engine.value_or(0);
+      if (engine < 0 || engine >= num_engines_ || wrapped[engine]) continue;
+      wrapped[engine] = 1;
+      for (size_t i = 0; i < subgraph.tensors_to_retain.size(); ++i) {
+        const size_t tensor = subgraph.tensors_to_retain[i];
+        if (tensor >= problem_.tensors.size() || !IsWeight(tensor)) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "Subgraph ", index, " retains tensor ", tensor,
+              " into the next iteration, which is not a weight"));
+        }
+        (RetentionLevel(subgraph, i) == MemoryLevel::kMiddle
+             ? middle_resident[engine]
+             : resident[engine])
+            .push_back(tensor);
+      }
+    }
+  }
+  for (size_t index = 0; index < solution.subgraphs.size(); ++index) {
+    const Subgraph& subgraph = solution.subgraphs[index];
+    const int64_t engine = subgraph.engine.value_or(0);
+    if (engine < 0 || engine >= num_engines_) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Subgraph ", index, " runs on engine ", engine,
+                       " of ", num_engines_));
+    }
+    for (size_t dependency : subgraph.dependencies) {
+      if (dependency >= index) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Subgraph ", index, " depends on subgraph ",
+                         dependency, ", which does not precede it"));
+      }
+    }
+    if (absl::Status status = ReplaySubgraphImpl(
+            index, subgraph, resident[engine], middle_resident[engine],
+            &in_slow_memory, handoff.has_value() ? &*handoff : nullptr,
+            visitor);
+        !status.ok()) {
+      return status;
+    }
+    for (size_t op : subgraph.ops) covered[op] = 1;
+    resident[engine].clear();
+    middle_resident[engine].clear();
+    for (size_t i = 0; i < subgraph.tensors_to_retain.size(); ++i) {
+      (RetentionLevel(subgraph, i) == MemoryLevel::kMiddle
+           ? middle_resident[engine]
+           : resident[engine])
+          .push_back(subgraph.tensors_to_retain[i]);
+    }
+    if (stop()) return absl::OkStatus();
+  }
+  for (size_t op = 0; op < covered.size(); ++op) {
+    if (!covered[op]) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Op ", op, " is not covered by any subgraph"));
+    }
+  }
+  for (size_t tensor = 0; tensor < problem_.tensors.size(); ++tensor) {
+    if (IsGraphOutput(tensor) && !in_slow_memory[tensor]) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Graph output ", tensor, " does not end up in slow memory"));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<TotalLatency> Replayer::Evaluate(const Solution& solution) {
+  if (num_engines_ > 1) return Makespan(solution);
+  TotalLatency latency = 0.0;
+  if (absl::Status status = Replay(
+          solution, [&](const Step& step) { latency += step.latency; });
+      !status.ok()) {
+    return status;
+  }
+  return latency;
+}
+
+absl::StatusOr<TotalLatency> Replayer::EvaluateBounded(
+    const Solution& solution, TotalLatency bound) {
+  if (num_engines_ > 1) return Makespan(solution);
+  TotalLatency latency = 0.0;
+  if (absl::Status status = ReplayUntil(
+          solution, [&](const Step& step) { latency += step.latency; },
+          [&] { return latency > bound; });
+      !status.ok()) {
+    return status;
+  }
+  return latency;
+}
+
+absl::StatusOr<std::vector<SubgraphLatency>> Replayer::SubgraphLatencies(
+    const Solution& solution) {
+  std::vector<SubgraphLatency> latencies(solution.subgraphs.size(), 0.0);
+  if (absl::Status status = Replay(solution,
+                                   [&](const Step& step) {
+                                     latencies[step.subgraph] += step.latency;
+                                   });
+      !status.ok()) {
+    return status;
+  }
+  return latencies;
+}
+
+// Runs every engine through its subgraphs in solution order.  A subgraph
+// starts once its engine is free and every subgraph it waits for has
+// finished; its steps then take as long as their compute or their transfers,
+// whichever finishes last.  Under fair sharing, the engines moving data at a
+// given moment split the bandwidth evenly, so transfers stretch while others
+// are in flight.
+absl::StatusOr<TotalLatency> Replayer::Makespan(const Solution& solution) {
+  struct Work {
+    double compute;
+    double memory;  // At the full bandwidth.
+  };
+  const size_t num_subgraphs = solution.subgraphs.size();
+  std::vector<std::vector<Work>> work(num_subgraphs);
+  // Only the slow memory link is shared; each engine has its own link to
+  // middle memory.
+  const auto visit = [&](const Step& step) {
+    work[step.subgraph].push_back(
+        {std::max(step.compute_time, step.middle_time),
+         step.memory_in_time + step.memory_out_time});
+  };
+  if (absl::Status status = Replay(solution, visit); !status.ok()) {
+    return status;
+  }
+
+  // Besides its explicit dependencies, a subgraph waits for the subgraphs
+  // writing its inputs.
+  std::vector<std::vector<size_t>> waits(num_subgraphs);
+  std::vector<std::vector<size_t>> queues(num_engines_);
+  std::vector<int64_t> writer(problem_.tensors.size(), -1);
+  for (size_t index = 0; index < num_subgraphs; ++index) {
+    const Subgraph& subgraph = solution.subgraphs[index];
+    waits[index] = subgraph.dependencies;
+    for (size_t op : subgraph.ops) {
+      for (size_t tensor : problem_.ops[op].inputs) {
+        if (writer[tensor] >= 0) waits[index].push_back(writer[tensor]);
+      }
+    }
+    for (size_t op : subgraph.ops) {
+      for (size_t tensor : problem_.ops[op].outputs) writer[tensor] = index;
+    }
+    queues[subgraph.engine.value_or(0)].push_back(index);
+  }
+
+  struct Engine {
+    size_t next = 0;       // Into the engine's queue.
+    int64_t running = -1;  // The subgraph, if any.
+    size_t step = 0;
+    double compute = 0.0;  // Left in the current step.
+    double memory = 0.0;
+  };
+  std::vector<Engine> engines(num_engines_);
+  std::vector<double> finish(num_subgraphs, -1.0);
+  const auto ready = [&](size_t index) {
+    return std::all_of(waits[index].begin(), waits[index].end(),
+                       [&](size_t wait) { return finish[wait] >= 0.0; });
+  };
+  double now = 0.0;
+  size_t done = 0;
+  while (done < num_subgraphs) {
+    // Start subgraphs and steps until nothing changes at `now`.
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (int i = 0; i < num_engines_; ++i) {
+        Engine& engine = engines[i];
+        if (engine.running < 0 && engine.next < queues[i].size() &&
+            ready(queues[i][engine.next])) {
+          engine.running = queues[i][engine.next++];
+          engine.step = 0;
+          engine.compute = work[engine.running][0].compute;
+          engine.memory = work[engine.running][0].memory;
+          changed = true;
+        }
+        if (engine.running >= 0 && engine.compute <= 0.0 &&
+            engine.memory <= 0.0) {
+          const std::vector<Work>& steps = work[engine.running];
+          if (++engine.step < steps.size()) {
+            engine.compute = steps[engine.step].compute;
+            engine.memory = steps[engine.step].memory;
+          } else {
+            finish[engine.running] = now;
+            ++done;
+            engine.running = -1;
+          }
+          changed = true;
+        }
+      }
+    }
+    if (done == num_subgraphs) break;
+
+    int transferring = 0;
+    for (const Engine& engine : engines) {
+      transferring += engine.running >= 0 && engine.memory > 0.0;
+    }
+    const double rate =
+        options_.bandwidth_sharing == BandwidthSharing::kFair &&
+                transferring > 0
+            ? 1.0 / transferring
+            : 1.0;
+    double advance = std::numeric_limits<double>::infinity();
+    for (const Engine& engine : engines) {
+      if (engine.running < 0) continue;
+      if (engine.compute > 0.0) advance = std::min(advance, engine.compute);
+      if (engine.memory > 0.0) {
+        advance = std::min(advance, engine.memory / rate);
+      }
+    }
+    if (advance == std::numeric_limits<double>::infinity()) {
+      return absl::InternalError("No engine can make progress");
+    }
+    now += advance;
+    // Whatever finishes at `now` is set to exactly zero.
+    for (Engine& engine : engines) {
+      if (engine.running < 0) continue;
+      engine.compute =
+          engine.compute <= advance ? 0.0 : engine.compute - advance;
+      engine.memory = engine.memory / rate <= advance
+                          ? 0.0
+                          : engine.memory - advance * rate;
+    }
+  }
+  return now;
+}
+
+}  // namespace mlsys
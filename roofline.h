@@ -0,0 +1,234 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_ROOFLINE_H_
+#define MLSYS_ROOFLINE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mlsys.h"
+#include "third_party/absl/functional/function_ref.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/types/span.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Step-level replay of the roofline model in PROBLEM.md.      /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// A rectangle of a tensor, in elements.
+struct Region {
+  int64_t row = 0;
+  int64_t col = 0;
+  int64_t height = 0;
+  int64_t width = 0;
+  int64_t size() const { return height * width; }
+  bool empty() const { return height <= 0 || width <= 0; }
+  bool operator==(const Region& other) const = default;
+};
+
+struct Transfer {
+  size_t tensor;
+  Region region;
+  // Whether the data stays in or comes from middle memory rather than slow
+  // memory.  Either way, with a middle memory it crosses the link to it.
+  bool middle = false;
+};
+
+// One execution step of a subgraph: a spatial tile and one slice of the
+// reduction.  Loads and stores move data between slow and fast memory, or
+// middle and fast memory; stages copy whole inputs from slow to middle
+// memory the first time a subgraph needs them.
+struct Step {
+  size_t subgraph = 0;
+  int64_t tile = 0;      // Row-major index of the spatial tile.
+  int64_t position = 0;  // Index of the tile within the traversal order.
+  int64_t num_tiles = 0;
+  int64_t k_step = 0;
+  int64_t num_k_steps = 1;
+  Region output;  // The tile of the subgraph's output grid.
+  Region valid;   // `output` clipped to the extent of the grid.
+  std::vector<Transfer> loads;
+  std::vector<Transfer> stores;
+  std::vector<Transfer> stages;
+  double compute_time = 0.0;
+  // On the slow memory link, including any DMA setup latency per transfer.
+  double memory_in_time = 0.0;
+  double memory_out_time = 0.0;
+  // On the link between middle and fast memory, in both directions.
+  double middle_time = 0.0;
+  // In bytes, like the capacity; see Tensor::element_bytes.
+  int64_t working_set = 0;  // Fast memory in use, including `resident`.
+  int64_t resident = 0;     // Fast memory held by whole retained tensors.
+  // Load time spent during the previous subgraph under overlap_prefetch, and
+  // so not part of `memory_in_time`.
+  double prefetch_time = 0.0;
+  double latency = 0.0;
+};
+
+using StepVisitor = absl::FunctionRef<void(const Step&)>;
+
+// The smallest region covering both.
+Region Union(const Region& a, const Region& b);
+
+// Restricts `rows x cols` to the extent of `tensor`.  A dimension of size one
+// broadcasts, so it always maps onto its single row or column.
+Region Clip(int64_t row, int64_t height, int64_t col, int64_t width,
+            const Tensor& tensor);
+
+// The native tiles an op computes per step at `granularity`, padding
+// partial ones.
+int64_t PaddedTiles(const Granularity& granularity, const Granularity& native);
+
+// The bytes a transfer moves.
+int64_t TransferBytes(const Problem& problem, const Transfer& transfer);
+
+// Under EvaluateOptions::overlap_prefetch, the load time of `prefetchable`
+// bytes that hides behind a step leaving the slow memory idle for `slack`
+// and `free` bytes of fast memory unused.
+double PrefetchTime(const Problem& problem, int64_t prefetchable, double slack,
+                    int64_t free);
+
+// Walks a solution step by step.  The replayer precomputes the producer and
+// consumer structure of the problem once and keeps its scratch buffers, so a
+// single instance should be reused for many evaluations on the same thread.
+//
+// Within a subgraph, an input slice identical to the one used by the previous
+// step stays resident.  Across spatial tiles this only happens when the
+// subgraph gives an explicit traversal order (Example 4 of PROBLEM.md);
+// consecutive reduction steps of one tile always share resident slices
+// (Example 5).
+//
+// With a middle memory, a step takes as long as the slowest of its compute,
+// its transfers over the slow memory link and its transfers over the middle
+// memory link.  A tensor held in or retained to middle memory occupies it
+// whole for the duration of the subgraph.
+//
+// Subgraphs replayed in isolation never overlap; EvaluateOptions only affect
+// Replay() and the evaluations built on it.  Under EvaluateOptions::repeated,
+// Replay() walks one steady-state iteration.
+class Replayer {
+ public:
+  explicit Replayer(const Problem& problem, EvaluateOptions options = {});
+
+  const Problem& problem() const { return problem_; }
+  const EvaluateOptions& options() const { return options_; }
+  // The fast and middle memory of one engine.
+  FastMemoryCapacity capacity() const { return capacity_; }
+  FastMemoryCapacity middle_capacity() const { return middle_capacity_; }
+  bool IsGraphInput(size_t tensor) const { return producer_[tensor] < 0; }
+  bool IsGraphOutput(size_t tensor) const { return !has_consumer_[tensor]; }
+  // A graph input read only as the right-hand side of MatMuls; see
+  // EvaluateOptions::repeated.
+  bool IsWeight(size_t tensor) const { return weight_[tensor]; }
+  // The op producing `tensor`, or -1 for graph inputs.
+  int64_t Producer(size_t tensor) const { return producer_[tensor]; }
+
+  // Replays a single subgraph in isolation.  `resident` lists the tensors held
+  // in fast memory when it starts, i.e. the previous `tensors_to_retain`, and
+  // `middle_resident` those held in middle memory.
+  absl::Status ReplaySubgraph(size_t index, const Subgraph& subgraph,
+                              absl::Span<const size_t> resident,
+                              StepVisitor visitor);
+  absl::Status ReplaySubgraph(size_t index, const Subgraph& subgraph,
+                              absl::Span<const size_t> resident,
+                              absl::Span<const size_t> middle_resident,
+                              StepVisitor visitor);
+  absl::StatusOr<SubgraphLatency> SubgraphCost(
+      const Subgraph& subgraph, absl::Span<const size_t> resident,
+      absl::Span<const size_t> middle_resident = {});
+
+  // Replays every subgraph in order, additionally checking that each input
+  // is available when needed, that every op is covered and that every graph
+  // output ends up in slow memory.  Steps report their latency on an idle
+  // machine; with several engines, only Evaluate() accounts for concurrency.
+  absl::Status Replay(const Solution& solution, StepVisitor visitor);
+  absl::StatusOr<TotalLatency> Evaluate(const Solution& solution);
+  // Like Evaluate(), but gives up after the first subgraph that takes the
+  // latency past `bound`, returning that partial latency unchecked.  With
+  // several engines, the same as Evaluate().
+  absl::StatusOr<TotalLatency> EvaluateBounded(const Solution& solution,
+                                               TotalLatency bound);
+  absl::StatusOr<std::vector<SubgraphLatency>> SubgraphLatencies(
+      const Solution& solution);
+
+ private:
+  struct LocalTensor {
+    size_t id = 0;
+    bool produced = false;  // By an op of the subgraph.
+    bool consumed = false;  // By an op of the subgraph.
+    bool resident = false;  // Held in fast memory at entry.
+    bool retained = false;
+    bool middle_resident = false;  // Held in middle memory at entry.
+    bool middle_retained = false;
+    bool in_middle = false;  // Since entry or since staged.
+    // Per element, in slow memory and while the subgraph computes it.  The
+    // latter is the accumulator width for MatMul and Reduction results.
+    ElementBytes element_bytes = 1;
+    ElementBytes held_bytes = 1;
+    Region need;
+    Region previous;
+  };
+
+  // What the previous subgraph leaves for the next one to prefetch into.
+  struct Handoff {
+    double slack = 0.0;           // Idle slow memory time of its last step.
+    int64_t free = 0;             // Fast memory unused by its last step.
+    std::vector<int64_t> writer;  // Per tensor: the subgraph storing it.
+  };
+
+  // The makespan of a solution over several engines.
+  absl::StatusOr<TotalLatency> Makespan(const Solution& solution);
+  // Replay(), stopping successfully once `stop` holds after a subgraph.
+  absl::Status ReplayUntil(const Solution& solution, StepVisitor visitor,
+                           absl::FunctionRef<bool()> stop);
+  absl::Status ReplaySubgraphImpl(size_t index, const Subgraph& subgraph,
+                                  absl::Span<const size_t> resident,
+                                  absl::Span<const size_t> middle_resident,
+                                  std::vector<char>* in_slow_memory,
+                                  Handoff* handoff, StepVisitor visitor);
+  absl::Status Prepare(size_t index, const Subgraph& subgraph,
+                       absl::Span<const size_t> resident,
+                       absl::Span<const size_t> middle_resident);
+  LocalTensor& Local(size_t tensor);
+  void Reset();
+
+  const Problem& problem_;
+  const EvaluateOptions options_;
+  const int num_engines_;
+  const FastMemoryCapacity capacity_;
+  const FastMemoryCapacity middle_capacity_;  // Of one engine.
+  std::vector<int64_t> producer_;
+  std::vector<char> has_consumer_;
+  std::vector<char> weight_;
+
+  // Scratch describing the subgraph being replayed.
+  std::vector<int32_t> op_position_;   // Per op; -1 outside the subgraph.
+  std::vector<int32_t> tensor_slot_;   // Per tensor; -1 if not referenced.
+  std::vector<LocalTensor> locals_;
+  std::vector<size_t> order_;          // Topological order of the ops.
+  std::vector<char> split_;            // Per position in `order_`.
+  std::vector<SliceRule> rule_;        // Per position in `order_`.
+  Step step_;
+};
+
+}  // namespace mlsys
+
+#endif  // MLSYS_ROOFLINE_H_
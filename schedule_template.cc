@@ -0,0 +1,436 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "schedule_template.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "file_util.h"
+#include "json_util.h"
+#include "mlsys.h"
+#include "solver.h"
+#include "third_party/absl/container/flat_hash_set.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/ascii.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/strings/str_replace.h"
+#include "third_party/absl/strings/string_view.h"
+
+namespace mlsys {
+
+namespace {
+
+int64_t CeilDiv(int64_t a, int64_t b) { return (a + b - 1) / b; }
+
+TraversalOrder RowSnake(int64_t rows, int64_t cols) {
+  TraversalOrder order;
+  order.reserve(rows * cols);
+  for (int64_t row = 0; row < rows; ++row) {
+    for (int64_t i = 0; i < cols; ++i) {
+      order.push_back(row * cols + (row % 2 == 0 ? i : cols - 1 - i));
+    }
+  }
+  return order;
+}
+
+TraversalOrder ColumnSnake(int64_t rows, int64_t cols) {
+  TraversalOrder order;
+  order.reserve(rows * cols);
+  for (int64_t col = 0; col < cols; ++col) {
+    for (int64_t i = 0; i < rows; ++i) {
+      order.push_back((col % 2 == 0 ? i : rows - 1 - i) * cols + col);
+    }
+  }
+  return order;
+}
+
+// What a subgraph's granularity tiles: the grid of outputs it does not
+// consume itself, as in the evaluator, and its longest reduction.
+struct Extents {
+  Width width = 1;
+  Height height = 1;
+  Depth depth = 0;
+  bool operator==(const Extents& other) const = default;
+};
+
+absl::StatusOr<Extents> SubgraphExtents(const Problem& problem,
+                                        const Subgraph& subgraph) {
+  absl::flat_hash_set<size_t> consumed;
+  for (size_t op : subgraph.ops) {
+    if (op >= problem.ops.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("template references unknown op ", op));
+    }
+    const Op& spec = problem.ops[op];
+    consumed.insert(spec.inputs.begin(), spec.inputs.end());
+  }
+  Extents extents;
+  for (size_t op : subgraph.ops) {
+    const Op& spec = problem.ops[op];
+    extents.depth = std::max(extents.depth, ReductionDepth(problem, spec));
+    for (size_t tensor : spec.outputs) {
+      if (consumed.contains(tensor)) continue;
+      extents.width = std::max(extents.width, problem.tensors[tensor].width);
+      extents.height =
+          std::max(extents.height, problem.tensors[tensor].height);
+    }
+  }
+  return extents;
+}
+
+// The serpentine `order` follows over a grid `cols` tiles wide; row-major
+// unless its first step moves down a column.
+TraversalRule SnakeOf(const std::optional<TraversalOrder>& order,
+                      int64_t cols) {
+  if (!order.has_value() || order->size() < 2) return TraversalRule::kRowSnake;
+  return (*order)[1] - (*order)[0] == cols && cols > 1
+             ? TraversalRule::kColumnSnake
+             : TraversalRule::kRowSnake;
+}
+
+absl::Status ValidateRule(const TileRule& rule) {
+  if ((rule.kind != TileRule::kSize && rule.kind != TileRule::kCount) ||
+      rule.value <= 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "invalid tile rule [", static_cast<int64_t>(rule.kind), ", ",
+        rule.value, "]"));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<ProblemFamily> ParseProblemFamily(absl::string_view json) {
+  absl::StatusOr<Problem> problem = ParseProblem(json);
+  if (!problem.ok()) return problem.status();
+  ProblemFamily family;
+  family.problem = *std::move(problem);
+  bool has_parameter = false;
+  JsonReader reader(json);
+  if (absl::Status status = reader.ReadObject([&](const std::string& key) {
+        if (key == "parameter") {
+          absl::StatusOr<int64_t> value = reader.ReadNumber<int64_t>();
+          if (!value.ok()) return value.status();
+          family.parameter = *value;
+          has_parameter = true;
+          return absl::OkStatus();
+        }
+        if (key == "width_multiples") {
+          return reader.ReadNumbers(&family.width_multiples);
+        }
+        if (key == "height_multiples") {
+          return reader.ReadNumbers(&family.height_multiples);
+        }
+        return reader.SkipValue();
+      });
+      !status.ok()) {
+    return status;
+  }
+  if (!has_parameter || family.parameter <= 0) {
+    return absl::InvalidArgumentError(
+        "a problem family needs a positive \"parameter\"");
+  }
+  const size_t num_tensors = family.problem.tensors.size();
+  for (std::vector<int64_t>* multiples :
+       {&family.width_multiples, &family.height_multiples}) {
+    if (multiples->empty()) multiples->resize(num_tensors, 0);
+    if (multiples->size() != num_tensors) {
+      return absl::InvalidArgumentError(
+          "multiples must be given for every tensor");
+    }
+  }
+  for (size_t tensor = 0; tensor < num_tensors; ++tensor) {
+    const Tensor& spec = family.problem.tensors[tensor];
+    const int64_t width = family.width_multiples[tensor];
+    const int64_t height = family.height_multiples[tensor];
+    if (width < 0 || height < 0 ||
+        (width > 0 && spec.width != width * family.parameter) ||
+        (height > 0 && spec.height != height * family.parameter)) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "tensor ", tensor, " does not match its multiples of parameter ",
+          family.parameter));
+    }
+  }
+  return family;
+}
+
+absl::StatusOr<ProblemFamily> ReadProblemFamily(const std::string& filename) {
+  absl::StatusOr<std::string> contents = ReadFile(filename);
+  if (!contents.ok()) return contents.status();
+  return ParseProblemFamily(*contents);
+}
+
+absl::StatusOr<Problem> InstantiateProblem(const ProblemFamily& family,
+                                           int64_t parameter) {
+  if (parameter <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("parameter must be positive, got ", parameter));
+  }
+  Problem problem = family.problem;
+  for (size_t tensor = 0; tensor < problem.tensors.size(); ++tensor) {
+    if (family.width_multiples[tensor] > 0) {
+      problem.tensors[tensor].width =
+          family.width_multiples[tensor] * parameter;
+    }
+    if (family.height_multiples[tensor] > 0) {
+      problem.tensors[tensor].height =
+          family.height_multiples[tensor] * parameter;
+    }
+  }
+  if (absl::Status status = ValidateProblem(problem); !status.ok()) {
+    return status;
+  }
+  return problem;
+}
+
+int64_t TileRule::Apply(int64_t extent) const {
+  if (kind == kCount) return std::max<int64_t>(1, CeilDiv(extent, value));
+  return extent > 0 ? std::min(value, extent) : value;
+}
+
+std::string ScheduleTemplateToJson(const ScheduleTemplate& schedule) {
+  std::vector<std::vector<int64_t>> tile_rules;
+  std::vector<int64_t> traversal_rules;
+  Solution reference;
+  for (const SubgraphTemplate& subgraph : schedule.subgraphs) {
+    tile_rules.push_back({subgraph.width.kind, subgraph.width.value,
+                          subgraph.height.kind, subgraph.height.value,
+                          subgraph.depth.kind, subgraph.depth.value});
+    traversal_rules.push_back(static_cast<int64_t>(subgraph.traversal));
+    reference.subgraphs.push_back(subgraph.subgraph);
+  }
+  return absl::StrCat(
+      "{\n  \"parameter\": ", schedule.parameter,
+      ",\n  \"tile_rules\": ", JsonNestedList(tile_rules),
+      ",\n  \"traversal_rules\": ", JsonList(traversal_rules),
+      ",\n  \"reference\": ",
+      absl::StrReplaceAll(
+          absl::StripTrailingAsciiWhitespace(SolutionToJson(reference)),
+          {{"\n", "\n  "}}),
+      "\n}\n");
+}
+
+absl::StatusOr<ScheduleTemplate> ParseScheduleTemplate(absl::string_view json) {
+  ScheduleTemplate schedule;
+  std::vector<std::vector<int64_t>> tile_rules;
+  std::vector<int64_t> traversal_rules;
+  std::optional<Solution> reference;
+  JsonReader reader(json);
+  absl::Status status = reader.ReadObject([&](const std::string& key) {
+    if (key == "parameter") {
+      absl::StatusOr<int64_t> value = reader.ReadNumber<int64_t>();
+      if (!value.ok()) return value.status();
+      schedule.parameter = *value;
+      return absl::OkStatus();
+    }
+    if (key == "tile_rules") return ReadNestedNumbers(reader, &tile_rules);
+    if (key == "traversal_rules") return reader.ReadNumbers(&traversal_rules);
+    if (key == "reference") {
+      absl::StatusOr<absl::string_view> text = reader.ReadRaw();
+      if (!text.ok()) return text.status();
+      absl::StatusOr<Solution> solution = ParseSolution(*text);
+      if (!solution.ok()) return solution.status();
+      reference = *std::move(solution);
+      return absl::OkStatus();
+    }
+    return reader.SkipValue();
+  });
+  if (status.ok()) status = reader.ExpectEnd();
+  if (!status.ok()) return status;
+  if (!reference.has_value() ||
+      tile_rules.size() != reference->subgraphs.size() ||
+      traversal_rules.size() != reference->subgraphs.size()) {
+    return absl::InvalidArgumentError(
+        "a schedule template needs a reference solution and rules for each "
+        "of its subgraphs");
+  }
+  for (size_t i = 0; i < tile_rules.size(); ++i) {
+    const std::vector<int64_t>& rules = tile_rules[i];
+    if (rules.size() != 6) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("subgraph ", i, " needs three tile rules"));
+    }
+    if (traversal_rules[i] < 0 || traversal_rules[i] > 2) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("subgraph ", i, " has an unknown traversal rule"));
+    }
+    SubgraphTemplate subgraph;
+    subgraph.subgraph = reference->subgraphs[i];
+    subgraph.width = {static_cast<TileRule::Kind>(rules[0]), rules[1]};
+    subgraph.height = {static_cast<TileRule::Kind>(rules[2]), rules[3]};
+    subgraph.depth = {static_cast<TileRule::Kind>(rules[4]), rules[5]};
+    subgraph.traversal = static_cast<TraversalRule>(traversal_rules[i]);
+    for (const TileRule& rule :
+         {subgraph.width, subgraph.height, subgraph.depth}) {
+      if (absl::Status status = ValidateRule(rule); !status.ok()) {
+        return status;
+      }
+    }
+    schedule.subgraphs.push_back(std::move(subgraph));
+  }
+  return schedule;
+}
+
+absl::StatusOr<ScheduleTemplate> ReadScheduleTemplate(
+    const std::string& filename) {
+  absl::StatusOr<std::string> contents = ReadFile(filename);
+  if (!contents.ok()) return contents.status();
+  return ParseScheduleTemplate(*contents);
+}
+
+absl::Status WriteScheduleTemplate(const ScheduleTemplate& schedule,
+                                   const std::string& filename) {
+  return WriteFile(filename, ScheduleTemplateToJson(schedule));
+}
+
+absl::StatusOr<Solution> InstantiateSchedule(
+    const Problem& problem, const ScheduleTemplate& schedule) {
+  Solution solution;
+  solution.subgraphs.reserve(schedule.subgraphs.size());
+  for (const SubgraphTemplate& rules : schedule.subgraphs) {
+    const absl::StatusOr<Extents> extents =
+        SubgraphExtents(problem, rules.subgraph);
+    if (!extents.ok()) return extents.status();
+    Subgraph& subgraph = solution.subgraphs.emplace_back(rules.subgraph);
+    subgraph.granularity = {rules.width.Apply(extents->width),
+                            rules.height.Apply(extents->height),
+                            rules.depth.Apply(extents->depth)};
+    subgraph.subgraph_latency = 0.0;
+    subgraph.traversal_order = std::nullopt;
+    const int64_t rows = CeilDiv(extents->height, subgraph.granularity.height);
+    const int64_t cols = CeilDiv(extents->width, subgraph.granularity.width);
+    if (rows * cols > 1 && rules.traversal != TraversalRule::kRaster) {
+      subgraph.traversal_order = rules.traversal == TraversalRule::kRowSnake
+                                     ? RowSnake(rows, cols)
+                                     : ColumnSnake(rows, cols);
+    }
+  }
+  return solution;
+}
+
+absl::StatusOr<ScheduleTemplate> BuildScheduleTemplate(
+    const ProblemFamily& family, int64_t parameter,
+    const TemplateOptions& options) {
+  const absl::StatusOr<Problem> reference =
+      InstantiateProblem(family, parameter);
+  if (!reference.ok()) return reference.status();
+  const absl::StatusOr<Solution> solution =
+      Solve(*reference, options.solver, options.time_limit);
+  if (!solution.ok()) return solution.status();
+
+  std::vector<Problem> samples;
+  for (int64_t sample : options.samples) {
+    absl::StatusOr<Problem> problem = InstantiateProblem(family, sample);
+    if (!problem.ok()) return problem.status();
+    samples.push_back(*std::move(problem));
+  }
+
+  // Start from fixed tile sizes, which reproduce the solution at `parameter`
+  // exactly.
+  ScheduleTemplate schedule;
+  schedule.parameter = parameter;
+  std::vector<std::vector<Extents>> extents;  // Per subgraph, per sample.
+  std::vector<Extents> reference_extents;     // Per subgraph.
+  for (const Subgraph& subgraph : solution->subgraphs) {
+    const absl::StatusOr<Extents> at_reference =
+        SubgraphExtents(*reference, subgraph);
+    if (!at_reference.ok()) return at_reference.status();
+    reference_extents.push_back(*at_reference);
+    std::vector<Extents>& at_samples = extents.emplace_back();
+    for (const Problem& sample : samples) {
+      const absl::StatusOr<Extents> at_sample =
+          SubgraphExtents(sample, subgraph);
+      if (!at_sample.ok()) return at_sample.status();
+      at_samples.push_back(*at_sample);
+    }
+    SubgraphTemplate& rules = schedule.subgraphs.emplace_back();
+    rules.subgraph = subgraph;
+    rules.width = {TileRule::kSize, subgraph.granularity.width};
+    rules.height = {TileRule::kSize, subgraph.granularity.height};
+    rules.depth = {TileRule::kSize, subgraph.granularity.depth};
+    rules.traversal = SnakeOf(
+        subgraph.traversal_order,
+        CeilDiv(at_reference->width, subgraph.granularity.width));
+  }
+
+  const auto total_latency = [&]() {
+    double total = 0.0;
+    for (const Problem& sample : samples) {
+      const absl::StatusOr<Solution> instance =
+          InstantiateSchedule(sample, schedule);
+      if (!instance.ok()) return std::numeric_limits<double>::infinity();
+      const absl::StatusOr<TotalLatency> latency =
+          Evaluate(sample, *instance, options.solver.evaluate);
+      if (!latency.ok()) return std::numeric_limits<double>::infinity();
+      total += *latency;
+    }
+    return total;
+  };
+  // Keeps `candidate` for `rule` if it lowers the total latency.
+  double best = total_latency();
+  const auto try_rule = [&](auto* rule, auto candidate) {
+    const auto saved = *rule;
+    *rule = candidate;
+    if (const double total = total_latency(); total < best) {
+      best = total;
+    } else {
+      *rule = saved;
+    }
+  };
+  for (size_t i = 0; i < schedule.subgraphs.size(); ++i) {
+    SubgraphTemplate& rules = schedule.subgraphs[i];
+    const Extents& at_reference = reference_extents[i];
+    const Granularity& granularity = rules.subgraph.granularity;
+    bool varies[3] = {false, false, false};
+    for (const Extents& at_sample : extents[i]) {
+      varies[0] |= at_sample.width != at_reference.width;
+      varies[1] |= at_sample.height != at_reference.height;
+      varies[2] |= at_sample.depth != at_reference.depth;
+    }
+    if (varies[0]) {
+      try_rule(&rules.width,
+               TileRule{TileRule::kCount,
+                        CeilDiv(at_reference.width, granularity.width)});
+    }
+    if (varies[1]) {
+      try_rule(&rules.height,
+               TileRule{TileRule::kCount,
+                        CeilDiv(at_reference.height, granularity.height)});
+    }
+    if (varies[2] && at_reference.depth > 0) {
+      try_rule(&rules.depth,
+               TileRule{TileRule::kCount,
+                        CeilDiv(at_reference.depth, granularity.depth)});
+    }
+    if (varies[0] || varies[1]) {
+      try_rule(&rules.traversal,
+               rules.traversal == TraversalRule::kRowSnake
+                   ? TraversalRule::kColumnSnake
+                   : TraversalRule::kRowSnake);
+    }
+  }
+  return schedule;
+}
+
+}  // namespace mlsys
@@ -0,0 +1,130 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_SCHEDULE_TEMPLATE_H_
+#define MLSYS_SCHEDULE_TEMPLATE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mlsys.h"
+#include "solver.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/string_view.h"
+#include "third_party/absl/time/time.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Schedules over one shape parameter of a problem.            /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// The problems of one graph over an integer parameter such as the batch size
+// or the sequence length.  A tensor dimension with a nonzero multiple is that
+// multiple of the parameter; the others are fixed.
+struct ProblemFamily {
+  Problem problem;  // The member at `parameter`.
+  int64_t parameter = 1;
+  std::vector<int64_t> width_multiples;   // Per tensor.
+  std::vector<int64_t> height_multiples;  // Per tensor.
+};
+
+// The input format of PROBLEM.md plus a "parameter" and, per tensor,
+// "width_multiples" and "height_multiples"; omitted multiples are zero.  The
+// dimensions given must be those at `parameter`.
+absl::StatusOr<ProblemFamily> ParseProblemFamily(absl::string_view json);
+absl::StatusOr<ProblemFamily> ReadProblemFamily(const std::string& filename);
+
+// The member of `family` at `parameter`.
+absl::StatusOr<Problem> InstantiateProblem(const ProblemFamily& family,
+                                           int64_t parameter);
+
+// How one dimension of a granularity follows the extent it tiles: the width
+// or height of the subgraph's output grid, or its longest reduction.
+struct TileRule {
+  enum Kind : int64_t {
+    kSize = 0,   // Tiles of `value`, clipped to the extent.
+    kCount = 1,  // `value` tiles, the smallest that cover the extent.
+  };
+  Kind kind = kSize;
+  int64_t value = 1;
+
+  int64_t Apply(int64_t extent) const;
+  bool operator==(const TileRule& other) const = default;
+};
+
+enum class TraversalRule : int64_t {
+  kRaster = 0,
+  kRowSnake = 1,     // Serpentine along rows of tiles.
+  kColumnSnake = 2,  // Serpentine along columns of tiles.
+};
+
+struct SubgraphTemplate {
+  // As solved at the template's parameter; its granularity and traversal
+  // order are replaced by the rules below.
+  Subgraph subgraph;
+  TileRule width;
+  TileRule height;
+  TileRule depth;
+  TraversalRule traversal = TraversalRule::kRowSnake;
+};
+
+// A schedule for every member of a problem family: the fusion, retention and
+// engines of one solution, with its granularities and traversal orders
+// turned into rules of the extents the parameter changes.
+struct ScheduleTemplate {
+  int64_t parameter = 1;  // The member it was solved for.
+  std::vector<SubgraphTemplate> subgraphs;
+};
+
+// {"parameter": ..., "tile_rules": [[kind, value] for width, height and depth,
+// per subgraph], "traversal_rules": [...], "reference": <solution>}.
+std::string ScheduleTemplateToJson(const ScheduleTemplate& schedule);
+absl::StatusOr<ScheduleTemplate> ParseScheduleTemplate(absl::string_view json);
+absl::StatusOr<ScheduleTemplate> ReadScheduleTemplate(
+    const std::string& filename);
+absl::Status WriteScheduleTemplate(const ScheduleTemplate& schedule,
+                                   const std::string& filename);
+
+struct TemplateOptions {
+  SolverOptions solver;
+  absl::Duration time_limit = absl::Seconds(10);
+  // Members of the family the rules are fitted to.
+  std::vector<int64_t> samples;
+};
+
+// Solves the member of `family` at `parameter` and generalizes the solution:
+// every granularity dimension whose extent varies over `samples` keeps
+// either its tile size or its number of tiles, and every traversal one of
+// the two serpentines, whichever gives the lower total latency over the
+// samples.  Either way tiles and retained tensors only shrink with the
+// parameter, so instances up to `parameter` fit in fast memory; larger ones
+// may not, and `parameter` should be the largest of interest.
+absl::StatusOr<ScheduleTemplate> BuildScheduleTemplate(
+    const ProblemFamily& family, int64_t parameter,
+    const TemplateOptions& options);
+
+// The template's schedule for `problem`, a member of its family.  This is
+// arithmetic over the subgraphs only, with no replay, so subgraph latencies
+// are left zero; see Replayer::SubgraphLatencies() for filling them in.
+absl::StatusOr<Solution> InstantiateSchedule(const Problem& problem,
+                                             const ScheduleTemplate& schedule);
+
+}  // namespace mlsys
+
+#endif  // MLSYS_SCHEDULE_TEMPLATE_H_
@@ -0,0 +1,94 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Simulates solutions of a problem with queued DMA and pipelined compute, and
+// compares the result with the roofline latency:
+//
+//   $ ./mlsys_simulate --dma_queue_depth=2 problem.json a.json b.json
+//
+// Giving several solutions shows whether their ranking under the roofline
+// model survives the pipeline effects it leaves out.
+
+#include <iostream>
+#include <vector>
+
+#include "mlsys.h"
+#include "simulator.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/flags/parse.h"
+#include "third_party/absl/flags/usage.h"
+#include "third_party/absl/status/statusor.h"
+
+ABSL_FLAG(int, dma_queue_depth, 4, "Transfers the DMA engine holds at once.");
+ABSL_FLAG(int, step_buffers, 2,
+          "Steps whose inputs may be in fast memory at once; 2 is double "
+          "buffering.");
+ABSL_FLAG(double, pipeline_fill, 0.0,
+          "Latency before the first step of each subgraph computes.");
+ABSL_FLAG(double, pipeline_drain, 0.0,
+          "Latency after the last step of each subgraph computes.");
+ABSL_FLAG(double, barrier_latency, 0.0, "Latency between subgraphs.");
+
+int main(int argc, char* argv[]) {
+  absl::SetProgramUsageMessage(
+      "Usage: mlsys_simulate [flags] <problem.json> <solution.json>...");
+  const std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+  if (args.size() < 3) {
+    std::cerr << "Usage: " << args[0]
+              << " [flags] <problem.json> <solution.json>...\n";
+    return 1;
+  }
+  const absl::StatusOr<mlsys::Problem> problem = mlsys::ReadProblem(args[1]);
+  if (!problem.ok()) {
+    std::cerr << problem.status() << "\n";
+    return 1;
+  }
+  mlsys::SimulatorOptions options;
+  options.dma_queue_depth = absl::GetFlag(FLAGS_dma_queue_depth);
+  options.step_buffers = absl::GetFlag(FLAGS_step_buffers);
+  options.pipeline_fill = absl::GetFlag(FLAGS_pipeline_fill);
+  options.pipeline_drain = absl::GetFlag(FLAGS_pipeline_drain);
+  options.barrier_latency = absl::GetFlag(FLAGS_barrier_latency);
+  for (size_t i = 2; i < args.size(); ++i) {
+    const absl::StatusOr<mlsys::Solution> solution =
+        mlsys::ReadSolution(args[i]);
+    if (!solution.ok()) {
+      std::cerr << args[i] << ": " << solution.status() << "\n";
+      return 1;
+    }
+    const absl::StatusOr<mlsys::SimulationReport> report =
+        mlsys::Simulate(*problem, *solution, options);
+    if (!report.ok()) {
+      std::cerr << args[i] << ": " << report.status() << "\n";
+      return 1;
+    }
+    std::cout << args[i] << "\n";
+    for (size_t j = 0; j < report->subgraph_latencies.size(); ++j) {
+      std::cout << "  subgraph " << j << ": roofline "
+                << report->roofline_subgraph_latencies[j] << ", simulated "
+                << report->subgraph_latencies[j] << "\n";
+    }
+    std::cout << "  total: roofline " << report->roofline_latency
+              << ", simulated " << report->latency << " ("
+              << report->transfers << " transfers)\n"
+              << "  utilization: compute " << report->compute.utilization
+              << ", slow memory link " << report->slow_memory_link.utilization
+              << ", middle memory link "
+              << report->middle_memory_link.utilization << ", DMA queue "
+              << report->dma_queue.utilization << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,397 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "simulator.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "mlsys.h"
+#include "roofline.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+
+namespace mlsys {
+
+namespace {
+
+enum Link { kSlowLink = 0, kMiddleLink = 1 };
+
+// A stretch of a transfer holding one link.
+struct Phase {
+  Link link = kSlowLink;
+  double time = 0.0;
+};
+
+// A transfer as the simulator sees it: its DMA setup, then up to two phases
+// in the order the data crosses the links.
+struct PlannedTransfer {
+  double setup = 0.0;
+  int num_phases = 0;
+  Phase phases[2];
+};
+
+struct PlannedStep {
+  double compute_time = 0.0;
+  std::vector<PlannedTransfer> loads;
+  std::vector<PlannedTransfer> stores;
+};
+
+// Converts the transfers of Replayer steps into link times.
+class Planner {
+ public:
+  explicit Planner(const Problem& problem)
+      : problem_(problem),
+        has_middle_(HasMiddleMemory(problem)),
+        read_bandwidth_(ReadBandwidth(problem)),
+        write_bandwidth_(WriteBandwidth(problem)),
+        middle_bandwidth_(has_middle_ ? *problem.middle_memory_bandwidth
+                                      : 1.0),
+        setup_(problem.dma_setup_latency.value_or(0.0)) {}
+
+  PlannedStep Plan(const Step& step) const {
+    PlannedStep planned;
+    planned.compute_time = step.compute_time;
+    for (const Transfer& load : step.loads) {
+      PlannedTransfer transfer;
+      const int64_t bytes = TransferBytes(problem_, load);
+      double slow_time = load.middle ? 0.0 : bytes / read_bandwidth_;
+      for (const Transfer& stage : step.stages) {
+        if (stage.tensor == load.tensor) {
+          slow_time += TransferBytes(problem_, stage) / read_bandwidth_;
+        }
+      }
+      if (slow_time > 0.0) {
+        transfer.setup = setup_;
+        transfer.phases[transfer.num_phases++] = {kSlowLink, slow_time};
+      }
+      if (has_middle_) {
+        transfer.phases[transfer.num_phases++] = {kMiddleLink,
+                                                  bytes / middle_bandwidth_};
+      }
+      planned.loads.push_back(transfer);
+    }
+    for (const Transfer& store : step.stores) {
+      PlannedTransfer transfer;
+      const int64_t bytes = TransferBytes(problem_, store);
+      if (has_middle_) {
+        transfer.phases[transfer.num_phases++] = {kMiddleLink,
+                                                  bytes / middle_bandwidth_};
+      }
+      if (!store.middle) {
+        transfer.setup = setup_;
+        transfer.phases[transfer.num_phases++] = {kSlowLink,
+                                                  bytes / write_bandwidth_};
+      }
+      planned.stores.push_back(transfer);
+    }
+    return planned;
+  }
+
+ private:
+  const Problem& problem_;
+  const bool has_middle_;
+  const double read_bandwidth_;
+  const double write_bandwidth_;
+  const double middle_bandwidth_;
+  const double setup_;
+};
+
+// The event loop of one subgraph at a time.  Resource usage accumulates
+// across subgraphs.
+class Simulation {
+ public:
+  explicit Simulation(const SimulatorOptions& options) : options_(options) {}
+
+  // Runs the steps of a subgraph from `start` and returns when its last
+  // step has computed and its last transfer is done.
+  double Run(const std::vector<PlannedStep>& steps, double start);
+
+  double compute_busy() const { return compute_busy_; }
+  double link_busy(Link link) const { return links_[link].busy_time; }
+  double queue_busy() const { return queue_busy_; }
+  int64_t transfers() const { return transfers_; }
+
+ private:
+  enum class EventKind { kSetupDone, kPhaseDone, kComputeDone, kStoresDue };
+
+  struct Event {
+    double time = 0.0;
+    int64_t sequence = 0;  // Breaks ties in the order events were posted.
+    EventKind kind = EventKind::kSetupDone;
+    size_t index = 0;  // Of the request, or of the step.
+
+    bool operator>(const Event& other) const {
+      return time != other.time ? time > other.time
+                                : sequence > other.sequence;
+    }
+  };
+
+  struct Request {
+    const PlannedTransfer* transfer = nullptr;
+    size_t step = 0;
+    bool load = false;
+    int phase = 0;
+  };
+
+  struct LinkState {
+    bool busy = false;
+    std::deque<size_t> waiting;
+    double busy_time = 0.0;
+  };
+
+  void Post(double time, EventKind kind, size_t index) {
+    events_.push({time, sequence_++, kind, index});
+  }
+  // Changes the number of occupied queue slots at `now_`.
+  void Occupy(int delta) {
+    queue_busy_ += occupied_ * (now_ - occupancy_since_);
+    occupancy_since_ = now_;
+    occupied_ += delta;
+  }
+  void Issue(size_t step, bool load);
+  void Admit(size_t request);
+  void EnterPhase(size_t request);
+  void StartPhase(size_t request);
+  void Finish(size_t request);
+  void TryCompute();
+
+  const SimulatorOptions& options_;
+  std::priority_queue<Event, std::vector<Event>, std::greater<>> events_;
+  int64_t sequence_ = 0;
+  double now_ = 0.0;
+
+  // Of the current subgraph.
+  const std::vector<PlannedStep>* steps_ = nullptr;
+  double start_ = 0.0;
+  std::vector<Request> requests_;
+  std::vector<int64_t> pending_loads_;  // Per step, until issued and done.
+  size_t next_compute_ = 0;
+  bool computing_ = false;
+
+  std::deque<size_t> queue_;  // Requests waiting for a slot.
+  int occupied_ = 0;
+  double occupancy_since_ = 0.0;
+  LinkState links_[2];
+
+  double compute_busy_ = 0.0;
+  double queue_busy_ = 0.0;
+  int64_t transfers_ = 0;
+};
+
+double Simulation::Run(const std::vector<PlannedStep>& steps, double start) {
+  steps_ = &steps;
+  start_ = start;
+  now_ = start;
+  occupancy_since_ = start;
+  requests_.clear();
+  pending_loads_.assign(steps.size(), 0);
+  next_compute_ = 0;
+  computing_ = false;
+  // The loads of a step not yet issued count as one more pending.
+  for (size_t step = 0; step < steps.size(); ++step) {
+    pending_loads_[step] = steps[step].loads.size() + 1;
+  }
+  const size_t buffers = options_.step_buffers;
+  for (size_t step = 0; step < std::min(buffers, steps.size()); ++step) {
+    Issue(step, /*load=*/true);
+  }
+  TryCompute();
+  double end = start;
+  while (!events_.empty()) {
+    const Event event = events_.top();
+    events_.pop();
+    now_ = event.time;
+    end = std::max(end, now_);
+    switch (event.kind) {
+      case EventKind::kSetupDone:
+        EnterPhase(event.index);
+        break;
+      case EventKind::kPhaseDone: {
+        Request& request = requests_[event.index];
+        LinkState& link = links_[request.transfer->phases[request.phase].link];
+        link.busy = false;
+        if (!link.waiting.empty()) {
+          const size_t next = link.waiting.front();
+          link.waiting.pop_front();
+          StartPhase(next);
+        }
+        ++request.phase;
+        EnterPhase(event.index);
+        break;
+      }
+      case EventKind::kComputeDone: {
+        const size_t step = event.index;
+        computing_ = false;
+        if (step + 1 == steps.size()) {
+          Post(now_ + options_.pipeline_drain, EventKind::kStoresDue, step);
+        } else {
+          Issue(step, /*load=*/false);
+        }
+        if (step + buffers < steps.size()) Issue(step + buffers, true);
+        TryCompute();
+        break;
+      }
+      case EventKind::kStoresDue:
+        Issue(event.index, /*load=*/false);
+        break;
+    }
+  }
+  Occupy(0);
+  return end;
+}
+
+void Simulation::Issue(size_t step, bool load) {
+  const PlannedStep& planned = (*steps_)[step];
+  for (const PlannedTransfer& transfer :
+       load ? planned.loads : planned.stores) {
+    requests_.push_back({&transfer, step, load, 0});
+    Admit(requests_.size() - 1);
+  }
+  if (load) {
+    --pending_loads_[step];
+    TryCompute();
+  }
+}
+
+void Simulation::Admit(size_t request) {
+  if (occupied_ >= options_.dma_queue_depth) {
+    queue_.push_back(request);
+    return;
+  }
+  Occupy(1);
+  ++transfers_;
+  Post(now_ + requests_[request].transfer->setup, EventKind::kSetupDone,
+       request);
+}
+
+void Simulation::EnterPhase(size_t request) {
+  const Request& state = requests_[request];
+  if (state.phase == state.transfer->num_phases) {
+    Finish(request);
+    return;
+  }
+  LinkState& link = links_[state.transfer->phases[state.phase].link];
+  if (link.busy) {
+    link.waiting.push_back(request);
+  } else {
+    StartPhase(request);
+  }
+}
+
+void Simulation::StartPhase(size_t request) {
+  const Phase& phase = requests_[request].transfer->phases[
+      requests_[request].phase];
+  LinkState& link = links_[phase.link];
+  link.busy = true;
+  link.busy_time += phase.time;
+  Post(now_ + phase.time, EventKind::kPhaseDone, request);
+}
+
+void Simulation::Finish(size_t request) {
+  Occupy(-1);
+  if (!queue_.empty()) {
+    const size_t next = queue_.front();
+    queue_.pop_front();
+    Admit(next);
+  }
+  if (requests_[request].load) {
+    --pending_loads_[requests_[request].step];
+    TryCompute();
+  }
+}
+
+void Simulation::TryCompute() {
+  if (computing_ || next_compute_ == steps_->size() ||
+      pending_loads_[next_compute_] > 0) {
+    return;
+  }
+  const size_t step = next_compute_++;
+  computing_ = true;
+  // The pipeline fills from the start of the subgraph, alongside its
+  // first loads.
+  const double begin =
+      step == 0 ? std::max(now_, start_ + options_.pipeline_fill) : now_;
+  const double time = (*steps_)[step].compute_time;
+  compute_busy_ += time;
+  Post(begin + time, EventKind::kComputeDone, step);
+}
+
+}  // namespace
+
+absl::StatusOr<SimulationReport> Simulate(const Problem& problem,
+                                          const Solution& solution,
+                                          const SimulatorOptions& options) {
+  if (options.dma_queue_depth < 1 || options.step_buffers < 1) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "The DMA queue depth and the step buffers must be positive; got ",
+        options.dma_queue_depth, " and ", options.step_buffers));
+  }
+  if (options.pipeline_fill < 0.0 || options.pipeline_drain < 0.0 ||
+      options.barrier_latency < 0.0) {
+    return absl::InvalidArgumentError(
+        "Pipeline fill, drain and barrier latencies must be non-negative");
+  }
+  SimulationReport report;
+  Replayer replayer(problem);
+  const absl::StatusOr<TotalLatency> roofline = replayer.Evaluate(solution);
+  if (!roofline.ok()) return roofline.status();
+  report.roofline_latency = *roofline;
+  absl::StatusOr<std::vector<SubgraphLatency>> latencies =
+      replayer.SubgraphLatencies(solution);
+  if (!latencies.ok()) return latencies.status();
+  report.roofline_subgraph_latencies = *std::move(latencies);
+
+  const Planner planner(problem);
+  std::vector<std::vector<PlannedStep>> steps(solution.subgraphs.size());
+  if (absl::Status status = replayer.Replay(
+          solution,
+          [&](const Step& step) {
+            steps[step.subgraph].push_back(planner.Plan(step));
+          });
+      !status.ok()) {
+    return status;
+  }
+
+  Simulation simulation(options);
+  double time = 0.0;
+  for (size_t index = 0; index < steps.size(); ++index) {
+    if (index > 0) time += options.barrier_latency;
+    const double end = simulation.Run(steps[index], time);
+    report.subgraph_latencies.push_back(end - time);
+    time = end;
+  }
+  report.latency = time;
+  report.transfers = simulation.transfers();
+  const auto usage = [&](double busy_time) {
+    return ResourceUsage{busy_time, time > 0.0 ? busy_time / time : 0.0};
+  };
+  report.compute = usage(simulation.compute_busy());
+  report.slow_memory_link = usage(simulation.link_busy(kSlowLink));
+  report.middle_memory_link = usage(simulation.link_busy(kMiddleLink));
+  report.dma_queue = usage(simulation.queue_busy());
+  report.dma_queue.utilization /= options.dma_queue_depth;
+  return report;
+}
+
+}  // namespace mlsys
@@ -0,0 +1,94 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_SIMULATOR_H_
+#define MLSYS_SIMULATOR_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "mlsys.h"
+#include "third_party/absl/status/statusor.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Discrete-event simulation of a solution's steps.            /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// The pipeline effects the roofline model of Evaluate() leaves out.
+// Latencies are in the problem's time unit.
+struct SimulatorOptions {
+  // Transfers the DMA engine works on at once.  Each spends the problem's
+  // `dma_setup_latency` in its slot before moving data, so a deeper queue
+  // hides setup behind the data of the transfers ahead of it.
+  int dma_queue_depth = 4;
+  // Steps whose inputs may be in fast memory at once: with 2, the loads of
+  // a step are issued once the step two before it has computed (double
+  // buffering).
+  int step_buffers = 2;
+  // Before the first step of each subgraph computes, while the compute
+  // pipeline fills.
+  double pipeline_fill = 0.0;
+  // After the last step of each subgraph computes and before its results
+  // can be stored, while the pipeline drains.
+  double pipeline_drain = 0.0;
+  // Between the last transfer of a subgraph and the start of the next one.
+  double barrier_latency = 0.0;
+};
+
+// The time a resource is busy, and the fraction of the latency that is.
+struct ResourceUsage {
+  double busy_time = 0.0;
+  double utilization = 0.0;
+};
+
+struct SimulationReport {
+  TotalLatency latency = 0.0;
+  std::vector<SubgraphLatency> subgraph_latencies;
+  // Of Evaluate(), for comparison.
+  TotalLatency roofline_latency = 0.0;
+  std::vector<SubgraphLatency> roofline_subgraph_latencies;
+  ResourceUsage compute;
+  ResourceUsage slow_memory_link;
+  ResourceUsage middle_memory_link;  // Idle without a middle memory.
+  // Busy time counts occupied slots, so that the utilization is the mean
+  // occupancy of the queue relative to its depth.
+  ResourceUsage dma_queue;
+  int64_t transfers = 0;
+};
+
+// Simulates `solution` as events on four resources: a compute unit running
+// one step at a time, the slow and middle memory links each moving one
+// transfer at a time, and a DMA queue holding `dma_queue_depth` transfers.
+// Steps are those of Replayer::Replay(), with the same transfers and compute
+// time.  A step computes once its loads are done and the previous step has
+// computed; its stores are issued once it has computed.  Transfers take the
+// queue in the order they are issued, and the links in the order they reach
+// them; a transfer to or from slow memory crosses the middle memory link too
+// when there is one, and an input staged whole into middle memory is loaded
+// after staging as a single transfer.  Subgraphs run one after another, each
+// starting once everything of the previous one is done.
+//
+// Fails like Evaluate() on an invalid solution, and with INVALID_ARGUMENT on
+// options out of range.
+absl::StatusOr<SimulationReport> Simulate(const Problem& problem,
+                                          const Solution& solution,
+                                          const SimulatorOptions& options = {});
+
+}  // namespace mlsys
+
+#endif  // MLSYS_SIMULATOR_H_
@@ -0,0 +1,165 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "solution_cache.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "file_util.h"
+#include "fingerprint.h"
+#include "mlsys.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/synchronization/mutex.h"
+
+namespace mlsys {
+
+struct SolutionCache::Key {
+  std::string fingerprint;
+  Problem problem;  // As stored: canonical in isomorphic mode.
+  std::optional<Canonicalization> canonical;
+};
+
+namespace {
+
+// Empty for the contest's cost model, so that its entries keep their names.
+std::string EvaluateKey(const EvaluateOptions& options) {
+  const EvaluateOptions contest;
+  if (options.num_engines == contest.num_engines &&
+      options.bandwidth_sharing == contest.bandwidth_sharing &&
+      options.overlap_prefetch == contest.overlap_prefetch &&
+      options.repeated == contest.repeated) {
+    return "";
+  }
+  return absl::StrCat("num_engines=", options.num_engines,
+                      " bandwidth_sharing=",
+                      static_cast<int>(options.bandwidth_sharing),
+                      " overlap_prefetch=", options.overlap_prefetch,
+                      " repeated=", options.repeated);
+}
+
+}  // namespace
+
+SolutionCache::SolutionCache(std::string directory, bool isomorphic,
+                             EvaluateOptions evaluate)
+    : directory_(std::move(directory)),
+      isomorphic_(isomorphic),
+      evaluate_(std::move(evaluate)) {}
+
+SolutionCache::Key SolutionCache::MakeKey(const Problem& problem) const {
+  Key key;
+  if (isomorphic_) {
+    key.canonical = Canonicalize(problem);
+    key.problem = key.canonical->problem;
+  } else {
+    key.problem = problem;
+  }
+  key.fingerprint = ProblemFingerprint(key.problem);
+  if (const std::string evaluate = EvaluateKey(evaluate_); !evaluate.empty()) {
+    key.fingerprint =
+        Fingerprint128(absl::StrCat(key.fingerprint, "\n", evaluate));
+  }
+  return key;
+}
+
+std::optional<SolutionCache::Entry> SolutionCache::Load(const Key& key) const {
+  std::optional<Stored> stored;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (const auto it = memory_.find(key.fingerprint); it != memory_.end()) {
+      stored = it->second;
+    }
+  }
+  const bool from_disk = !stored.has_value();
+  if (from_disk) {
+    if (directory_.empty()) return std::nullopt;
+    const std::string prefix = absl::StrCat(directory_, "/", key.fingerprint);
+    const absl::StatusOr<std::string> problem_json =
+        ReadFile(absl::StrCat(prefix, ".problem.json"));
+    if (!problem_json.ok()) return std::nullopt;
+    absl::StatusOr<Problem> problem = ParseProblem(*problem_json);
+    if (!problem.ok()) return std::nullopt;
+    const absl::StatusOr<std::string> solution_json =
+        ReadFile(absl::StrCat(prefix, ".solution.json"));
+    if (!solution_json.ok()) return std::nullopt;
+    absl::StatusOr<Solution> solution = ParseSolution(*solution_json);
+    if (!solution.ok()) return std::nullopt;
+    stored = Stored{*std::move(problem), *std::move(solution)};
+  }
+  if (stored->problem != key.problem) return std::nullopt;
+  const absl::StatusOr<TotalLatency> latency =
+      Evaluate(stored->problem, stored->solution, evaluate_);
+  if (!latency.ok()) return std::nullopt;
+  if (from_disk) {
+    absl::MutexLock lock(&mutex_);
+    memory_.try_emplace(key.fingerprint, *stored);
+  }
+  return Entry{std::move(stored->solution), *latency};
+}
+
+std::optional<SolutionCache::Entry> SolutionCache::Lookup(
+    const Problem& problem) const {
+  const Key key = MakeKey(problem);
+  std::optional<Entry> entry = Load(key);
+  if (entry.has_value() && key.canonical.has_value()) {
+    entry->solution = FromCanonical(*key.canonical, entry->solution);
+  }
+  return entry;
+}
+
+absl::Status SolutionCache::Store(const Problem& problem,
+                                  const Solution& solution) const {
+  const Key key = MakeKey(problem);
+  const Solution stored = key.canonical.has_value()
+                              ? ToCanonical(*key.canonical, solution)
+                              : solution;
+  const absl::StatusOr<TotalLatency> latency =
+      Evaluate(key.problem, stored, evaluate_);
+  if (!latency.ok()) return latency.status();
+  if (const std::optional<Entry> existing = Load(key);
+      existing.has_value() && existing->latency <= *latency) {
+    return absl::OkStatus();
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    memory_.insert_or_assign(key.fingerprint, Stored{key.problem, stored});
+  }
+  if (directory_.empty()) return absl::OkStatus();
+
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  if (error) {
+    return absl::NotFoundError(
+        absl::StrCat("Cannot create ", directory_, ": ", error.message()));
+  }
+  // The problem goes first: a reader pairing it with an older solution
+  // re-evaluates that solution, which is merely suboptimal.
+  const std::string prefix = absl::StrCat(directory_, "/", key.fingerprint);
+  if (absl::Status status = WriteFile(absl::StrCat(prefix, ".problem.json"),
+                                      ProblemToJson(key.problem));
+      !status.ok()) {
+    return status;
+  }
+  return WriteFile(absl::StrCat(prefix, ".solution.json"),
+                   SolutionToJson(stored));
+}
+
+}  // namespace mlsys
@@ -0,0 +1,91 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_SOLUTION_CACHE_H_
+#define MLSYS_SOLUTION_CACHE_H_
+
+#include <optional>
+#include <string>
+
+#include "mlsys.h"
+#include "third_party/absl/base/thread_annotations.h"
+#include "third_party/absl/container/flat_hash_map.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/synchronization/mutex.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Persistent cache of the best solution known per problem.    /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// A directory of solved problems, keyed by content fingerprint.  Entry
+// `<fingerprint>` is the pair of files `<fingerprint>.problem.json` and
+// `<fingerprint>.solution.json`, each replaced atomically, so that several
+// processes may share the directory.  The stored problem is compared in full
+// on lookup; a hash collision or a stale entry is a miss, never a wrong
+// answer.  Entries read or written are also kept in memory, for the
+// benefit of long-lived processes; an empty `directory` keeps them only
+// there.
+//
+// With `isomorphic`, problems are keyed and stored in their canonical
+// numbering (see Canonicalize()), so that a problem whose ops and tensors
+// are merely renumbered hits the same entry; solutions are translated on the
+// way in and out.
+//
+// Solutions are evaluated under `evaluate`, which is part of the key unless
+// it is the contest's cost model: a solution found for one model is neither
+// returned for another nor compared against solutions found for it.
+class SolutionCache {
+ public:
+  SolutionCache(std::string directory, bool isomorphic,
+                EvaluateOptions evaluate = {});
+
+  struct Entry {
+    Solution solution;  // In the numbering of the queried problem.
+    TotalLatency latency;
+  };
+
+  // The cached solution to `problem`, re-evaluated against it; nullopt on a
+  // miss or if the stored solution no longer evaluates.
+  std::optional<Entry> Lookup(const Problem& problem) const;
+
+  // Records `solution` unless the cache already holds one at least as good.
+  // Fails if `solution` does not evaluate.
+  absl::Status Store(const Problem& problem, const Solution& solution) const;
+
+ private:
+  struct Key;
+  Key MakeKey(const Problem& problem) const;
+  std::optional<Entry> Load(const Key& key) const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  struct Stored {
+    Problem problem;
+    Solution solution;
+  };
+
+  const std::string directory_;
+  const bool isomorphic_;
+  const EvaluateOptions evaluate_;
+
+  mutable absl::Mutex mutex_;
+  mutable absl::flat_hash_map<std::string, Stored> memory_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mlsys
+
+#endif  // MLSYS_SOLUTION_CACHE_H_
@@ -0,0 +1,107 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Checks that cached solutions are kept apart per cost model.
+
+#include "solution_cache.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "mlsys.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/googletest/googletest/include/gtest/gtest.h"
+
+namespace mlsys {
+namespace {
+
+// Two independent Pointwise ops, which two engines can run side by side.
+Problem TwoOpProblem() {
+  absl::StatusOr<Problem> problem = ParseProblem(R"({
+    "widths": [128, 128, 128, 128],
+    "heights": [128, 128, 128, 128],
+    "inputs": [[0], [1]],
+    "outputs": [[2], [3]],
+    "base_costs": [1000, 1000],
+    "op_types": ["Pointwise", "Pointwise"],
+    "fast_memory_capacity": 100000,
+    "slow_memory_bandwidth": 10,
+    "native_granularity": [128, 128]
+  })");
+  EXPECT_TRUE(problem.ok()) << problem.status();
+  return *std::move(problem);
+}
+
+Solution OneOpPerEngine() {
+  Solution solution;
+  for (size_t op : {0, 1}) {
+    Subgraph& subgraph = solution.subgraphs.emplace_back();
+    subgraph.ops = {op};
+    subgraph.granularity = {128, 128, 1};
+    subgraph.engine = op;
+  }
+  return solution;
+}
+
+// An empty directory of its own for each test.
+std::string Directory(const std::string& name) {
+  const std::string directory =
+      absl::StrCat(testing::TempDir(), "/solution_cache_test_", name);
+  std::filesystem::remove_all(directory);
+  return directory;
+}
+
+TEST(SolutionCacheTest, RoundTripsMultiEngineSolutions) {
+  const Problem problem = TwoOpProblem();
+  const Solution solution = OneOpPerEngine();
+  EvaluateOptions evaluate;
+  evaluate.num_engines = 2;
+  const absl::StatusOr<TotalLatency> latency =
+      Evaluate(problem, solution, evaluate);
+  ASSERT_TRUE(latency.ok()) << latency.status();
+
+  const std::string directory = Directory("engines");
+  const SolutionCache cache(directory, false, evaluate);
+  ASSERT_TRUE(cache.Store(problem, solution).ok());
+  // A fresh cache reads the entry back from disk.
+  const std::optional<SolutionCache::Entry> entry =
+      SolutionCache(directory, false, evaluate).Lookup(problem);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->solution, solution);
+  EXPECT_DOUBLE_EQ(entry->latency, *latency);
+
+  EXPECT_FALSE(SolutionCache(directory, false).Lookup(problem).has_value());
+}
+
+TEST(SolutionCacheTest, KeysEntriesByCostModel) {
+  const Problem problem = TwoOpProblem();
+  Solution solution = OneOpPerEngine();
+  for (Subgraph& subgraph : solution.subgraphs) subgraph.engine.reset();
+  const std::string directory = Directory("repeated");
+  ASSERT_TRUE(SolutionCache(directory, false).Store(problem, solution).ok());
+
+  EvaluateOptions repeated;
+  repeated.repeated = true;
+  EXPECT_FALSE(
+      SolutionCache(directory, false, repeated).Lookup(problem).has_value());
+  EXPECT_TRUE(SolutionCache(directory, false).Lookup(problem).has_value());
+}
+
+}  // namespace
+}  // namespace mlsys
@@ -0,0 +1,1217 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "solver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "engine_scheduler.h"
+#include "granularity_sweep.h"
+#include "mlsys.h"
+#include "retention_planner.h"
+#include "roofline.h"
+#include "telemetry.h"
+#include "third_party/absl/container/flat_hash_map.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/synchronization/mutex.h"
+#include "third_party/absl/time/clock.h"
+#include "third_party/absl/time/time.h"
+#include "third_party/absl/types/span.h"
+
+namespace mlsys {
+
+namespace {
+
+enum Move { kMerge, kSplit, kRegranularize, kRetain, kTraversal, kNumMoves };
+enum Phase { kStart, kFusion, kRetention, kSearch, kVerify, kNumPhases };
+
+constexpr double kInfeasible = std::numeric_limits<double>::infinity();
+// Relative gains below this are rounding noise of summed step latencies.
+constexpr double kTolerance = 1e-9;
+
+bool Improves(double cost, double reference) {
+  return cost < reference * (1.0 - kTolerance);
+}
+constexpr size_t kMaxCacheEntries = 1 << 20;
+// Hill-climbing does not step to granularities needing more steps than this:
+// the search can price many candidates in the time a single very fine tiling
+// takes to replay.
+constexpr int64_t kMaxSteps = 1 << 14;
+
+int64_t CeilDiv(int64_t a, int64_t b) { return (a + b - 1) / b; }
+
+// Serpentine orders over a `rows x cols` grid, so that consecutive tiles share
+// a row strip (row-major) or a column strip (column-major).
+TraversalOrder RowSnake(int64_t rows, int64_t cols) {
+  TraversalOrder order;
+  order.reserve(rows * cols);
+  for (int64_t row = 0; row < rows; ++row) {
+    for (int64_t i = 0; i < cols; ++i) {
+      order.push_back(row * cols + (row % 2 == 0 ? i : cols - 1 - i));
+    }
+  }
+  return order;
+}
+
+TraversalOrder ColumnSnake(int64_t rows, int64_t cols) {
+  TraversalOrder order;
+  order.reserve(rows * cols);
+  for (int64_t col = 0; col < cols; ++col) {
+    for (int64_t i = 0; i < rows; ++i) {
+      order.push_back((col % 2 == 0 ? i : rows - 1 - i) * cols + col);
+    }
+  }
+  return order;
+}
+
+// Candidate tile sizes along one dimension: the native size times powers of
+// two (including fractions, for when nothing else fits) below the full
+// extent, plus the full extent itself.
+std::vector<int64_t> TileSizes(int64_t extent, int64_t native) {
+  std::vector<int64_t> sizes;
+  for (int64_t size = native / 2; size >= 1; size /= 2) {
+    if (size < extent) sizes.push_back(size);
+  }
+  for (int64_t size = std::max<int64_t>(native, 1); size < extent;
+       size *= 2) {
+    sizes.push_back(size);
+  }
+  sizes.push_back(extent);
+  std::sort(sizes.begin(), sizes.end());
+  sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+  return sizes;
+}
+
+// The index of the largest candidate not above `value`.
+size_t Nearest(const std::vector<int64_t>& sizes, int64_t value) {
+  size_t index = 0;
+  while (index + 1 < sizes.size() && sizes[index + 1] <= value) ++index;
+  return index;
+}
+
+}  // namespace
+
+// Names indexed by Move and Phase.
+std::unique_ptr<Telemetry> NewSolverTelemetry() {
+  return std::make_unique<Telemetry>(
+      std::vector<std::string>{"merge", "split", "regranularize", "retain",
+                               "traversal"},
+      std::vector<std::string>{"start", "fusion", "retention", "search",
+                               "verify"});
+}
+
+// One search thread.  Owns a replayer, a cost cache and a schedule: the
+// subgraphs in execution order, each costed given the tensors retained by
+// its predecessor.
+//
+// Under overlap_prefetch, a group is further credited with the latency its
+// first step hides behind the last step of its predecessor.  Both ends are
+// taken from replays in isolation, so a prefetch that widens the slack of a
+// single-step group is not passed on to the next: the schedule's cost is a
+// slight overestimate, which Verify() settles.
+class Solver::Search {
+ public:
+  Search(Solver* solver, int index);
+
+  absl::Status Start(absl::Time deadline);
+  void StartFrom(const Search& other);
+  void Run(absl::Time deadline);
+
+ private:
+  // The first and last steps of a group, as far as overlap_prefetch goes.
+  struct Ends {
+    double head_compute = 0.0;
+    double head_in = 0.0;
+    double head_out = 0.0;
+    int64_t head_loaded = 0;
+    // Loads of the first step from op results, which the predecessor may be
+    // the one writing.
+    std::vector<std::pair<size_t, int64_t>> head_results;
+    double tail_slack = 0.0;
+    int64_t tail_free = 0;
+  };
+
+  struct Group {
+    std::vector<size_t> ops;     // In topological order.
+    Granularity granularity = {};
+    std::vector<size_t> retain;  // Sorted.
+    bool column_major = false;   // Serpentine over columns, else over rows.
+    double cost = 0.0;
+    Ends ends;
+    double credit = 0.0;  // Hidden by prefetching; see the class comment.
+  };
+
+  struct Priced {
+    double cost;
+    Ends ends;
+  };
+
+  // The groups [begin, end) of the schedule are to be replaced by `window`.
+  struct Proposal {
+    Move move;
+    size_t begin;
+    size_t end;
+    std::vector<Group> window;
+  };
+
+  // Whether `deadline` has passed or the solver was cancelled.
+  bool Stopped(absl::Time deadline) const;
+
+  bool AdoptSolution(const Solution& solution);
+  bool SingleOpSchedule();
+  void Fuse(absl::Time deadline);
+  void Retain(absl::Time deadline);
+
+  std::optional<Proposal> ProposeMerge(size_t first, bool thorough);
+  std::optional<Proposal> ProposeSplit();
+  std::optional<Proposal> ProposeRegranularize();
+  std::optional<Proposal> ProposeRetain(size_t first,
+                                        std::optional<size_t> tensor);
+  std::optional<Proposal> ProposeTraversal();
+  // Prices `proposal` and applies it if `accept(delta)` holds.
+  template <typename Accept>
+  bool Apply(Proposal proposal, Accept accept);
+
+  // Also leaves the group's ends in `ends_`.
+  double Cost(const Group& group, absl::Span<const size_t> resident);
+  // The latency a group with first step `next` saves by prefetching during
+  // the last step of `previous`.
+  double Credit(const Group& previous, const Ends& next);
+  // The tensors retained for the group at `index` by its predecessor, which
+  // for the first group under EvaluateOptions::repeated is the last one.
+  absl::Span<const size_t> Resident(size_t index) const;
+  bool OptimizeGranularity(Group* group, absl::Span<const size_t> resident,
+                           bool thorough, int64_t max_steps = kMaxSteps);
+  Subgraph ToSubgraph(const Group& group);
+  Solution ToSolution();
+  void Publish();
+  // Verifies `solution` end to end and offers it to the solver.
+  void Verify(Solution solution);
+
+  uint32_t Tag(const Group& group);
+  bool Closed(const Group& group);
+  bool Retainable(size_t tensor, uint32_t group, uint32_t next) const;
+  bool Wrappable(size_t tensor, uint32_t group, uint32_t next) const;
+  // With `wrap`, `group` is the last of the schedule and `next` the first,
+  // possibly the same group, under EvaluateOptions::repeated.
+  void FixRetain(Group* group, const Group& next, bool wrap = false);
+  std::vector<size_t> RetainCandidates(const Group& group, const Group& next,
+                                       bool wrap = false);
+  void OutputGrid(const Group& group, Width* width, Height* height,
+                  Depth* reduction);
+  // The finest native granularity among the group's ops.
+  Granularity Native(const Group& group) const;
+
+  size_t Uniform(size_t n) {
+    return std::uniform_int_distribution<size_t>(0, n - 1)(random_);
+  }
+  double UniformReal() {
+    return std::uniform_real_distribution<double>(0.0, 1.0)(random_);
+  }
+
+  Solver* solver_;
+  const Problem& problem_;
+  Replayer replayer_;
+  std::mt19937_64 random_;
+  TelemetryCounters local_counters_;
+  TelemetryCounters* counters_;
+
+  std::vector<int64_t> producer_;               // Per tensor.
+  std::vector<std::vector<size_t>> consumers_;  // Per tensor.
+  std::vector<size_t> rank_;                    // Per op.
+  std::vector<uint32_t> mark_;                  // Per op, see Tag().
+  uint32_t epoch_ = 0;
+
+  absl::flat_hash_map<std::string, Priced> cache_;
+  std::string key_;
+  Ends ends_;
+  std::vector<Granularity> candidates_;  // See OptimizeGranularity().
+
+  std::vector<Group> groups_;
+  double cost_ = 0.0;
+  double best_cost_ = kInfeasible;
+};
+
+Solver::Search::Search(Solver* solver, int index)
+    : solver_(solver),
+      problem_(solver->problem_),
+      replayer_(solver->problem_, solver->options_.evaluate),
+      random_(solver->options_.seed + index),
+      counters_(solver->options_.telemetry != nullptr
+                    ? solver->options_.telemetry->NewThread()
+                    : &local_counters_),
+      producer_(problem_.tensors.size(), -1),
+      consumers_(problem_.tensors.size()),
+      rank_(problem_.ops.size(), 0),
+      mark_(problem_.ops.size(), 0) {
+  for (size_t op = 0; op < problem_.ops.size(); ++op) {
+    for (size_t tensor : problem_.ops[op].outputs) producer_[tensor] = op;
+    for (size_t tensor : problem_.ops[op].inputs) {
+      consumers_[tensor].push_back(op);
+    }
+  }
+  // Kahn's algorithm; ranks give a topological order of all ops.
+  std::vector<size_t> pending(problem_.ops.size(), 0);
+  for (size_t op = 0; op < problem_.ops.size(); ++op) {
+    for (size_t tensor : problem_.ops[op].inputs) {
+      if (producer_[tensor] >= 0) ++pending[op];
+    }
+  }
+  std::vector<size_t> order;
+  for (size_t op = 0; op < problem_.ops.size(); ++op) {
+    if (pending[op] == 0) order.push_back(op);
+  }
+  for (size_t i = 0; i < order.size(); ++i) {
+    rank_[order[i]] = i;
+    for (size_t tensor : problem_.ops[order[i]].outputs) {
+      for (size_t consumer : consumers_[tensor]) {
+        if (--pending[consumer] == 0) order.push_back(consumer);
+      }
+    }
+  }
+}
+
+uint32_t Solver::Search::Tag(const Group& group) {
+  ++epoch_;
+  for (size_t op : group.ops) mark_[op] = epoch_;
+  return epoch_;
+}
+
+// An op result consumed inside its group never reaches slow memory, so all
+// of its consumers must be in the group too.
+bool Solver::Search::Closed(const Group& group) {
+  const uint32_t tag = Tag(group);
+  for (size_t op : group.ops) {
+    for (size_t tensor : problem_.ops[op].outputs) {
+      bool inside = false;
+      bool outside = false;
+      for (size_t consumer : consumers_[tensor]) {
+        (mark_[consumer] == tag ? inside : outside) = true;
+      }
+      if (inside && outside) return false;
+    }
+  }
+  return true;
+}
+
+// Whether the group tagged `group` may keep `tensor` in fast memory for the
+// group tagged `next`.  It must be a boundary tensor of the former and an
+// input of the latter.  A retained result is never written back, so the
+// latter must also hold all of its consumers.
+bool Solver::Search::Retainable(size_t tensor, uint32_t group,
+                                uint32_t next) const {
+  const int64_t producer = producer_[tensor];
+  const bool produced = producer >= 0 && mark_[producer] == group;
+  bool consumed = false;
+  bool consumed_next = false;
+  bool consumed_elsewhere = false;
+  for (size_t consumer : consumers_[tensor]) {
+    if (mark_[consumer] == group) {
+      consumed = true;
+    } else if (mark_[consumer] == next) {
+      consumed_next = true;
+    } else {
+      consumed_elsewhere = true;
+    }
+  }
+  if (!consumed_next) return false;
+  if (produced) return !consumed && !consumed_elsewhere;
+  return consumed;
+}
+
+// Whether the last group, tagged `group`, may keep `tensor` in fast memory
+// for the first group of the next iteration, tagged `next`: a weight both of
+// them consume.
+bool Solver::Search::Wrappable(size_t tensor, uint32_t group,
+                               uint32_t next) const {
+  if (!replayer_.IsWeight(tensor)) return false;
+  bool consumed = false;
+  bool consumed_next = false;
+  for (size_t consumer : consumers_[tensor]) {
+    consumed |= mark_[consumer] == group;
+    consumed_next |= mark_[consumer] == next;
+  }
+  return consumed && consumed_next;
+}
+
+void Solver::Search::FixRetain(Group* group, const Group& next, bool wrap) {
+  if (group->retain.empty()) return;
+  const uint32_t tag = Tag(*group);
+  const uint32_t next_tag = &next == group ? tag : Tag(next);
+  std::erase_if(group->retain, [&](size_t tensor) {
+    return wrap ? !Wrappable(tensor, tag, next_tag)
+                : !Retainable(tensor, tag, next_tag);
+  });
+}
+
+std::vector<size_t> Solver::Search::RetainCandidates(const Group& group,
+                                                     const Group& next,
+                                                     bool wrap) {
+  const uint32_t tag = Tag(group);
+  const uint32_t next_tag = &next == &group ? tag : Tag(next);
+  std::vector<size_t> candidates;
+  for (size_t op : next.ops) {
+    for (size_t tensor : problem_.ops[op].inputs) {
+      if (wrap ? Wrappable(tensor, tag, next_tag)
+               : Retainable(tensor, tag, next_tag)) {
+        candidates.push_back(tensor);
+      }
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                   candidates.end());
+  return candidates;
+}
+
+// The extent of the group's output grid and the longest reduction among its
+// MatMuls and Reductions (zero without any).
+void Solver::Search::OutputGrid(const Group& group, Width* width,
+                                Height* height, Depth* reduction) {
+  const uint32_t tag = Tag(group);
+  *width = 1;
+  *height = 1;
+  *reduction = 0;
+  for (size_t op : group.ops) {
+    const Op& spec = problem_.ops[op];
+    *reduction = std::max(*reduction, ReductionDepth(problem_, spec));
+    for (size_t tensor : spec.outputs) {
+      const bool internal =
+          std::any_of(consumers_[tensor].begin(), consumers_[tensor].end(),
+                      [&](size_t consumer) { return mark_[consumer] == tag; });
+      if (internal) continue;
+      *width = std::max(*width, problem_.tensors[tensor].width);
+      *height = std::max(*height, problem_.tensors[tensor].height);
+    }
+  }
+}
+
+Granularity Solver::Search::Native(const Group& group) const {
+  Granularity native = NativeGranularity(problem_,
+                                         problem_.ops[group.ops[0]].op_type);
+  for (size_t op : group.ops) {
+    const Granularity& op_native =
+        NativeGranularity(problem_, problem_.ops[op].op_type);
+    native.width = std::min(native.width, op_native.width);
+    native.height = std::min(native.height, op_native.height);
+  }
+  return native;
+}
+
+Subgraph Solver::Search::ToSubgraph(const Group& group) {
+  Subgraph subgraph{group.ops, group.retain, group.granularity, std::nullopt,
+                    group.cost};
+  Width width;
+  Height height;
+  Depth reduction;
+  OutputGrid(group, &width, &height, &reduction);
+  const int64_t rows = CeilDiv(height, group.granularity.height);
+  const int64_t cols = CeilDiv(width, group.granularity.width);
+  if (rows * cols > 1) {
+    subgraph.traversal_order =
+        group.column_major ? ColumnSnake(rows, cols) : RowSnake(rows, cols);
+  }
+  return subgraph;
+}
+
+double Solver::Search::Cost(const Group& group,
+                            absl::Span<const size_t> resident) {
+  key_.clear();
+  const auto append = [&](int64_t value) {
+    key_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+  append(group.ops.size());
+  for (size_t op : group.ops) append(op);
+  append(group.granularity.width);
+  append(group.granularity.height);
+  append(group.granularity.depth);
+  append(group.column_major);
+  append(group.retain.size());
+  for (size_t tensor : group.retain) append(tensor);
+  for (size_t tensor : resident) append(tensor);
+  if (const auto it = cache_.find(key_); it != cache_.end()) {
+    counters_->CountCacheHit();
+    ends_ = it->second.ends;
+    return it->second.cost;
+  }
+  counters_->CountCacheMiss();
+  counters_->CountEvaluation();
+  const bool overlap = replayer_.options().overlap_prefetch;
+  ends_ = Ends();
+  SubgraphLatency latency = 0.0;
+  const absl::Status status = replayer_.ReplaySubgraph(
+      0, ToSubgraph(group), resident, [&](const Step& step) {
+        latency += step.latency;
+        if (!overlap) return;
+        if (step.position == 0 && step.k_step == 0) {
+          ends_.head_compute = step.compute_time;
+          ends_.head_in = step.memory_in_time;
+          ends_.head_out = step.memory_out_time;
+          for (const Transfer& load : step.loads) {
+            const int64_t bytes = TransferBytes(problem_, load);
+            ends_.head_loaded += bytes;
+            if (producer_[load.tensor] >= 0) {
+              ends_.head_results.emplace_back(load.tensor, bytes);
+            }
+          }
+        }
+        ends_.tail_slack =
+            std::max(0.0, step.compute_time - step.memory_in_time -
+                              step.memory_out_time);
+        ends_.tail_free = replayer_.capacity() - step.working_set;
+      });
+  if (cache_.size() >= kMaxCacheEntries) cache_.clear();
+  Priced& priced = cache_[key_];
+  priced.cost = status.ok() ? latency : kInfeasible;
+  priced.ends = ends_;
+  return priced.cost;
+}
+
+double Solver::Search::Credit(const Group& previous, const Ends& next) {
+  if (!replayer_.options().overlap_prefetch) return 0.0;
+  const uint32_t tag = Tag(previous);
+  int64_t prefetchable = next.head_loaded;
+  for (const auto& [tensor, size] : next.head_results) {
+    if (mark_[producer_[tensor]] == tag) prefetchable -= size;
+  }
+  const double prefetch =
+      PrefetchTime(problem_, prefetchable, previous.ends.tail_slack,
+                   previous.ends.tail_free);
+  return std::max(next.head_compute, next.head_in + next.head_out) -
+         std::max(next.head_compute,
+                  next.head_in - prefetch + next.head_out);
+}
+
+// Hill-climbs over the candidate granularities, one dimension and one
+// candidate at a time, from the group's current granularity.  A thorough
+// search takes the best neighbour at every step; otherwise the first
+// improving one.  Fails if nothing taking at most `max_steps` steps fits.
+//
+// A quick search of a group that runs alone, retaining nothing and with
+// nothing resident, may instead start from the fastest of all the candidates
+// as SweepGranularities() scores them in closed form.  The sweep walks the
+// tiles in raster order rather than the group's serpentine, so its pick is
+// taken only if the replay finds it faster, and the climb goes on by replay.
+// Thorough searches keep their own start: the single-op schedule fusion
+// starts from would otherwise be tuned to each op alone, which leaves fewer
+// merges that pay off.
+bool Solver::Search::OptimizeGranularity(Group* group,
+                                         absl::Span<const size_t> resident,
+                                         bool thorough, int64_t max_steps) {
+  Width width;
+  Height height;
+  Depth reduction;
+  OutputGrid(*group, &width, &height, &reduction);
+  const Granularity native = Native(*group);
+  const std::vector<int64_t> sizes[3] = {
+      TileSizes(width, native.width), TileSizes(height, native.height),
+      reduction > 0 ? TileSizes(reduction, 1) : std::vector<int64_t>{1}};
+  size_t index[3] = {Nearest(sizes[0], group->granularity.width),
+                     Nearest(sizes[1], group->granularity.height),
+                     Nearest(sizes[2], group->granularity.depth)};
+  const auto price = [&](const size_t (&at)[3]) {
+    group->granularity = {sizes[0][at[0]], sizes[1][at[1]], sizes[2][at[2]]};
+    return Cost(*group, resident);
+  };
+
+  const auto steps = [&](const size_t (&at)[3]) {
+    return CeilDiv(width, sizes[0][at[0]]) * CeilDiv(height, sizes[1][at[1]]) *
+           std::max<int64_t>(1, CeilDiv(reduction, sizes[2][at[2]]));
+  };
+
+  // Every spatial tile stores its slice of each output the group does not
+  // retain, and each store pays the DMA setup latency, so the tile count
+  // alone bounds the cost from below.  Granularities whose bound already
+  // loses are not replayed.
+  const double setup = problem_.dma_setup_latency.value_or(0.0);
+  std::vector<const Tensor*> stored;
+  if (setup > 0.0) {
+    const uint32_t tag = Tag(*group);
+    for (size_t op : group->ops) {
+      for (size_t tensor : problem_.ops[op].outputs) {
+        if (std::none_of(
+                consumers_[tensor].begin(), consumers_[tensor].end(),
+                [&](size_t consumer) { return mark_[consumer] == tag; }) &&
+            !std::binary_search(group->retain.begin(), group->retain.end(),
+                                tensor)) {
+          stored.push_back(&problem_.tensors[tensor]);
+        }
+      }
+    }
+  }
+  const auto setup_bound = [&](const size_t (&at)[3]) {
+    const int64_t tile_width = sizes[0][at[0]];
+    const int64_t tile_height = sizes[1][at[1]];
+    int64_t stores = 0;
+    for (const Tensor* tensor : stored) {
+      // A broadcast dimension is stored again for every tile along it.
+      stores += CeilDiv(tensor->width == 1 ? width : tensor->width,
+                        tile_width) *
+                CeilDiv(tensor->height == 1 ? height : tensor->height,
+                        tile_height);
+    }
+    return stores * setup;
+  };
+  const auto price_within_budget = [&](const size_t (&at)[3], double bound) {
+    if (steps(at) > max_steps || setup_bound(at) >= bound) return kInfeasible;
+    return price(at);
+  };
+
+  // Too fine a start is replaced by the coarsest granularity, which the loop
+  // below then shrinks until it fits.
+  if (steps(index) > max_steps) {
+    for (int dim = 0; dim < 3; ++dim) index[dim] = sizes[dim].size() - 1;
+  }
+  double cost = price(index);
+  // Out of fast memory: shrink the reduction, then the larger tile side.
+  while (cost == kInfeasible) {
+    if (index[2] > 0) {
+      --index[2];
+    } else if (index[0] > 0 && (index[0] >= index[1] || index[1] == 0)) {
+      --index[0];
+    } else if (index[1] > 0) {
+      --index[1];
+    } else {
+      return false;
+    }
+    if (steps(index) > max_steps) return false;
+    cost = price(index);
+  }
+
+  if (!thorough && group->retain.empty() && resident.empty() &&
+      replayer_.capacity() == problem_.fast_memory_capacity) {
+    if (const absl::StatusOr<SubgraphBoundary> boundary =
+            DescribeBoundary(problem_, group->ops);
+        boundary.ok()) {
+      candidates_.clear();
+      size_t at[3];
+      for (at[0] = 0; at[0] < sizes[0].size(); ++at[0]) {
+        for (at[1] = 0; at[1] < sizes[1].size(); ++at[1]) {
+          for (at[2] = 0; at[2] < sizes[2].size(); ++at[2]) {
+            if (steps(at) > max_steps) continue;
+            candidates_.push_back(
+                {sizes[0][at[0]], sizes[1][at[1]], sizes[2][at[2]]});
+          }
+        }
+      }
+      const int64_t fastest =
+          Fastest(SweepGranularities(problem_, *boundary, candidates_));
+      if (fastest >= 0) {
+        const Granularity& pick = candidates_[fastest];
+        const size_t swept[3] = {Nearest(sizes[0], pick.width),
+                                 Nearest(sizes[1], pick.height),
+                                 Nearest(sizes[2], pick.depth)};
+        if (const double swept_cost = price_within_budget(swept, cost);
+            Improves(swept_cost, cost)) {
+          std::copy(swept, swept + 3, index);
+          cost = swept_cost;
+        }
+      }
+    }
+  }
+
+  for (bool improved = true; improved;) {
+    improved = false;
+    size_t best[3] = {index[0], index[1], index[2]};
+    double best_cost = cost;
+    for (int dim = 0; dim < 3 && (thorough || !improved); ++dim) {
+      for (int step : {-1, 1}) {
+        size_t next[3] = {index[0], index[1], index[2]};
+        if ((step < 0 && next[dim] == 0) ||
+            (step > 0 && next[dim] + 1 == sizes[dim].size())) {
+          continue;
+        }
+        next[dim] += step;
+        if (const double next_cost = price_within_budget(next, best_cost);
+            Improves(next_cost, best_cost)) {
+          std::copy(next, next + 3, best);
+          best_cost = next_cost;
+          improved = true;
+          if (!thorough) break;
+        }
+      }
+    }
+    std::copy(best, best + 3, index);
+    cost = best_cost;
+  }
+  price(index);
+  group->cost = cost;
+  group->ends = ends_;
+  return true;
+}
+
+absl::Span<const size_t> Solver::Search::Resident(size_t index) const {
+  if (index > 0) return groups_[index - 1].retain;
+  if (replayer_.options().repeated && !groups_.empty()) {
+    return groups_.back().retain;
+  }
+  return {};
+}
+
+template <typename Accept>
+bool Solver::Search::Apply(Proposal proposal, Accept accept) {
+  counters_->CountProposal(proposal.move);
+  std::vector<Group>& window = proposal.window;
+  // The previous group may have to stop retaining tensors the window moved
+  // away from it, which changes its cost as well.
+  size_t begin = proposal.begin;
+  if (begin > 0) {
+    --begin;
+    window.insert(window.begin(), groups_[begin]);
+  }
+  const size_t end = proposal.end;
+  const bool repeated = replayer_.options().repeated;
+  for (size_t i = 0; i + 1 < window.size(); ++i) {
+    FixRetain(&window[i], window[i + 1]);
+  }
+  if (end < groups_.size()) {
+    FixRetain(&window.back(), groups_[end]);
+  } else if (repeated) {
+    FixRetain(&window.back(), begin == 0 ? window.front() : groups_[0], true);
+  } else {
+    window.back().retain.clear();
+  }
+
+  absl::Span<const size_t> resident = Resident(begin);
+  if (repeated && begin == 0 && end == groups_.size()) {
+    resident = window.back().retain;
+  }
+  const Group* previous = begin > 0 ? &groups_[begin - 1] : nullptr;
+  double before = 0.0;
+  for (size_t i = begin; i < end; ++i) {
+    before += groups_[i].cost - groups_[i].credit;
+  }
+  double after = 0.0;
+  for (Group& group : window) {
+    group.cost = Cost(group, resident);
+    if (group.cost == kInfeasible) return false;
+    group.ends = ends_;
+    group.credit = previous != nullptr ? Credit(*previous, group.ends) : 0.0;
+    after += group.cost - group.credit;
+    resident = group.retain;
+    previous = &group;
+  }
+  double next_cost = 0.0;
+  Ends next_ends;
+  double next_credit = 0.0;
+  if (end < groups_.size()) {
+    before += groups_[end].cost - groups_[end].credit;
+    if (window.back().retain == groups_[end - 1].retain) {
+      next_cost = groups_[end].cost;
+      next_ends = groups_[end].ends;
+    } else {
+      next_cost = Cost(groups_[end], resident);
+      next_ends = ends_;
+    }
+    if (next_cost == kInfeasible) return false;
+    next_credit = Credit(window.back(), next_ends);
+    after += next_cost - next_credit;
+  }
+  // Likewise the first group, when the window ends the schedule and changes
+  // what wraps around to it.
+  const bool rewrap = repeated && begin > 0 && end == groups_.size() &&
+                      window.back().retain != groups_.back().retain;
+  double first_cost = 0.0;
+  Ends first_ends;
+  if (rewrap) {
+    before += groups_[0].cost;
+    first_cost = Cost(groups_[0], window.back().retain);
+    if (first_cost == kInfeasible) return false;
+    first_ends = ends_;
+    after += first_cost;
+  }
+  if (!accept(after - before)) return false;
+
+  counters_->CountAccept(proposal.move);
+  if (end < groups_.size()) {
+    groups_[end].cost = next_cost;
+    groups_[end].ends = std::move(next_ends);
+    groups_[end].credit = next_credit;
+  }
+  if (rewrap) {
+    groups_[0].cost = first_cost;
+    groups_[0].ends = std::move(first_ends);
+  }
+  groups_.erase(groups_.begin() + begin, groups_.begin() + end);
+  groups_.insert(groups_.begin() + begin,
+                 std::make_move_iterator(window.begin()),
+                 std::make_move_iterator(window.end()));
+  cost_ += after - before;
+  return true;
+}
+
+std::optional<Solver::Search::Proposal> Solver::Search::ProposeMerge(
+    size_t first, bool thorough) {
+  if (first + 1 >= groups_.size()) return std::nullopt;
+  const Group& a = groups_[first];
+  const Group& b = groups_[first + 1];
+  Group merged;
+  merged.ops = a.ops;
+  merged.ops.insert(merged.ops.end(), b.ops.begin(), b.ops.end());
+  std::sort(merged.ops.begin(), merged.ops.end(),
+            [&](size_t x, size_t y) { return rank_[x] < rank_[y]; });
+  if (!Closed(merged)) return std::nullopt;
+  const Group& seed = a.cost > b.cost ? a : b;
+  merged.granularity = seed.granularity;
+  merged.column_major = seed.column_major;
+  merged.retain = b.retain;
+  if (first + 2 < groups_.size()) FixRetain(&merged, groups_[first + 2]);
+  const absl::Span<const size_t> resident = Resident(first);
+  if (!OptimizeGranularity(&merged, resident, thorough)) return std::nullopt;
+  Proposal proposal{kMerge, first, first + 2, {}};
+  proposal.window.push_back(std::move(merged));
+  return proposal;
+}
+
+std::optional<Solver::Search::Proposal> Solver::Search::ProposeSplit() {
+  const size_t index = Uniform(groups_.size());
+  const Group& group = groups_[index];
+  if (group.ops.size() < 2) return std::nullopt;
+  // Ops are in topological order, so any prefix can run before the rest.
+  const size_t cut = 1 + Uniform(group.ops.size() - 1);
+  Group head{{group.ops.begin(), group.ops.begin() + cut},
+             group.granularity, {}, group.column_major, 0.0, {}, 0.0};
+  Group tail{{group.ops.begin() + cut, group.ops.end()},
+             group.granularity,
+             group.retain,
+             group.column_major,
+             0.0,
+             {},
+             0.0};
+  if (!Closed(head) || !Closed(tail)) return std::nullopt;
+  const absl::Span<const size_t> resident = Resident(index);
+  if (!OptimizeGranularity(&head, resident, false)) return std::nullopt;
+  if (!OptimizeGranularity(&tail, {}, false)) return std::nullopt;
+  Proposal proposal{kSplit, index, index + 1, {}};
+  proposal.window.push_back(std::move(head));
+  proposal.window.push_back(std::move(tail));
+  return proposal;
+}
+
+std::optional<Solver::Search::Proposal>
+Solver::Search::ProposeRegranularize() {
+  const size_t index = Uniform(groups_.size());
+  Group group = groups_[index];
+  const absl::Span<const size_t> resident = Resident(index);
+  if (UniformReal() < 0.25) {
+    if (!OptimizeGranularity(&group, resident, true)) return std::nullopt;
+  } else {
+    // A random step of one dimension, halving or doubling.
+    Granularity& granularity = group.granularity;
+    int64_t* dims[3] = {&granularity.width, &granularity.height,
+                        &granularity.depth};
+    int64_t& dim = *dims[Uniform(3)];
+    if (UniformReal() < 0.5) {
+      if (dim == 1) return std::nullopt;
+      dim = (dim + 1) / 2;
+    } else {
+      dim *= 2;
+    }
+  }
+  if (group.granularity == groups_[index].granularity) return std::nullopt;
+  Proposal proposal{kRegranularize, index, index + 1, {}};
+  proposal.window.push_back(std::move(group));
+  return proposal;
+}
+
+std::optional<Solver::Search::Proposal> Solver::Search::ProposeRetain(
+    size_t first, std::optional<size_t> tensor) {
+  const bool wrap = first + 1 == groups_.size();
+  if (wrap && !replayer_.options().repeated) return std::nullopt;
+  Group group = groups_[first];
+  if (!tensor.has_value()) {
+    const std::vector<size_t> candidates = RetainCandidates(
+        groups_[first], groups_[wrap ? 0 : first + 1], wrap);
+    if (candidates.empty()) return std::nullopt;
+    tensor = candidates[Uniform(candidates.size())];
+  }
+  const auto it =
+      std::lower_bound(group.retain.begin(), group.retain.end(), *tensor);
+  if (it != group.retain.end() && *it == *tensor) {
+    group.retain.erase(it);
+  } else {
+    group.retain.insert(it, *tensor);
+  }
+  Proposal proposal{kRetain, first, first + 1, {}};
+  proposal.window.push_back(std::move(group));
+  return proposal;
+}
+
+std::optional<Solver::Search::Proposal> Solver::Search::ProposeTraversal() {
+  const size_t index = Uniform(groups_.size());
+  Group group = groups_[index];
+  group.column_major = !group.column_major;
+  Proposal proposal{kTraversal, index, index + 1, {}};
+  proposal.window.push_back(std::move(group));
+  return proposal;
+}
+
+bool Solver::Search::AdoptSolution(const Solution& solution) {
+  std::vector<Group> groups;
+  for (const Subgraph& subgraph : solution.subgraphs) {
+    Group& group = groups.emplace_back();
+    group.ops = subgraph.ops;
+    std::sort(group.ops.begin(), group.ops.end(),
+              [&](size_t x, size_t y) { return rank_[x] < rank_[y]; });
+    group.granularity = subgraph.granularity;
+    // The search only retains in fast memory; the retention planner puts
+    // tensors in middle memory again.
+    for (size_t i = 0; i < subgraph.tensors_to_retain.size(); ++i) {
+      if (RetentionLevel(subgraph, i) == MemoryLevel::kFast) {
+        group.retain.push_back(subgraph.tensors_to_retain[i]);
+      }
+    }
+    std::sort(group.retain.begin(), group.retain.end());
+    if (subgraph.traversal_order.has_value() &&
+        subgraph.traversal_order->size() > 1) {
+      // Column-major if the second tile visited lies below the first.
+      const TraversalOrder& order = *subgraph.traversal_order;
+      group.column_major = order[1] != order[0] + 1 && order[1] != order[0] - 1;
+    }
+    if (!Closed(group)) return false;
+  }
+  for (size_t i = 0; i + 1 < groups.size(); ++i) {
+    FixRetain(&groups[i], groups[i + 1]);
+  }
+  const bool repeated = replayer_.options().repeated;
+  if (!groups.empty()) {
+    if (repeated) {
+      FixRetain(&groups.back(), groups.front(), true);
+    } else {
+      groups.back().retain.clear();
+    }
+  }
+  double cost = 0.0;
+  absl::Span<const size_t> resident;
+  if (repeated && !groups.empty()) resident = groups.back().retain;
+  for (size_t i = 0; i < groups.size(); ++i) {
+    Group& group = groups[i];
+    group.cost = Cost(group, resident);
+    if (group.cost == kInfeasible) return false;
+    group.ends = ends_;
+    group.credit = i > 0 ? Credit(groups[i - 1], group.ends) : 0.0;
+    cost += group.cost - group.credit;
+    resident = group.retain;
+  }
+  groups_ = std::move(groups);
+  cost_ = cost;
+  return true;
+}
+
+bool Solver::Search::SingleOpSchedule() {
+  std::vector<size_t> order(problem_.ops.size());
+  for (size_t op = 0; op < order.size(); ++op) order[rank_[op]] = op;
+  groups_.clear();
+  cost_ = 0.0;
+  for (size_t op : order) {
+    Group& group = groups_.emplace_back();
+    group.ops = {op};
+    // Starting from the whole reduction, which is shrunk first if need be.
+    group.granularity = NativeGranularity(problem_, problem_.ops[op].op_type);
+    group.granularity.depth = std::numeric_limits<Depth>::max();
+    if (!OptimizeGranularity(&group, {}, true,
+                             std::numeric_limits<int64_t>::max())) {
+      return false;
+    }
+    if (groups_.size() > 1) {
+      group.credit = Credit(groups_[groups_.size() - 2], group.ends);
+    }
+    cost_ += group.cost - group.credit;
+  }
+  return true;
+}
+
+bool Solver::Search::Stopped(absl::Time deadline) const {
+  return absl::Now() >= deadline ||
+         solver_->cancelled_.load(std::memory_order_relaxed);
+}
+
+// Merges neighbours while that lowers the total latency.
+void Solver::Search::Fuse(absl::Time deadline) {
+  ScopedPhase phase(counters_, kFusion);
+  const auto improving = [&](double delta) {
+    return Improves(cost_ + delta, cost_);
+  };
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (size_t first = 0; first + 1 < groups_.size();) {
+      if (Stopped(deadline)) return;
+      std::optional<Proposal> merge = ProposeMerge(first, true);
+      if (merge.has_value() && Apply(*std::move(merge), improving)) {
+        changed = true;
+      } else {
+        ++first;
+      }
+    }
+  }
+}
+
+// Keeps every tensor in fast memory across a boundary where that helps,
+// including the wrap-around boundary under EvaluateOptions::repeated.
+void Solver::Search::Retain(absl::Time deadline) {
+  ScopedPhase phase(counters_, kRetention);
+  const auto improving = [&](double delta) {
+    return Improves(cost_ + delta, cost_);
+  };
+  for (size_t first = 0; first < groups_.size(); ++first) {
+    const bool wrap = first + 1 == groups_.size();
+    if (wrap && !replayer_.options().repeated) break;
+    for (size_t tensor : RetainCandidates(
+             groups_[first], groups_[wrap ? 0 : first + 1], wrap)) {
+      if (Stopped(deadline)) return;
+      if (std::binary_search(groups_[first].retain.begin(),
+                             groups_[first].retain.end(), tensor)) {
+        continue;
+      }
+      std::optional<Proposal> retain = ProposeRetain(first, tensor);
+      if (retain.has_value()) {
+        Apply(*std::move(retain), improving);
+      }
+    }
+  }
+}
+
+Solution Solver::Search::ToSolution() {
+  Solution solution;
+  for (const Group& group : groups_) {
+    solution.subgraphs.push_back(ToSubgraph(group));
+  }
+  return solution;
+}
+
+// Verifies the current schedule end to end and hands it to the solver.
+void Solver::Search::Publish() {
+  best_cost_ = cost_;
+  Verify(ToSolution());
+}
+
+void Solver::Search::Verify(Solution solution) {
+  ScopedPhase phase(counters_, kVerify);
+  counters_->CountFullEvaluation();
+  absl::StatusOr<std::vector<SubgraphLatency>> latencies =
+      replayer_.SubgraphLatencies(solution);
+  if (!latencies.ok()) return;
+  TotalLatency total = 0.0;
+  for (size_t i = 0; i < latencies->size(); ++i) {
+    solution.subgraphs[i].subgraph_latency = (*latencies)[i];
+    total += (*latencies)[i];
+  }
+  const bool engines = replayer_.options().num_engines > 1;
+  const bool middle = HasMiddleMemory(problem_);
+  if (engines) {
+    const absl::StatusOr<TotalLatency> makespan = replayer_.Evaluate(solution);
+    if (!makespan.ok()) return;
+    total = *makespan;
+  }
+  solver_->Offer(solution, total);
+  const bool repeated = replayer_.options().repeated;
+  if (!engines && !middle && !repeated) return;
+
+  // The search orders subgraphs for one engine and retains tensors in fast
+  // memory only across single boundaries; spreading them over all engines,
+  // placing tensors in middle memory and keeping weights resident for a whole
+  // repeated iteration are left to the list scheduler and the retention
+  // planners.
+  if (engines) {
+    absl::StatusOr<Solution> scheduled =
+        ScheduleEngines(problem_, solution, replayer_.options());
+    if (!scheduled.ok()) return;
+    solution = *std::move(scheduled);
+  }
+  if (middle) {
+    absl::StatusOr<Solution> planned =
+        PlanMiddleRetention(problem_, solution, replayer_.options());
+    if (!planned.ok()) return;
+    solution = *std::move(planned);
+  }
+  if (repeated) {
+    absl::StatusOr<Solution> planned =
+        PlanResidentInputs(problem_, solution, replayer_.options());
+    if (!planned.ok()) return;
+    solution = *std::move(planned);
+  }
+  const absl::StatusOr<TotalLatency> latency = replayer_.Evaluate(solution);
+  if (latency.ok()) solver_->Offer(solution, *latency);
+}
+
+absl::Status Solver::Search::Start(absl::Time deadline) {
+  {
+    ScopedPhase phase(counters_, kStart);
+    const std::optional<Solution>& initial = solver_->options_.initial_solution;
+    // The initial solution competes as given, in case regrouping it into
+    // the search's normal form loses something.
+    if (initial.has_value()) Verify(*initial);
+    if (!initial.has_value() || !AdoptSolution(*initial)) {
+      if (!SingleOpSchedule()) {
+        return absl::ResourceExhaustedError(
+            "Some op does not fit in fast memory at any granularity");
+      }
+    }
+  }
+  Publish();
+  Fuse(deadline);
+  Retain(deadline);
+  Publish();
+  return absl::OkStatus();
+}
+
+void Solver::Search::StartFrom(const Search& other) {
+  groups_ = other.groups_;
+  cost_ = other.cost_;
+  best_cost_ = other.best_cost_;
+}
+
+// Simulated annealing over the moves, restarting from the shared incumbent
+// when the thread's own schedule stops improving.
+void Solver::Search::Run(absl::Time deadline) {
+  ScopedPhase phase(counters_, kSearch);
+  const absl::Time start = absl::Now();
+  const double span = absl::ToDoubleSeconds(deadline - start);
+  const int64_t patience =
+      std::max<int64_t>(2000, 20 * static_cast<int64_t>(problem_.ops.size()));
+  int64_t stale = 0;
+  if (groups_.empty()) return;
+  for (int64_t iteration = 0;; ++iteration) {
+    if ((iteration & 15) == 0 && Stopped(deadline)) return;
+    std::optional<Proposal> proposal;
+    const double pick = UniformReal();
+    if (pick < 0.25) {
+      proposal = ProposeMerge(Uniform(groups_.size()), false);
+    } else if (pick < 0.45) {
+      proposal = ProposeSplit();
+    } else if (pick < 0.75) {
+      proposal = ProposeRegranularize();
+    } else if (pick < 0.95) {
+      proposal = ProposeRetain(Uniform(groups_.size()), std::nullopt);
+    } else {
+      proposal = ProposeTraversal();
+    }
+    if (!proposal.has_value()) continue;
+
+    const double progress =
+        span > 0 ? absl::ToDoubleSeconds(absl::Now() - start) / span : 1.0;
+    const double temperature =
+        1e-4 * cost_ * std::max(0.0, 1.0 - progress);
+    Apply(*std::move(proposal), [&](double delta) {
+      return delta <= 0.0 || (temperature > 0.0 &&
+                              UniformReal() < std::exp(-delta / temperature));
+    });
+    if (Improves(cost_, best_cost_)) {
+      Publish();
+      stale = 0;
+    } else if (++stale >= patience) {
+      stale = 0;
+      const Solution best = solver_->best();
+      if (!AdoptSolution(best)) return;
+      best_cost_ = cost_;
+    }
+  }
+}
+
+Solver::Solver(const Problem& problem, SolverOptions options)
+    : problem_(problem), options_(std::move(options)) {}
+
+Solver::~Solver() = default;
+
+absl::Status Solver::Initialize(absl::Time deadline) {
+  searches_.clear();
+  searches_.push_back(std::make_unique<Search>(this, 0));
+  return searches_.front()->Start(deadline);
+}
+
+void Solver::Improve(absl::Time deadline) {
+  if (searches_.empty()) return;
+  while (static_cast<int>(searches_.size()) < options_.num_threads) {
+    searches_.push_back(std::make_unique<Search>(this, searches_.size()));
+    searches_.back()->StartFrom(*searches_.front());
+  }
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < searches_.size(); ++i) {
+    threads.emplace_back([this, i, deadline] { searches_[i]->Run(deadline); });
+  }
+  searches_.front()->Run(deadline);
+  for (std::thread& thread : threads) thread.join();
+}
+
+bool Solver::Offer(const Solution& solution, TotalLatency latency) {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (best_latency_.has_value() && !Improves(latency, *best_latency_)) {
+      return false;
+    }
+    best_ = solution;
+    best_latency_ = latency;
+  }
+  if (options_.telemetry != nullptr) {
+    options_.telemetry->RecordIncumbent(latency);
+  }
+  return true;
+}
+
+Solution Solver::best() const {
+  absl::MutexLock lock(&mutex_);
+  return best_;
+}
+
+TotalLatency Solver::best_latency() const {
+  absl::MutexLock lock(&mutex_);
+  return best_latency_.value_or(std::numeric_limits<double>::infinity());
+}
+
+absl::StatusOr<Solution> Solve(const Problem& problem,
+                               const SolverOptions& options,
+                               absl::Duration time_limit) {
+  const absl::Time deadline = absl::Now() + time_limit;
+  Solver solver(problem, options);
+  if (absl::Status status = solver.Initialize(deadline); !status.ok()) {
+    return status;
+  }
+  solver.Improve(deadline);
+  return solver.best();
+}
+
+absl::Duration ContestTimeLimit(const Problem& problem) {
+  // Released benchmarks: 5 ops in 2 s, 19 in 5 s, 32 in 15 s, 63 in 30 s and
+  // 103 in 60 s; larger ones get 120 s.
+  constexpr struct {
+    size_t num_ops;
+    int seconds;
+  } kTimeouts[] = {{5, 2}, {19, 5}, {32, 15}, {63, 30}, {103, 60}};
+  absl::Duration timeout = absl::Seconds(120);
+  for (const auto& [num_ops, seconds] : kTimeouts) {
+    if (problem.ops.size() <= num_ops) {
+      timeout = absl::Seconds(seconds);
+      break;
+    }
+  }
+  return timeout * 0.85 - absl::Milliseconds(100);
+}
+
+}  // namespace mlsys
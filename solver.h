@@ -0,0 +1,118 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_SOLVER_H_
+#define MLSYS_SOLVER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mlsys.h"
+#include "telemetry.h"
+#include "third_party/absl/base/thread_annotations.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/synchronization/mutex.h"
+#include "third_party/absl/time/time.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  A baseline scheduler: greedy fusion plus local search.      /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+struct SolverOptions {
+  int num_threads = 1;
+  uint64_t seed = 1;
+
+  // Starting point of the search.  When absent or invalid, the search starts
+  // from one subgraph per op, greedily fused.
+  std::optional<Solution> initial_solution;
+
+  // The cost model to optimize for.  Moves are priced and incumbents verified
+  // under it.
+  EvaluateOptions evaluate;
+
+  // Not owned; may be null.  Must come from NewSolverTelemetry(), which
+  // names the solver's moves and phases.
+  Telemetry* telemetry = nullptr;
+};
+
+std::unique_ptr<Telemetry> NewSolverTelemetry();
+
+// Searches over fusion groups, granularities, retention and traversal orders.
+// The search state is a sequence of subgraphs in topological order; every
+// move rewrites a short window of it and is priced incrementally through a
+// per-thread cache of subgraph costs, while each new incumbent is checked with
+// a full Evaluate().
+class Solver {
+ public:
+  Solver(const Problem& problem, SolverOptions options);
+  ~Solver();
+  Solver(const Solver&) = delete;
+  Solver& operator=(const Solver&) = delete;
+
+  // Builds the starting schedule.  Fusion stops early at `deadline` or on
+  // Cancel(), but a valid schedule is always produced unless some op fits in
+  // fast memory at no granularity at all.
+  absl::Status Initialize(absl::Time deadline = absl::InfiniteFuture());
+
+  // Runs the local search until `deadline` on `num_threads` threads.  May be
+  // called repeatedly; each call resumes where the previous one stopped.
+  void Improve(absl::Time deadline);
+
+  // Makes Initialize() and Improve() return early; safe to call from any
+  // thread.
+  void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+  // The best solution so far, with its subgraph latencies filled in.
+  Solution best() const ABSL_LOCKS_EXCLUDED(mutex_);
+  TotalLatency best_latency() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  class Search;
+  friend class Search;
+
+  // Adopts `solution` if it beats the incumbent; false otherwise.
+  bool Offer(const Solution& solution, TotalLatency latency)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  const Problem& problem_;
+  const SolverOptions options_;
+  std::vector<std::unique_ptr<Search>> searches_;
+  std::atomic<bool> cancelled_{false};
+
+  mutable absl::Mutex mutex_;
+  Solution best_ ABSL_GUARDED_BY(mutex_);
+  std::optional<TotalLatency> best_latency_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Initialize() followed by Improve() for `time_limit`.
+absl::StatusOr<Solution> Solve(const Problem& problem,
+                               const SolverOptions& options,
+                               absl::Duration time_limit);
+
+// The contest timeout for a problem of this size (see README.md), less a
+// safety margin for reading the input and writing the output.
+absl::Duration ContestTimeLimit(const Problem& problem);
+
+}  // namespace mlsys
+
+#endif  // MLSYS_SOLVER_H_
@@ -0,0 +1,185 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "solver_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "mlsys.h"
+#include "solver.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/synchronization/mutex.h"
+#include "third_party/absl/time/clock.h"
+#include "third_party/absl/time/time.h"
+
+namespace mlsys {
+
+SolverPool::Job::Job(std::shared_ptr<const Problem> problem,
+                     JobOptions options)
+    : problem_(std::move(problem)),
+      options_(std::move(options)),
+      solver_(*problem_, options_.solver) {}
+
+void SolverPool::Job::Cancel() {
+  cancelled_.store(true, std::memory_order_relaxed);
+  solver_.Cancel();
+}
+
+absl::Status SolverPool::Job::Wait() {
+  done_.WaitForNotification();
+  return status_;
+}
+
+bool SolverPool::Job::WaitWithTimeout(absl::Duration timeout) {
+  return done_.WaitForNotificationWithTimeout(timeout);
+}
+
+SolverPool::SolverPool(int num_workers, absl::Duration slice)
+    : slice_(slice) {
+  num_workers = std::max(1, num_workers);
+  for (int i = 0; i < num_workers; ++i) {
+    queues_.push_back(std::make_unique<RunQueue>());
+  }
+  for (int i = 0; i < num_workers; ++i) {
+    workers_.emplace_back([this, i] { Work(i); });
+  }
+}
+
+SolverPool::~SolverPool() {
+  Stop();
+  for (std::thread& worker : workers_) worker.join();
+}
+
+std::shared_ptr<SolverPool::Job> SolverPool::Submit(
+    std::shared_ptr<const Problem> problem, JobOptions options) {
+  options.solver.num_threads = 1;
+  if (options.slice <= absl::ZeroDuration()) options.slice = slice_;
+  auto job = std::make_shared<Job>(std::move(problem), std::move(options));
+  size_t queue;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (stopping_) {
+      job->status_ = absl::CancelledError("The solver pool is stopping");
+      job->done_.Notify();
+      return job;
+    }
+    queue = next_queue_++ % queues_.size();
+  }
+  Push(queue, job);
+  return job;
+}
+
+void SolverPool::Stop() {
+  absl::MutexLock lock(&mutex_);
+  stopping_ = true;
+  for (const std::unique_ptr<RunQueue>& queue : queues_) {
+    absl::MutexLock queue_lock(&queue->mutex);
+    for (const std::shared_ptr<Job>& job : queue->jobs) job->Cancel();
+  }
+}
+
+void SolverPool::Push(size_t index, std::shared_ptr<Job> job) {
+  {
+    absl::MutexLock lock(&queues_[index]->mutex);
+    queues_[index]->jobs.push_back(std::move(job));
+  }
+  // Counted only once queued, so that a reservation always finds a job.
+  absl::MutexLock lock(&mutex_);
+  ++pending_;
+}
+
+std::shared_ptr<SolverPool::Job> SolverPool::Take(size_t index) {
+  while (true) {
+    for (size_t i = 0; i < queues_.size(); ++i) {
+      RunQueue& queue = *queues_[(index + i) % queues_.size()];
+      absl::MutexLock lock(&queue.mutex);
+      if (queue.jobs.empty()) continue;
+      std::shared_ptr<Job> job;
+      if (i == 0) {
+        job = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+      } else {
+        job = std::move(queue.jobs.back());
+        queue.jobs.pop_back();
+      }
+      return job;
+    }
+  }
+}
+
+void SolverPool::Work(size_t index) {
+  while (true) {
+    bool stopping;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(
+          +[](SolverPool* pool) ABSL_EXCLUSIVE_LOCKS_REQUIRED(pool->mutex_) {
+            return pool->stopping_ || pool->pending_ > 0;
+          },
+          this));
+      if (pending_ == 0) return;
+      --pending_;
+      stopping = stopping_;
+    }
+    std::shared_ptr<Job> job = Take(index);
+    if (stopping) job->Cancel();
+    if (RunSlice(*job)) {
+      bool requeue;
+      {
+        absl::MutexLock lock(&mutex_);
+        requeue = !stopping_;
+      }
+      if (requeue) {
+        Push(index, std::move(job));
+        continue;
+      }
+    }
+    if (job->status_.ok() && !job->started_) {
+      job->status_ = absl::CancelledError("Cancelled before starting");
+    }
+    job->done_.Notify();
+  }
+}
+
+bool SolverPool::RunSlice(Job& job) {
+  if (job.cancelled_.load(std::memory_order_relaxed)) return false;
+  const absl::Time start = absl::Now();
+  const JobOptions& options = job.options_;
+  const absl::Time end =
+      std::min(options.deadline, start + (options.budget - job.used_));
+  if (!job.started_) {
+    job.started_ = true;
+    if (absl::Status status = job.solver_.Initialize(end); !status.ok()) {
+      job.status_ = std::move(status);
+      return false;
+    }
+    if (options.on_first_solution) {
+      options.on_first_solution(job.solver_.best(),
+                                job.solver_.best_latency());
+    }
+  } else {
+    job.solver_.Improve(std::min(start + options.slice, end));
+  }
+  const absl::Time now = absl::Now();
+  job.used_ += now - start;
+  return now < options.deadline && job.used_ < options.budget &&
+         !job.cancelled_.load(std::memory_order_relaxed);
+}
+
+}  // namespace mlsys
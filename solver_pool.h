@@ -0,0 +1,141 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_SOLVER_POOL_H_
+#define MLSYS_SOLVER_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "mlsys.h"
+#include "solver.h"
+#include "third_party/absl/base/thread_annotations.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/synchronization/mutex.h"
+#include "third_party/absl/synchronization/notification.h"
+#include "third_party/absl/time/time.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Solver jobs time-sliced over a fixed set of threads.        /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// Runs many solver jobs on `num_workers` long-lived threads.  Each worker
+// owns a run queue: it takes the job at the head, searches it for one slice
+// and puts it back at the tail, so that the jobs of a queue share its worker
+// round robin whatever their sizes.  A worker whose queue runs dry steals
+// from the tail of another's, which moves jobs onto the cores that finished
+// theirs early.  No thread is started per job.  A job's Initialize() runs
+// as its first slice, bounded only by the job's deadline and budget.
+class SolverPool {
+ public:
+  class Job;
+
+  // Called on a worker with a job's first solution, as soon as it is known.
+  using FirstSolutionCallback =
+      std::function<void(const Solution& solution, TotalLatency latency)>;
+
+  struct JobOptions {
+    // The thread count is ignored: a job runs on one worker at a time.
+    SolverOptions solver;
+    absl::Time deadline = absl::InfiniteFuture();
+    // Worker time, summed over slices, after which the job ends.
+    absl::Duration budget = absl::InfiniteDuration();
+    // The job's round-robin quantum, or the pool's when zero.  Jobs sharing
+    // a worker get its time in proportion to their slices.
+    absl::Duration slice = absl::ZeroDuration();
+    FirstSolutionCallback on_first_solution;
+  };
+
+  SolverPool(int num_workers, absl::Duration slice);
+  // Stops the pool and joins the workers.
+  ~SolverPool();
+  SolverPool(const SolverPool&) = delete;
+  SolverPool& operator=(const SolverPool&) = delete;
+
+  std::shared_ptr<Job> Submit(std::shared_ptr<const Problem> problem,
+                              JobOptions options) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Cancels every job, queued or running, and refuses new ones.  Running
+  // jobs finish at the end of their current slice.
+  void Stop() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct RunQueue {
+    absl::Mutex mutex;
+    std::deque<std::shared_ptr<Job>> jobs ABSL_GUARDED_BY(mutex);
+  };
+
+  void Work(size_t index) ABSL_LOCKS_EXCLUDED(mutex_);
+  void Push(size_t index, std::shared_ptr<Job> job) ABSL_LOCKS_EXCLUDED(mutex_);
+  // Pops a job from queue `index`, or steals one; the caller must have
+  // reserved it by decrementing `pending_`.
+  std::shared_ptr<Job> Take(size_t index);
+  // Runs one slice of `job`; false once the job is over.
+  bool RunSlice(Job& job);
+
+  const absl::Duration slice_;
+  std::vector<std::unique_ptr<RunQueue>> queues_;
+
+  absl::Mutex mutex_;
+  size_t pending_ ABSL_GUARDED_BY(mutex_) = 0;  // Jobs in all the queues.
+  size_t next_queue_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(mutex_) = false;
+  std::vector<std::thread> workers_;
+};
+
+class SolverPool::Job {
+ public:
+  Job(std::shared_ptr<const Problem> problem, JobOptions options);
+  Job(const Job&) = delete;
+  Job& operator=(const Job&) = delete;
+
+  // Makes the job finish at the end of its current slice.
+  void Cancel();
+
+  // Blocks until the job is over.  Fails if the problem has no solution or
+  // the job was cancelled before producing one.
+  absl::Status Wait();
+  bool WaitWithTimeout(absl::Duration timeout);
+  bool done() const { return done_.HasBeenNotified(); }
+
+  // The best solution found; only meaningful after a successful Wait().
+  Solution best() const { return solver_.best(); }
+  TotalLatency best_latency() const { return solver_.best_latency(); }
+
+ private:
+  friend class SolverPool;
+
+  const std::shared_ptr<const Problem> problem_;
+  const JobOptions options_;
+  Solver solver_;  // Refers to *problem_.
+  std::atomic<bool> cancelled_{false};
+  // Only touched by the worker holding the job.
+  bool started_ = false;
+  absl::Duration used_ = absl::ZeroDuration();
+  absl::Status status_;  // Written before done_ is notified.
+  absl::Notification done_;
+};
+
+}  // namespace mlsys
+
+#endif  // MLSYS_SOLVER_POOL_H_
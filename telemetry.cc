@@ -0,0 +1,221 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "telemetry.h"
+
+#include <signal.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "file_util.h"
+#include "third_party/absl/log/check.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/strings/match.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/strings/str_format.h"
+#include "third_party/absl/strings/str_join.h"
+#include "third_party/absl/synchronization/mutex.h"
+#include "third_party/absl/time/clock.h"
+#include "third_party/absl/time/time.h"
+
+namespace mlsys {
+
+namespace {
+
+constexpr absl::Duration kWatchPeriod = absl::Milliseconds(50);
+
+// Set by the SIGUSR1 handler; lock-free, hence async-signal-safe.
+std::atomic<bool> dump_requested{false};
+
+void RequestDump(int) { dump_requested.store(true, std::memory_order_relaxed); }
+
+uint64_t Load(const std::atomic<uint64_t>& counter) {
+  return counter.load(std::memory_order_relaxed);
+}
+
+std::string Number(double value) { return absl::StrFormat("%.10g", value); }
+
+}  // namespace
+
+Telemetry::Telemetry(std::vector<std::string> move_names,
+                     std::vector<std::string> phase_names)
+    : move_names_(std::move(move_names)),
+      phase_names_(std::move(phase_names)),
+      start_(absl::Now()) {
+  ABSL_CHECK_LE(move_names_.size(),
+                size_t{TelemetryCounters::kMaxKinds});
+  ABSL_CHECK_LE(phase_names_.size(),
+                size_t{TelemetryCounters::kMaxKinds});
+}
+
+TelemetryCounters* Telemetry::NewThread() {
+  absl::MutexLock lock(&mutex_);
+  return &threads_.emplace_back();
+}
+
+void Telemetry::RecordIncumbent(double latency) {
+  const absl::Duration time = absl::Now() - start_;
+  absl::MutexLock lock(&mutex_);
+  incumbents_.push_back({time, latency});
+}
+
+Telemetry::Snapshot Telemetry::Read() const {
+  Snapshot snapshot;
+  snapshot.elapsed = absl::Now() - start_;
+  snapshot.proposals.assign(move_names_.size(), 0);
+  snapshot.accepts.assign(move_names_.size(), 0);
+  snapshot.phase_times.assign(phase_names_.size(), absl::ZeroDuration());
+  absl::MutexLock lock(&mutex_);
+  snapshot.num_threads = threads_.size();
+  for (const TelemetryCounters& thread : threads_) {
+    snapshot.evaluations += Load(thread.evaluations_);
+    snapshot.full_evaluations += Load(thread.full_evaluations_);
+    snapshot.cache_hits += Load(thread.cache_hits_);
+    snapshot.cache_misses += Load(thread.cache_misses_);
+    for (size_t move = 0; move < move_names_.size(); ++move) {
+      snapshot.proposals[move] += Load(thread.proposals_[move]);
+      snapshot.accepts[move] += Load(thread.accepts_[move]);
+    }
+    for (size_t phase = 0; phase < phase_names_.size(); ++phase) {
+      snapshot.phase_times[phase] +=
+          absl::Nanoseconds(Load(thread.phase_nanos_[phase]));
+    }
+  }
+  snapshot.incumbents = incumbents_;
+  return snapshot;
+}
+
+std::string Telemetry::ToJson() const {
+  const Snapshot snapshot = Read();
+  const double seconds = absl::ToDoubleSeconds(snapshot.elapsed);
+  const uint64_t lookups = snapshot.cache_hits + snapshot.cache_misses;
+  std::string out = "{\n";
+  absl::StrAppend(&out, "  \"elapsed_seconds\": ", Number(seconds), ",\n");
+  absl::StrAppend(&out, "  \"threads\": ", snapshot.num_threads, ",\n");
+  absl::StrAppend(&out, "  \"evaluations\": ", snapshot.evaluations, ",\n");
+  absl::StrAppend(&out, "  \"evaluations_per_second\": ",
+                  Number(seconds > 0 ? snapshot.evaluations / seconds : 0),
+                  ",\n");
+  absl::StrAppend(&out, "  \"full_evaluations\": ", snapshot.full_evaluations,
+                  ",\n");
+  absl::StrAppend(&out, "  \"cache\": {\"hits\": ", snapshot.cache_hits,
+                  ", \"misses\": ", snapshot.cache_misses, ", \"hit_rate\": ",
+                  Number(lookups > 0 ? 1.0 * snapshot.cache_hits / lookups : 0),
+                  "},\n");
+  std::vector<std::string> moves;
+  for (size_t move = 0; move < move_names_.size(); ++move) {
+    moves.push_back(absl::StrCat("    \"", move_names_[move],
+                                 "\": {\"proposals\": ",
+                                 snapshot.proposals[move], ", \"accepts\": ",
+                                 snapshot.accepts[move], "}"));
+  }
+  absl::StrAppend(&out, "  \"moves\": {\n", absl::StrJoin(moves, ",\n"),
+                  "\n  },\n");
+  std::vector<std::string> phases;
+  for (size_t phase = 0; phase < phase_names_.size(); ++phase) {
+    const absl::Duration time = snapshot.phase_times[phase];
+    phases.push_back(absl::StrCat("    \"", phase_names_[phase], "\": ",
+                                  Number(absl::ToDoubleSeconds(time))));
+  }
+  absl::StrAppend(&out, "  \"phase_seconds\": {\n",
+                  absl::StrJoin(phases, ",\n"), "\n  },\n");
+  std::vector<std::string> incumbents;
+  for (const Incumbent& incumbent : snapshot.incumbents) {
+    incumbents.push_back(absl::StrCat(
+        "    {\"seconds\": ", Number(absl::ToDoubleSeconds(incumbent.time)),
+        ", \"latency\": ", Number(incumbent.latency), "}"));
+  }
+  absl::StrAppend(&out, "  \"incumbents\": [\n",
+                  absl::StrJoin(incumbents, ",\n"), "\n  ]\n}\n");
+  return out;
+}
+
+std::string Telemetry::ToCsv() const {
+  const Snapshot snapshot = Read();
+  const double seconds = absl::ToDoubleSeconds(snapshot.elapsed);
+  std::string out = "section,key,value\n";
+  absl::StrAppend(&out, "run,elapsed_seconds,", Number(seconds), "\n");
+  absl::StrAppend(&out, "run,threads,", snapshot.num_threads, "\n");
+  absl::StrAppend(&out, "run,evaluations,", snapshot.evaluations, "\n");
+  absl::StrAppend(&out, "run,evaluations_per_second,",
+                  Number(seconds > 0 ? snapshot.evaluations / seconds : 0),
+                  "\n");
+  absl::StrAppend(&out, "run,full_evaluations,", snapshot.full_evaluations,
+                  "\n");
+  absl::StrAppend(&out, "cache,hits,", snapshot.cache_hits, "\n");
+  absl::StrAppend(&out, "cache,misses,", snapshot.cache_misses, "\n");
+  for (size_t move = 0; move < move_names_.size(); ++move) {
+    absl::StrAppend(&out, "proposals,", move_names_[move], ",",
+                    snapshot.proposals[move], "\n");
+    absl::StrAppend(&out, "accepts,", move_names_[move], ",",
+                    snapshot.accepts[move], "\n");
+  }
+  for (size_t phase = 0; phase < phase_names_.size(); ++phase) {
+    absl::StrAppend(
+        &out, "phase_seconds,", phase_names_[phase], ",",
+        Number(absl::ToDoubleSeconds(snapshot.phase_times[phase])), "\n");
+  }
+  for (const Incumbent& incumbent : snapshot.incumbents) {
+    absl::StrAppend(&out, "incumbent,",
+                    Number(absl::ToDoubleSeconds(incumbent.time)), ",",
+                    Number(incumbent.latency), "\n");
+  }
+  return out;
+}
+
+absl::Status Telemetry::Dump(const std::string& filename) const {
+  return WriteFile(filename,
+                   absl::EndsWith(filename, ".csv") ? ToCsv() : ToJson());
+}
+
+TelemetryDumper::TelemetryDumper(const Telemetry* telemetry,
+                                 std::string filename)
+    : telemetry_(telemetry), filename_(std::move(filename)) {
+  dump_requested.store(false, std::memory_order_relaxed);
+  struct sigaction action = {};
+  action.sa_handler = RequestDump;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGUSR1, &action, nullptr);
+  watcher_ = std::thread([this] {
+    while (!done_.load(std::memory_order_acquire)) {
+      absl::SleepFor(kWatchPeriod);
+      if (dump_requested.exchange(false, std::memory_order_relaxed)) Dump();
+    }
+  });
+}
+
+TelemetryDumper::~TelemetryDumper() {
+  done_.store(true, std::memory_order_release);
+  watcher_.join();
+  signal(SIGUSR1, SIG_DFL);
+  Dump();
+}
+
+void TelemetryDumper::Dump() const {
+  if (absl::Status status = telemetry_->Dump(filename_); !status.ok()) {
+    std::cerr << "Cannot dump telemetry: " << status << "\n";
+  }
+}
+
+}  // namespace mlsys
@@ -0,0 +1,165 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_TELEMETRY_H_
+#define MLSYS_TELEMETRY_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "third_party/absl/base/thread_annotations.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/synchronization/mutex.h"
+#include "third_party/absl/time/clock.h"
+#include "third_party/absl/time/time.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Low-overhead solver telemetry, dumped as JSON or CSV.       /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+// Counters of one solver thread.  Only the owning thread writes them, so an
+// increment is a relaxed load followed by a relaxed store -- plain moves on
+// every mainstream target, with no locked read-modify-write -- while readers
+// on other threads still see untorn values.  Each block starts on its own
+// cache line and fills whole lines, so that threads bumping their counters
+// never share one.
+class alignas(64) TelemetryCounters {
+ public:
+  static constexpr int kMaxKinds = 16;
+
+  void CountEvaluation() { Bump(evaluations_); }
+  void CountFullEvaluation() { Bump(full_evaluations_); }
+  void CountCacheHit() { Bump(cache_hits_); }
+  void CountCacheMiss() { Bump(cache_misses_); }
+  void CountProposal(int move) { Bump(proposals_[move]); }
+  void CountAccept(int move) { Bump(accepts_[move]); }
+  void AddPhaseTime(int phase, absl::Duration duration) {
+    Bump(phase_nanos_[phase], absl::ToInt64Nanoseconds(duration));
+  }
+
+ private:
+  friend class Telemetry;
+  using Counter = std::atomic<uint64_t>;
+
+  static void Bump(Counter& counter, uint64_t amount = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount,
+                  std::memory_order_relaxed);
+  }
+
+  Counter evaluations_{0};
+  Counter full_evaluations_{0};
+  Counter cache_hits_{0};
+  Counter cache_misses_{0};
+  std::array<Counter, kMaxKinds> proposals_{};
+  std::array<Counter, kMaxKinds> accepts_{};
+  std::array<Counter, kMaxKinds> phase_nanos_{};
+};
+
+// Times a solver phase into `counters` for as long as it is in scope.
+class ScopedPhase {
+ public:
+  ScopedPhase(TelemetryCounters* counters, int phase)
+      : counters_(counters), phase_(phase), start_(absl::Now()) {}
+  ~ScopedPhase() { counters_->AddPhaseTime(phase_, absl::Now() - start_); }
+  ScopedPhase(const ScopedPhase&) = delete;
+  ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+ private:
+  TelemetryCounters* counters_;
+  int phase_;
+  absl::Time start_;
+};
+
+// Collects the counters of every solver thread and merges them on read.
+// Move and phase indices passed to the counters refer to `move_names` and
+// `phase_names`, of at most TelemetryCounters::kMaxKinds names each.
+class Telemetry {
+ public:
+  Telemetry(std::vector<std::string> move_names,
+            std::vector<std::string> phase_names);
+  Telemetry(const Telemetry&) = delete;
+  Telemetry& operator=(const Telemetry&) = delete;
+
+  // Counters for a new solver thread, owned by the telemetry.
+  TelemetryCounters* NewThread() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Records a new best solution, timestamped from the telemetry's creation.
+  void RecordIncumbent(double latency) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  struct Incumbent {
+    absl::Duration time;
+    double latency;
+  };
+  struct Snapshot {
+    absl::Duration elapsed;
+    int num_threads = 0;
+    uint64_t evaluations = 0;       // Subgraph replays.
+    uint64_t full_evaluations = 0;  // Whole-solution replays.
+    uint64_t cache_hits = 0;
+    uint64_t cache_misses = 0;
+    std::vector<uint64_t> proposals;  // Per move.
+    std::vector<uint64_t> accepts;    // Per move.
+    std::vector<absl::Duration> phase_times;  // Summed over threads.
+    std::vector<Incumbent> incumbents;
+  };
+  Snapshot Read() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  std::string ToJson() const;
+  // One `section,key,value` row per metric.
+  std::string ToCsv() const;
+  // Writes CSV if `filename` ends in ".csv" and JSON otherwise.
+  absl::Status Dump(const std::string& filename) const;
+
+ private:
+  const std::vector<std::string> move_names_;
+  const std::vector<std::string> phase_names_;
+  const absl::Time start_;
+
+  mutable absl::Mutex mutex_;
+  // A deque keeps the counters at stable addresses as threads register.
+  std::deque<TelemetryCounters> threads_ ABSL_GUARDED_BY(mutex_);
+  std::vector<Incumbent> incumbents_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Dumps `telemetry` to `filename` every time the process receives SIGUSR1,
+// and once more on destruction.  The signal handler only raises a flag; a
+// watcher thread does the writing.  At most one dumper may exist at a time.
+class TelemetryDumper {
+ public:
+  TelemetryDumper(const Telemetry* telemetry, std::string filename);
+  ~TelemetryDumper();
+  TelemetryDumper(const TelemetryDumper&) = delete;
+  TelemetryDumper& operator=(const TelemetryDumper&) = delete;
+
+ private:
+  void Dump() const;
+
+  const Telemetry* telemetry_;
+  const std::string filename_;
+  std::atomic<bool> done_{false};
+  std::thread watcher_;
+};
+
+}  // namespace mlsys
+
+#endif  // MLSYS_TELEMETRY_H_
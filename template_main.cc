@@ -0,0 +1,225 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Builds a schedule template for a family of problems that differ in one
+// shape parameter, and emits or checks its schedules:
+//
+//   $ ./mlsys_template --samples=64,128,256 family.json template.json
+//
+// solves the family's own member (or the one at --parameter) and fits the
+// template's rules to the samples (see BuildScheduleTemplate()).
+//
+//   $ ./mlsys_template --instantiate=96 family.json template.json out.json
+//
+// writes the template's solution for the member at 96, and
+//
+//   $ ./mlsys_template --sweep=32,64,96,128 family.json template.json
+//
+// compares the template's latency at each value with that of a solution
+// searched for that shape alone, for --time_limit each.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mlsys.h"
+#include "roofline.h"
+#include "schedule_template.h"
+#include "solver.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/flags/parse.h"
+#include "third_party/absl/flags/usage.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/numbers.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/time/clock.h"
+#include "third_party/absl/time/time.h"
+
+ABSL_FLAG(int64_t, parameter, 0,
+          "Member of the family to solve for the template; 0 uses the "
+          "family's own.  Should be the largest of interest.");
+ABSL_FLAG(std::vector<std::string>, samples, {},
+          "Members of the family the template's rules are fitted to.");
+ABSL_FLAG(absl::Duration, time_limit, absl::Seconds(10),
+          "Search budget of each solve.");
+ABSL_FLAG(int, threads, 0, "Search threads; 0 uses every hardware thread.");
+ABSL_FLAG(uint64_t, seed, 1, "Random seed.");
+ABSL_FLAG(int64_t, instantiate, 0,
+          "If set, writes the template's solution for this member instead of "
+          "building the template.");
+ABSL_FLAG(std::vector<std::string>, sweep, {},
+          "If set, compares the template with per-shape solves at these "
+          "members instead of building the template.");
+ABSL_FLAG(int, repetitions, 1000,
+          "With --sweep, instantiations timed per member.");
+
+namespace {
+
+absl::StatusOr<std::vector<int64_t>> ParseParameters(
+    const std::vector<std::string>& values) {
+  std::vector<int64_t> parameters;
+  for (const std::string& value : values) {
+    int64_t parameter;
+    if (!absl::SimpleAtoi(value, &parameter) || parameter <= 0) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("invalid parameter: ", value));
+    }
+    parameters.push_back(parameter);
+  }
+  return parameters;
+}
+
+mlsys::SolverOptions SolverOptionsFromFlags() {
+  mlsys::SolverOptions options;
+  options.num_threads = absl::GetFlag(FLAGS_threads);
+  if (options.num_threads <= 0) {
+    options.num_threads =
+        std::max(1u, std::thread::hardware_concurrency());
+  }
+  options.seed = absl::GetFlag(FLAGS_seed);
+  return options;
+}
+
+absl::Status Build(const mlsys::ProblemFamily& family,
+                   const std::string& output) {
+  mlsys::TemplateOptions options;
+  options.solver = SolverOptionsFromFlags();
+  options.time_limit = absl::GetFlag(FLAGS_time_limit);
+  absl::StatusOr<std::vector<int64_t>> samples =
+      ParseParameters(absl::GetFlag(FLAGS_samples));
+  if (!samples.ok()) return samples.status();
+  options.samples = *std::move(samples);
+  const int64_t parameter = absl::GetFlag(FLAGS_parameter) > 0
+                                ? absl::GetFlag(FLAGS_parameter)
+                                : family.parameter;
+  const absl::StatusOr<mlsys::ScheduleTemplate> schedule =
+      mlsys::BuildScheduleTemplate(family, parameter, options);
+  if (!schedule.ok()) return schedule.status();
+  return mlsys::WriteScheduleTemplate(*schedule, output);
+}
+
+absl::Status Instantiate(const mlsys::ProblemFamily& family,
+                         const mlsys::ScheduleTemplate& schedule,
+                         const std::string& output) {
+  const absl::StatusOr<mlsys::Problem> problem = mlsys::InstantiateProblem(
+      family, absl::GetFlag(FLAGS_instantiate));
+  if (!problem.ok()) return problem.status();
+  absl::StatusOr<mlsys::Solution> solution =
+      mlsys::InstantiateSchedule(*problem, schedule);
+  if (!solution.ok()) return solution.status();
+  const absl::StatusOr<std::vector<mlsys::SubgraphLatency>> latencies =
+      mlsys::Replayer(*problem).SubgraphLatencies(*solution);
+  if (!latencies.ok()) return latencies.status();
+  for (size_t i = 0; i < latencies->size(); ++i) {
+    solution->subgraphs[i].subgraph_latency = (*latencies)[i];
+  }
+  return mlsys::WriteSolution(*solution, output);
+}
+
+absl::Status Sweep(const mlsys::ProblemFamily& family,
+                   const mlsys::ScheduleTemplate& schedule) {
+  const absl::StatusOr<std::vector<int64_t>> parameters =
+      ParseParameters(absl::GetFlag(FLAGS_sweep));
+  if (!parameters.ok()) return parameters.status();
+  const mlsys::SolverOptions options = SolverOptionsFromFlags();
+  const int repetitions = std::max(1, absl::GetFlag(FLAGS_repetitions));
+  double log_ratios = 0.0;
+  int compared = 0;
+  for (int64_t parameter : *parameters) {
+    const absl::StatusOr<mlsys::Problem> problem =
+        mlsys::InstantiateProblem(family, parameter);
+    if (!problem.ok()) return problem.status();
+
+    absl::StatusOr<mlsys::Solution> instance;
+    const absl::Time start = absl::Now();
+    for (int i = 0; i < repetitions; ++i) {
+      instance = mlsys::InstantiateSchedule(*problem, schedule);
+    }
+    const absl::Duration elapsed = (absl::Now() - start) / repetitions;
+    if (!instance.ok()) return instance.status();
+    const absl::StatusOr<mlsys::TotalLatency> latency =
+        mlsys::Evaluate(*problem, *instance);
+
+    const absl::StatusOr<mlsys::Solution> solved = mlsys::Solve(
+        *problem, options, absl::GetFlag(FLAGS_time_limit));
+    if (!solved.ok()) return solved.status();
+    const absl::StatusOr<mlsys::TotalLatency> reference =
+        mlsys::Evaluate(*problem, *solved);
+    if (!reference.ok()) return reference.status();
+
+    std::cout << "parameter " << parameter << ": template ";
+    if (latency.ok()) {
+      std::cout << *latency << ", solved " << *reference << ", ratio "
+                << *latency / *reference;
+      log_ratios += std::log(*latency / *reference);
+      ++compared;
+    } else {
+      std::cout << "invalid (" << latency.status() << "), solved "
+                << *reference;
+    }
+    std::cout << ", instantiated in "
+              << absl::ToDoubleMicroseconds(elapsed) << " us\n";
+  }
+  if (compared > 0) {
+    std::cout << "geometric mean ratio " << std::exp(log_ratios / compared)
+              << "\n";
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  absl::SetProgramUsageMessage(
+      "Usage: mlsys_template [flags] <family.json> <template.json> "
+      "[solution.json]");
+  const std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+  const bool instantiate = absl::GetFlag(FLAGS_instantiate) != 0;
+  const bool sweep = !absl::GetFlag(FLAGS_sweep).empty();
+  if (args.size() != (instantiate ? 4u : 3u) || (instantiate && sweep)) {
+    std::cerr << "Usage: " << args[0]
+              << " [flags] <family.json> <template.json> [solution.json]\n";
+    return 1;
+  }
+  const absl::StatusOr<mlsys::ProblemFamily> family =
+      mlsys::ReadProblemFamily(args[1]);
+  if (!family.ok()) {
+    std::cerr << family.status() << "\n";
+    return 1;
+  }
+  absl::Status status;
+  if (!instantiate && !sweep) {
+    status = Build(*family, args[2]);
+  } else if (const absl::StatusOr<mlsys::ScheduleTemplate> schedule =
+                 mlsys::ReadScheduleTemplate(args[2]);
+             !schedule.ok()) {
+    status = schedule.status();
+  } else if (instantiate) {
+    status = Instantiate(*family, *schedule, args[3]);
+  } else {
+    status = Sweep(*family, *schedule);
+  }
+  if (!status.ok()) {
+    std::cerr << status << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,242 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "trace_export.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "file_util.h"
+#include "mlsys.h"
+#include "roofline.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "third_party/absl/strings/str_cat.h"
+#include "third_party/absl/strings/str_format.h"
+#include "third_party/absl/strings/str_join.h"
+#include "third_party/absl/strings/string_view.h"
+
+namespace mlsys {
+
+namespace {
+
+enum Track { kSubgraphs = 1, kTiles, kSteps, kCompute, kMemory };
+
+constexpr struct {
+  Track track;
+  absl::string_view name;
+} kTracks[] = {{kSubgraphs, "subgraphs"},
+               {kTiles, "tiles"},
+               {kSteps, "steps"},
+               {kCompute, "compute"},
+               {kMemory, "memory"}};
+
+std::string Time(double time) { return absl::StrFormat("%.12g", time); }
+
+class TraceWriter {
+ public:
+  TraceWriter() { out_ = "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n"; }
+
+  void Metadata(absl::string_view name, int track, absl::string_view value) {
+    Event(absl::StrCat("{\"ph\": \"M\", \"pid\": 0, \"tid\": ", track,
+                       ", \"name\": \"", name, "\", \"args\": {\"name\": \"",
+                       value, "\"}}"));
+  }
+
+  void Slice(int track, absl::string_view name, absl::string_view category,
+             double start, double duration, absl::string_view args,
+             absl::string_view color = "") {
+    std::string event = absl::StrCat(
+        "{\"ph\": \"X\", \"pid\": 0, \"tid\": ", track, ", \"name\": \"", name,
+        "\", \"cat\": \"", category, "\", \"ts\": ", Time(start),
+        ", \"dur\": ", Time(duration), ", \"args\": {", args, "}");
+    if (!color.empty()) absl::StrAppend(&event, ", \"cname\": \"", color, "\"");
+    absl::StrAppend(&event, "}");
+    Event(event);
+  }
+
+  void Counter(absl::string_view name, double time, absl::string_view args) {
+    Event(absl::StrCat("{\"ph\": \"C\", \"pid\": 0, \"name\": \"", name,
+                       "\", \"ts\": ", Time(time), ", \"args\": {", args,
+                       "}}"));
+  }
+
+  std::string Finish() && {
+    absl::StrAppend(&out_, "\n]}\n");
+    return std::move(out_);
+  }
+
+ private:
+  void Event(absl::string_view event) {
+    if (!first_) absl::StrAppend(&out_, ",\n");
+    first_ = false;
+    absl::StrAppend(&out_, event);
+  }
+
+  std::string out_;
+  bool first_ = true;
+};
+
+std::string TransferList(const std::vector<Transfer>& transfers) {
+  return absl::StrJoin(transfers, ", ",
+                       [](std::string* out, const Transfer& transfer) {
+                         const Region& region = transfer.region;
+                         absl::StrAppend(out, "\"t", transfer.tensor, "[",
+                                         region.row, ":",
+                                         region.row + region.height, ", ",
+                                         region.col, ":",
+                                         region.col + region.width, "]\"");
+                       });
+}
+
+}  // namespace
+
+absl::StatusOr<std::string> ChromeTrace(const Problem& problem,
+                                        const Solution& solution,
+                                        const TraceOptions& options) {
+  TraceWriter writer;
+  writer.Metadata("process_name", 0, "mlsys schedule");
+  for (const auto& [track, name] : kTracks) {
+    writer.Metadata("thread_name", track, name);
+  }
+
+  const std::string capacity =
+      absl::StrCat(", \"capacity\": ", problem.fast_memory_capacity);
+  double now = 0.0;
+  double subgraph_start = 0.0;
+  double tile_start = 0.0;
+  const auto close_tile = [&](const Step& step) {
+    writer.Slice(kTiles, absl::StrCat("tile ", step.tile), "tile", tile_start,
+                 now - tile_start,
+                 absl::StrCat("\"subgraph\": ", step.subgraph,
+                              ", \"position\": ", step.position,
+                              ", \"rows\": \"",
+                              step.valid.row, ":",
+                              step.valid.row + step.valid.height,
+                              "\", \"cols\": \"", step.valid.col, ":",
+                              step.valid.col + step.valid.width, "\""));
+  };
+  const auto close_subgraph = [&](const Step& step) {
+    const Subgraph& subgraph = solution.subgraphs[step.subgraph];
+    const Granularity& granularity = subgraph.granularity;
+    writer.Slice(
+        kSubgraphs, absl::StrCat("subgraph ", step.subgraph), "subgraph",
+        subgraph_start, now - subgraph_start,
+        absl::StrCat("\"ops\": [", absl::StrJoin(subgraph.ops, ", "),
+                     "], \"granularity\": [", granularity.width, ", ",
+                     granularity.height, ", ", granularity.depth,
+                     "], \"retained\": [",
+                     absl::StrJoin(subgraph.tensors_to_retain, ", "),
+                     "], \"tiles\": ", step.num_tiles, ", \"k_steps\": ",
+                     step.num_k_steps, ", \"latency\": ",
+                     Time(now - subgraph_start)));
+  };
+
+  Replayer replayer(problem);
+  std::optional<Step> previous;
+  if (absl::Status status = replayer.Replay(solution, [&](const Step& step) {
+        if (previous.has_value()) {
+          const bool new_subgraph = step.subgraph != previous->subgraph;
+          if (new_subgraph || step.position != previous->position) {
+            close_tile(*previous);
+            tile_start = now;
+          }
+          if (new_subgraph) {
+            close_subgraph(*previous);
+            subgraph_start = now;
+          }
+        }
+
+        // Padding is reported for the op of the subgraph padded the most.
+        const Subgraph& subgraph = solution.subgraphs[step.subgraph];
+        int64_t padded = 0;
+        for (size_t op : subgraph.ops) {
+          const Granularity& native =
+              NativeGranularity(problem, problem.ops[op].op_type);
+          padded = std::max(padded, PaddedTiles(subgraph.granularity, native) *
+                                        native.width * native.height);
+        }
+        const double padding = 1.0 - static_cast<double>(step.valid.size()) /
+                                         padded;
+        const double memory_time = step.memory_in_time + step.memory_out_time;
+        const bool memory_bound =
+            std::max(memory_time, step.middle_time) > step.compute_time;
+
+        writer.Counter("fast_memory", now,
+                       absl::StrCat("\"working_set\": ", step.working_set,
+                                    ", \"resident\": ", step.resident,
+                                    capacity));
+        if (options.steps) {
+          writer.Slice(
+              kSteps,
+              absl::StrCat("tile ", step.tile, " k ", step.k_step, "/",
+                           step.num_k_steps),
+              memory_bound ? "memory_bound" : "compute_bound", now,
+              step.latency,
+              absl::StrCat("\"compute\": ", Time(step.compute_time),
+                           ", \"memory\": ", Time(memory_time),
+                           ", \"middle\": ", Time(step.middle_time),
+                           ", \"working_set\": ", step.working_set),
+              memory_bound ? "terrible" : "good");
+        }
+        if (step.compute_time > 0.0) {
+          writer.Slice(kCompute, "compute", "compute", now, step.compute_time,
+                       absl::StrCat("\"padding\": ", Time(padding)));
+        }
+        if (options.transfers && step.memory_in_time > 0.0) {
+          writer.Slice(kMemory, "load", "memory", now, step.memory_in_time,
+                       absl::StrCat("\"tensors\": [",
+                                    TransferList(step.loads), "]"));
+        }
+        if (options.transfers && step.memory_out_time > 0.0) {
+          writer.Slice(kMemory, "store", "memory", now + step.memory_in_time,
+                       step.memory_out_time,
+                       absl::StrCat("\"tensors\": [",
+                                    TransferList(step.stores), "]"));
+        }
+        if (!options.transfers && memory_time > 0.0) {
+          writer.Slice(kMemory, "transfer", "memory", now, memory_time, "");
+        }
+        now += step.latency;
+        previous = step;
+      });
+      !status.ok()) {
+    return status;
+  }
+  if (previous.has_value()) {
+    close_tile(*previous);
+    close_subgraph(*previous);
+  }
+  writer.Counter("fast_memory", now,
+                 absl::StrCat("\"working_set\": 0, \"resident\": 0",
+                              capacity));
+  return std::move(writer).Finish();
+}
+
+absl::Status WriteChromeTrace(const Problem& problem, const Solution& solution,
+                              const std::string& filename,
+                              const TraceOptions& options) {
+  absl::StatusOr<std::string> trace = ChromeTrace(problem, solution, options);
+  if (!trace.ok()) return trace.status();
+  return WriteFile(filename, *trace);
+}
+
+}  // namespace mlsys
@@ -0,0 +1,62 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MLSYS_TRACE_EXPORT_H_
+#define MLSYS_TRACE_EXPORT_H_
+
+#include <string>
+
+#include "mlsys.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/////////  Chrome trace timelines of a solution's simulated execution. /////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace mlsys {
+
+struct TraceOptions {
+  // One slice per execution step (tile and reduction slice).  Subgraph and
+  // tile slices are always emitted.
+  bool steps = true;
+  // Load and store slices on the memory track, listing the tensors moved.
+  bool transfers = true;
+};
+
+// Replays `solution` and renders it in the Chrome trace event format, which
+// Perfetto and chrome://tracing open directly.  One unit of latency is shown
+// as one microsecond.  Tracks, top to bottom:
+//
+//   subgraphs  one slice per subgraph
+//   tiles      one slice per spatial tile, spanning its reduction steps
+//   steps      one slice per step; memory-bound ones are coloured and
+//              filed under the "memory_bound" category
+//   compute    the compute time of each step, with its padding waste
+//   memory     the load and store time of each step
+//
+// plus a "fast_memory" counter of the working set against the capacity.
+absl::StatusOr<std::string> ChromeTrace(const Problem& problem,
+                                        const Solution& solution,
+                                        const TraceOptions& options = {});
+
+absl::Status WriteChromeTrace(const Problem& problem, const Solution& solution,
+                              const std::string& filename,
+                              const TraceOptions& options = {});
+
+}  // namespace mlsys
+
+#endif  // MLSYS_TRACE_EXPORT_H_
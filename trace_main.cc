@@ -0,0 +1,69 @@
+/*
+Copyright 2026 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Renders the simulated execution of a solution as a Chrome trace:
+//
+//   $ ./mlsys_trace problem.json solution.json trace.json
+//
+// Open the result in https://ui.perfetto.dev or chrome://tracing.
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mlsys.h"
+#include "third_party/absl/flags/flag.h"
+#include "third_party/absl/flags/parse.h"
+#include "third_party/absl/flags/usage.h"
+#include "third_party/absl/status/status.h"
+#include "third_party/absl/status/statusor.h"
+#include "trace_export.h"
+
+ABSL_FLAG(bool, steps, true, "Emit one slice per execution step.");
+ABSL_FLAG(bool, transfers, true,
+          "Emit load and store slices listing the tensors moved.");
+
+int main(int argc, char* argv[]) {
+  absl::SetProgramUsageMessage(
+      "Usage: mlsys_trace [flags] <problem.json> <solution.json> "
+      "<trace.json>");
+  const std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+  if (args.size() != 4) {
+    std::cerr << "Usage: " << args[0]
+              << " [flags] <problem.json> <solution.json> <trace.json>\n";
+    return 1;
+  }
+  const absl::StatusOr<mlsys::Problem> problem = mlsys::ReadProblem(args[1]);
+  if (!problem.ok()) {
+    std::cerr << problem.status() << "\n";
+    return 1;
+  }
+  const absl::StatusOr<mlsys::Solution> solution = mlsys::ReadSolution(args[2]);
+  if (!solution.ok()) {
+    std::cerr << solution.status() << "\n";
+    return 1;
+  }
+  mlsys::TraceOptions options;
+  options.steps = absl::GetFlag(FLAGS_steps);
+  options.transfers = absl::GetFlag(FLAGS_transfers);
+  if (const absl::Status status =
+          mlsys::WriteChromeTrace(*problem, *solution, args[3], options);
+      !status.ok()) {
+    std::cerr << status << "\n";
+    return 1;
+  }
+  return 0;
+}